@@ -0,0 +1,108 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "actuator.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#if CONFIG_GAMEPAD_CONSOLE
+#include "esp_console.h"
+#include "esp_err.h"
+#endif
+
+#include "gamepad_hal.h"
+#include "gamepad_report.h"
+#include "latency_stats.h"
+#include "output_mailbox.h"
+
+static output_mailbox_t s_mailbox;
+static actuator_wake_cb_t s_wake;
+
+// Written by the Bluetooth callback task
+static atomic_uint s_received;
+static atomic_uint s_rejected;
+// Written by the actuator task
+static atomic_uint s_applied;
+static atomic_uint s_replaced; // Commands overwritten by a newer one before they were applied
+static unsigned s_seen;
+static gamepad_output_t s_current;
+
+static void actuator_publish(const gamepad_output_t *cmd)
+{
+    output_mailbox_put(&s_mailbox, cmd);
+    if (s_wake)
+    {
+        s_wake();
+    }
+}
+
+bool actuator_submit(const uint8_t *data, uint16_t len)
+{
+    gamepad_output_t cmd;
+    uint32_t received_us = latency_now();
+
+    if (!gamepad_output_parse(data, len, &cmd))
+    {
+        atomic_fetch_add(&s_rejected, 1);
+        return false;
+    }
+    cmd.received_us = received_us;
+    atomic_fetch_add(&s_received, 1);
+    actuator_publish(&cmd);
+    return true;
+}
+
+void actuator_off(void)
+{
+    const gamepad_output_t off = {.received_us = latency_now()};
+    actuator_publish(&off);
+}
+
+bool actuator_service(gamepad_output_t *applied)
+{
+    gamepad_output_t cmd;
+    unsigned published = output_mailbox_take(&s_mailbox, &cmd, &s_seen);
+
+    if (published == 0)
+    {
+        return false;
+    }
+    gamepad_hal_output_set(&cmd);
+    s_current = cmd;
+    atomic_fetch_add(&s_applied, 1);
+    atomic_fetch_add(&s_replaced, published - 1);
+    *applied = cmd;
+    return true;
+}
+
+#if CONFIG_GAMEPAD_CONSOLE
+static int cmd_output(int argc, char **argv)
+{
+    // Read by the console task while the actuator task updates it; good enough for a status display
+    printf("rumble        %3u strong %3u weak\n", s_current.rumble_strong, s_current.rumble_weak);
+    printf("player leds   0x%x\n", s_current.player_leds);
+    printf("received      %8u\n", atomic_load(&s_received));
+    printf("rejected      %8u\n", atomic_load(&s_rejected));
+    printf("applied       %8u\n", atomic_load(&s_applied));
+    printf("replaced      %8u\n", atomic_load(&s_replaced));
+    return 0;
+}
+#endif
+
+void actuator_init(actuator_wake_cb_t wake)
+{
+    output_mailbox_init(&s_mailbox);
+    s_seen = 0;
+    s_wake = wake;
+    gamepad_hal_output_init();
+
+#if CONFIG_GAMEPAD_CONSOLE
+    const esp_console_cmd_t cmd = {
+        .command = "output",
+        .help = "Show the rumble and LED state set by the host and the output report counts",
+        .func = cmd_output,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+#endif
+}
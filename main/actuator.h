@@ -0,0 +1,42 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+#include "gamepad_state.h"
+
+// Called once a command is waiting, from the task that submitted it. The owner of the
+// actuators then calls actuator_service from its own task.
+typedef void (*actuator_wake_cb_t)(void);
+
+#if CONFIG_GAMEPAD_OUTPUT_REPORT
+
+// Set up the rumble and player LED outputs through gamepad_hal.h and register the
+// "output" console command. wake may be NULL when the caller polls actuator_service.
+void actuator_init(actuator_wake_cb_t wake);
+
+// Parse an output report from the host and hand it to the actuator task, replacing a
+// command it hasn't applied yet. Never blocks. Called from the Bluetooth callback task only.
+// Returns false for a malformed report.
+bool actuator_submit(const uint8_t *data, uint16_t len);
+
+// Stop the motors and clear the LEDs, e.g. on disconnect. Same task as actuator_submit.
+void actuator_off(void);
+
+// Apply the newest waiting command, if any, and copy it to applied. Returns false when
+// nothing new arrived. Called from one task only.
+bool actuator_service(gamepad_output_t *applied);
+
+#else
+
+static inline void actuator_init(actuator_wake_cb_t wake) {}
+static inline bool actuator_submit(const uint8_t *data, uint16_t len) { return false; }
+static inline void actuator_off(void) {}
+static inline bool actuator_service(gamepad_output_t *applied) { return false; }
+
+#endif
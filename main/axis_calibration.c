@@ -0,0 +1,144 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "axis_calibration.h"
+
+#include <string.h>
+
+#define AXIS_MIN_HALF_RANGE 256 // Raw counts needed on each side of the center
+
+void axis_calibration_default(axis_calibration_t *cal)
+{
+    cal->min = 0;
+    cal->center = (AXIS_RAW_MAX + 1) / 2;
+    cal->max = AXIS_RAW_MAX;
+}
+
+bool axis_calibration_valid(const axis_calibration_t *cal)
+{
+    return cal->max <= AXIS_RAW_MAX &&
+           cal->center >= cal->min + AXIS_MIN_HALF_RANGE &&
+           cal->max >= cal->center + AXIS_MIN_HALF_RANGE;
+}
+
+// Q15 value in [-32767, 32767] through the response curve
+static int32_t apply_curve(int32_t n, axis_curve_t curve)
+{
+    int32_t mag = n < 0 ? -n : n;
+    switch (curve)
+    {
+    case AXIS_CURVE_QUADRATIC:
+        return (n * mag) / AXIS_OUT_MAX;
+    case AXIS_CURVE_CUBIC:
+        return ((n * mag) / AXIS_OUT_MAX) * mag / AXIS_OUT_MAX;
+    case AXIS_CURVE_LINEAR:
+    default:
+        return n;
+    }
+}
+
+void axis_lut_build(int16_t lut[AXIS_LUT_SIZE], const axis_calibration_t *cal, axis_curve_t curve)
+{
+    int32_t below = cal->center - cal->min;
+    int32_t above = cal->max - cal->center;
+
+    for (int32_t raw = 0; raw < AXIS_LUT_SIZE; raw++)
+    {
+        int32_t delta = raw - cal->center;
+        int32_t n;
+
+        // Scale each side of the center separately so an off-center stick still reaches both ends
+        if (delta >= 0)
+        {
+            n = above ? (delta * AXIS_OUT_MAX + above / 2) / above : 0;
+        }
+        else
+        {
+            n = below ? (delta * AXIS_OUT_MAX - below / 2) / below : 0;
+        }
+
+        if (n > AXIS_OUT_MAX)
+        {
+            n = AXIS_OUT_MAX;
+        }
+        else if (n < -AXIS_OUT_MAX)
+        {
+            n = -AXIS_OUT_MAX;
+        }
+        lut[raw] = (int16_t)apply_curve(n, curve);
+    }
+}
+
+void axis_capture_begin(axis_capture_t *cap, uint32_t center_ms, uint32_t range_ms, int64_t now_us)
+{
+    memset(cap, 0, sizeof(*cap));
+    cap->center_ms = center_ms;
+    cap->range_ms = range_ms;
+    cap->phase = AXIS_CAPTURE_CENTER;
+    cap->phase_end_us = now_us + (int64_t)center_ms * 1000;
+}
+
+axis_capture_phase_t axis_capture_step(axis_capture_t *cap, const uint16_t raw[GAMEPAD_NUM_AXES], int64_t now_us)
+{
+    switch (cap->phase)
+    {
+    case AXIS_CAPTURE_CENTER:
+        for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+        {
+            cap->center_sum[i] += raw[i];
+        }
+        cap->center_count++;
+
+        if (now_us >= cap->phase_end_us)
+        {
+            for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+            {
+                uint16_t center = cap->center_sum[i] / cap->center_count;
+                cap->cal[i].center = center;
+                cap->cal[i].min = center;
+                cap->cal[i].max = center;
+            }
+            cap->phase = AXIS_CAPTURE_RANGE;
+            cap->phase_end_us = now_us + (int64_t)cap->range_ms * 1000;
+        }
+        break;
+    case AXIS_CAPTURE_RANGE:
+        for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+        {
+            if (raw[i] < cap->cal[i].min)
+            {
+                cap->cal[i].min = raw[i];
+            }
+            if (raw[i] > cap->cal[i].max)
+            {
+                cap->cal[i].max = raw[i];
+            }
+        }
+
+        if (now_us >= cap->phase_end_us)
+        {
+            cap->phase = AXIS_CAPTURE_DONE;
+            for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+            {
+                if (!axis_calibration_valid(&cap->cal[i]))
+                {
+                    cap->phase = AXIS_CAPTURE_FAILED;
+                }
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    return cap->phase;
+}
+
+bool axis_capture_result(const axis_capture_t *cap, axis_calibration_t cal[GAMEPAD_NUM_AXES])
+{
+    if (cap->phase != AXIS_CAPTURE_DONE)
+    {
+        return false;
+    }
+    memcpy(cal, cap->cal, sizeof(cap->cal));
+    return true;
+}
@@ -0,0 +1,82 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gamepad_state.h"
+
+#define AXIS_RAW_MAX 4095
+#define AXIS_LUT_SIZE (AXIS_RAW_MAX + 1)
+#define AXIS_OUT_MAX 32767
+
+// Raw 12-bit readings at the stick's extremes and at rest
+typedef struct
+{
+    uint16_t min;
+    uint16_t center;
+    uint16_t max;
+} axis_calibration_t;
+
+typedef enum
+{
+    AXIS_CURVE_LINEAR = 0,
+    AXIS_CURVE_QUADRATIC, // Finer control near the center
+    AXIS_CURVE_CUBIC,     // Even finer control near the center
+} axis_curve_t;
+
+// Full 12-bit range centered at mid-scale
+void axis_calibration_default(axis_calibration_t *cal);
+
+// Rejects calibrations too narrow on either side of the center to be real
+bool axis_calibration_valid(const axis_calibration_t *cal);
+
+// Precompute raw reading -> report value, with center offset, range scaling and response curve
+void axis_lut_build(int16_t lut[AXIS_LUT_SIZE], const axis_calibration_t *cal, axis_curve_t curve);
+
+static inline int16_t axis_lut_apply(const int16_t lut[AXIS_LUT_SIZE], uint16_t raw)
+{
+    return lut[raw & AXIS_RAW_MAX];
+}
+
+// Zero both axes of a stick that is inside a circle of the given radius (report units)
+static inline void stick_radial_deadzone(int16_t *x, int16_t *y, int32_t radius)
+{
+    int32_t mag_sq = (int32_t)*x * *x + (int32_t)*y * *y;
+    if (mag_sq < radius * radius)
+    {
+        *x = 0;
+        *y = 0;
+    }
+}
+
+typedef enum
+{
+    AXIS_CAPTURE_IDLE = 0,
+    AXIS_CAPTURE_CENTER, // Sticks at rest, averaging the center
+    AXIS_CAPTURE_RANGE,  // Sticks being rotated to their limits
+    AXIS_CAPTURE_DONE,   // Result ready, collect with axis_capture_result
+    AXIS_CAPTURE_FAILED, // Captured range was too small on some axis
+} axis_capture_phase_t;
+
+typedef struct
+{
+    axis_capture_phase_t phase;
+    int64_t phase_end_us;
+    uint32_t center_ms;
+    uint32_t range_ms;
+    uint32_t center_sum[GAMEPAD_NUM_AXES];
+    uint32_t center_count;
+    axis_calibration_t cal[GAMEPAD_NUM_AXES];
+} axis_capture_t;
+
+// Start a capture: center_ms at rest, then range_ms of full stick sweeps
+void axis_capture_begin(axis_capture_t *cap, uint32_t center_ms, uint32_t range_ms, int64_t now_us);
+
+// Feed one raw sample of every axis, returns the phase after the sample
+axis_capture_phase_t axis_capture_step(axis_capture_t *cap, const uint16_t raw[GAMEPAD_NUM_AXES], int64_t now_us);
+
+// Copy out the captured calibration once the phase is AXIS_CAPTURE_DONE
+bool axis_capture_result(const axis_capture_t *cap, axis_calibration_t cal[GAMEPAD_NUM_AXES]);
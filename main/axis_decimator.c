@@ -0,0 +1,56 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "axis_decimator.h"
+
+#include <string.h>
+
+void axis_decimator_init(axis_decimator_t *dec, const uint8_t channels[GAMEPAD_NUM_AXES], uint16_t oversample)
+{
+    memset(dec->axis_of_channel, -1, sizeof(dec->axis_of_channel));
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        if (channels[i] < AXIS_DECIMATOR_NUM_CHANNELS)
+        {
+            dec->axis_of_channel[channels[i]] = i;
+        }
+        dec->sum[i] = 0;
+        dec->count[i] = 0;
+        atomic_init(&dec->latest[i], AXIS_DECIMATOR_RAW_MID);
+    }
+    dec->oversample = oversample ? oversample : 1;
+}
+
+void axis_decimator_push(axis_decimator_t *dec, uint8_t channel, uint16_t value)
+{
+    if (channel >= AXIS_DECIMATOR_NUM_CHANNELS || dec->axis_of_channel[channel] < 0)
+    {
+        return;
+    }
+
+    int axis = dec->axis_of_channel[channel];
+    dec->sum[axis] += value;
+    if (++dec->count[axis] >= dec->oversample)
+    {
+        atomic_store_explicit(&dec->latest[axis], (uint16_t)(dec->sum[axis] / dec->count[axis]), memory_order_relaxed);
+        dec->sum[axis] = 0;
+        dec->count[axis] = 0;
+    }
+}
+
+void axis_decimator_push_frame(axis_decimator_t *dec, const uint8_t *frame, size_t len)
+{
+    for (size_t i = 0; i + 1 < len; i += 2)
+    {
+        uint16_t word = frame[i] | (frame[i + 1] << 8);
+        axis_decimator_push(dec, word >> 12, word & 0x0FFF);
+    }
+}
+
+void axis_decimator_latest(axis_decimator_t *dec, uint16_t raw[GAMEPAD_NUM_AXES])
+{
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        raw[i] = atomic_load_explicit(&dec->latest[i], memory_order_relaxed);
+    }
+}
@@ -0,0 +1,36 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gamepad_state.h"
+
+#define AXIS_DECIMATOR_NUM_CHANNELS 16 // Channel field of a conversion result is 4 bits
+#define AXIS_DECIMATOR_RAW_MID 2048    // Reported until the first average is ready
+
+// Averages oversampled ADC conversions per axis and publishes the latest
+// average of each axis for lock-free reads from another task.
+typedef struct
+{
+    int8_t axis_of_channel[AXIS_DECIMATOR_NUM_CHANNELS]; // -1 for channels we don't use
+    uint16_t oversample;
+    uint32_t sum[GAMEPAD_NUM_AXES];
+    uint16_t count[GAMEPAD_NUM_AXES];
+    atomic_ushort latest[GAMEPAD_NUM_AXES];
+} axis_decimator_t;
+
+// channels[i] is the ADC channel sampled for axis i
+void axis_decimator_init(axis_decimator_t *dec, const uint8_t channels[GAMEPAD_NUM_AXES], uint16_t oversample);
+
+// Add one 12-bit conversion result
+void axis_decimator_push(axis_decimator_t *dec, uint8_t channel, uint16_t value);
+
+// Add a DMA frame of 16-bit little-endian results: bits 0-11 data, bits 12-15 channel
+void axis_decimator_push_frame(axis_decimator_t *dec, const uint8_t *frame, size_t len);
+
+// Latest averaged raw value of every axis, never blocks
+void axis_decimator_latest(axis_decimator_t *dec, uint16_t raw[GAMEPAD_NUM_AXES]);
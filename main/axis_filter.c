@@ -0,0 +1,78 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "axis_filter.h"
+
+#include <string.h>
+
+#define SPEED_CUTOFF_MHZ 1000   // Smoothing of the speed estimate, the usual One-Euro 1 Hz
+#define MAX_CUTOFF_MHZ 1000000  // Beyond this the filter passes samples through anyway
+#define MAX_DT_US 1000000       // Longer gaps (e.g. a stalled task) count as one second
+#define TWO_PI_Q16 411775       // 2 * pi * 65536
+
+// Smoothing factor Te / (Te + tau) with tau = 1 / (2 pi fc), in Q16
+static uint32_t smoothing(uint32_t cutoff_mhz, uint32_t dt_us)
+{
+    uint64_t r = (uint64_t)cutoff_mhz * dt_us * TWO_PI_Q16 / 1000000000; // 2 pi fc Te, Q16
+    return (uint32_t)((r << 16) / (65536 + r));
+}
+
+static int32_t blend(int32_t from, int32_t to, uint32_t alpha)
+{
+    return from + (int32_t)(((int64_t)(to - from) * alpha + 32768) >> 16);
+}
+
+void axis_filter_init(axis_filter_t *filter, const axis_filter_config_t *config)
+{
+    memset(filter, 0, sizeof(*filter));
+    filter->config = *config;
+}
+
+void axis_filter_apply(axis_filter_t *filter, uint16_t raw[GAMEPAD_NUM_AXES], uint32_t now_us)
+{
+    if (!filter->started)
+    {
+        for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+        {
+            filter->value[i] = (int32_t)raw[i] << AXIS_FILTER_FRAC_BITS;
+        }
+        filter->started = true;
+        filter->last_us = now_us;
+        return;
+    }
+
+    uint32_t dt_us = now_us - filter->last_us;
+    if (dt_us == 0)
+    {
+        // No time has passed to filter over, repeat the last output
+        for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+        {
+            raw[i] = (uint16_t)((filter->value[i] + (1 << (AXIS_FILTER_FRAC_BITS - 1))) >> AXIS_FILTER_FRAC_BITS);
+        }
+        return;
+    }
+    if (dt_us > MAX_DT_US)
+    {
+        dt_us = MAX_DT_US;
+    }
+    filter->last_us = now_us;
+
+    uint32_t speed_alpha = smoothing(SPEED_CUTOFF_MHZ, dt_us);
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        int32_t x = (int32_t)raw[i] << AXIS_FILTER_FRAC_BITS;
+        int32_t speed = (int32_t)((int64_t)(x - filter->value[i]) * 1000000 / dt_us >> AXIS_FILTER_FRAC_BITS);
+
+        filter->speed[i] = blend(filter->speed[i], speed, speed_alpha);
+
+        uint64_t cutoff = filter->config.min_cutoff_mhz +
+                          (uint64_t)filter->config.beta * (uint32_t)(filter->speed[i] < 0 ? -filter->speed[i]
+                                                                                          : filter->speed[i]) / 1000;
+        if (cutoff > MAX_CUTOFF_MHZ)
+        {
+            cutoff = MAX_CUTOFF_MHZ;
+        }
+        filter->value[i] = blend(filter->value[i], x, smoothing((uint32_t)cutoff, dt_us));
+        raw[i] = (uint16_t)((filter->value[i] + (1 << (AXIS_FILTER_FRAC_BITS - 1))) >> AXIS_FILTER_FRAC_BITS);
+    }
+}
@@ -0,0 +1,35 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gamepad_state.h"
+
+// One-Euro style adaptive low-pass for the raw stick readings, in fixed point.
+// The cutoff follows the stick's speed: a resting stick gets min_cutoff_mhz and
+// its ADC noise is smoothed away, a moving one gets a higher cutoff and little lag.
+typedef struct
+{
+    uint32_t min_cutoff_mhz; // Cutoff at rest
+    uint32_t beta;           // Cutoff increase in mHz per 1000 raw units/s of speed
+} axis_filter_config_t;
+
+typedef struct
+{
+    axis_filter_config_t config;
+    bool started;
+    uint32_t last_us;
+    int32_t value[GAMEPAD_NUM_AXES]; // Filtered reading, raw units << AXIS_FILTER_FRAC_BITS
+    int32_t speed[GAMEPAD_NUM_AXES]; // Smoothed speed, raw units/s
+} axis_filter_t;
+
+#define AXIS_FILTER_FRAC_BITS 8
+
+void axis_filter_init(axis_filter_t *filter, const axis_filter_config_t *config);
+
+// Filter one sample of every axis in place. now_us paces the filter, so the
+// sample period may change between calls.
+void axis_filter_apply(axis_filter_t *filter, uint16_t raw[GAMEPAD_NUM_AXES], uint32_t now_us);
@@ -0,0 +1,77 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "boot_metrics.h"
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#if CONFIG_GAMEPAD_CONSOLE
+#include "esp_console.h"
+#endif
+
+static const char *TAG = "boot";
+
+static const char *s_mark_names[BOOT_MARK_COUNT] = {"hid ready", "page", "connected", "first report"};
+static atomic_uint s_mark_ms[BOOT_MARK_COUNT]; // Milliseconds since boot, 0 until reached
+
+void boot_metrics_mark(boot_mark_t mark)
+{
+    unsigned expected = 0;
+    unsigned now_ms = (unsigned)(esp_timer_get_time() / 1000) | 1; // Never 0, which means unset
+
+    if (atomic_compare_exchange_strong(&s_mark_ms[mark], &expected, now_ms) && mark == BOOT_MARK_FIRST_REPORT)
+    {
+        boot_metrics_log();
+    }
+}
+
+void boot_metrics_log(void)
+{
+    char line[128];
+    int len = 0;
+
+    for (int i = 0; i < BOOT_MARK_COUNT && len < sizeof(line); i++)
+    {
+        unsigned ms = atomic_load(&s_mark_ms[i]);
+        if (ms)
+        {
+            len += snprintf(line + len, sizeof(line) - len, "%s %u ms ", s_mark_names[i], ms);
+        }
+    }
+    ESP_LOGI(TAG, "%s", len ? line : "no marks yet");
+}
+
+#if CONFIG_GAMEPAD_CONSOLE
+static int cmd_boot(int argc, char **argv)
+{
+    for (int i = 0; i < BOOT_MARK_COUNT; i++)
+    {
+        unsigned ms = atomic_load(&s_mark_ms[i]);
+        if (ms)
+        {
+            printf("%-13s %6u ms\n", s_mark_names[i], ms);
+        }
+        else
+        {
+            printf("%-13s %9s\n", s_mark_names[i], "-");
+        }
+    }
+    return 0;
+}
+#endif
+
+void boot_metrics_init(void)
+{
+#if CONFIG_GAMEPAD_CONSOLE
+    const esp_console_cmd_t cmd = {
+        .command = "boot",
+        .help = "Show the time from boot to HID ready, paging, connection and the first report",
+        .func = cmd_boot,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+#endif
+}
@@ -0,0 +1,21 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+typedef enum
+{
+    BOOT_MARK_HID_READY = 0, // HID app registered with the stack
+    BOOT_MARK_PAGE,          // Started paging the last host
+    BOOT_MARK_CONNECTED,     // First HID connection
+    BOOT_MARK_FIRST_REPORT,  // First input report completed
+    BOOT_MARK_COUNT,
+} boot_mark_t;
+
+// Register the "boot" console command
+void boot_metrics_init(void);
+
+// Record the time since boot of the first occurrence of mark; later ones are ignored
+void boot_metrics_mark(boot_mark_t mark);
+
+void boot_metrics_log(void);
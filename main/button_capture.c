@@ -0,0 +1,77 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "button_capture.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "esp_attr.h"
+
+#include "button_map.h"
+#include "gpio_port.h"
+#include "latency_stats.h"
+
+static const uint8_t s_pins[GAMEPAD_NUM_BUTTONS] = {
+#define BUTTON_PIN(name, gpio) gpio,
+    GAMEPAD_BUTTON_LIST(BUTTON_PIN)
+#undef BUTTON_PIN
+};
+
+static button_map_t s_button_map; // Input register bits -> button mask, built from s_pins[]
+
+#if CONFIG_GAMEPAD_BUTTON_CAPTURE_INTERRUPT
+static atomic_uint s_pending_buttons = 0; // Bit i set when button i had an edge since the last read
+static atomic_uint s_first_edge_us = 0;   // latency_now() of the first pending edge
+
+static void IRAM_ATTR button_edge(int index)
+{
+    if (atomic_fetch_or(&s_pending_buttons, 1U << index) == 0)
+    {
+        atomic_store(&s_first_edge_us, latency_now());
+    }
+}
+#endif
+
+void button_capture_init(void)
+{
+    button_map_init(&s_button_map);
+    for (int i = 0; i < GAMEPAD_NUM_BUTTONS; i++)
+    {
+        button_map_set(&s_button_map, i, s_pins[i]);
+    }
+
+#if CONFIG_GAMEPAD_BUTTON_CAPTURE_INTERRUPT
+    atomic_store(&s_pending_buttons, GAMEPAD_ALL_BUTTONS_MASK); // Read every pin on the first pass
+    for (int i = 0; i < GAMEPAD_NUM_BUTTONS; i++)
+    {
+        gpio_port_input(s_pins[i], i, button_edge); // Wake the report task on press and release
+    }
+#else
+    for (int i = 0; i < GAMEPAD_NUM_BUTTONS; i++)
+    {
+        gpio_port_input(s_pins[i], i, NULL);
+    }
+#endif
+}
+
+gamepad_buttons_t button_capture_take_edges(uint32_t *first_edge_us)
+{
+#if CONFIG_GAMEPAD_BUTTON_CAPTURE_INTERRUPT
+    uint32_t pending = atomic_exchange(&s_pending_buttons, 0);
+    *first_edge_us = pending ? atomic_load(&s_first_edge_us) : latency_now();
+    return pending;
+#else
+    *first_edge_us = latency_now();
+    return GAMEPAD_ALL_BUTTONS_MASK;
+#endif
+}
+
+// Snapshot both GPIO input banks at once and permute them into the button mask
+gamepad_buttons_t button_capture_read(void)
+{
+    uint32_t in0, in1;
+
+    gpio_port_read(&in0, &in1);
+    return button_map_apply(&s_button_map, in0, in1);
+}
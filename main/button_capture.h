@@ -0,0 +1,19 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include "gamepad_state.h"
+
+// Buttons wired one per GPIO, as listed in gamepad_inputs.h. Edges are latched by the
+// GPIO interrupt (or every pin is read each sample when polling) and all pins are read
+// from one snapshot of the input registers. Sits on gpio_port.h.
+
+// Configure the pins; with edge interrupts the calling task is woken on every edge
+void button_capture_init(void);
+
+// Same contract as gamepad_hal_take_edges
+gamepad_buttons_t button_capture_take_edges(uint32_t *first_edge_us);
+
+// Bit i set when button i is pressed
+gamepad_buttons_t button_capture_read(void);
@@ -0,0 +1,22 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "button_debounce.h"
+
+void button_debounce_init(button_debounce_t *db, unsigned release_samples)
+{
+    if (release_samples < 1)
+    {
+        release_samples = 1;
+    }
+    if (release_samples > BUTTON_DEBOUNCE_MAX_SAMPLES)
+    {
+        release_samples = BUTTON_DEBOUNCE_MAX_SAMPLES;
+    }
+
+    db->state = 0;
+    db->cnt0 = db->cnt1 = db->cnt2 = 0;
+    db->n0 = (release_samples & 1) ? (gamepad_buttons_t)-1 : 0;
+    db->n1 = (release_samples & 2) ? (gamepad_buttons_t)-1 : 0;
+    db->n2 = (release_samples & 4) ? (gamepad_buttons_t)-1 : 0;
+}
@@ -0,0 +1,58 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gamepad_inputs.h"
+
+#define BUTTON_DEBOUNCE_MAX_SAMPLES 7 // Largest count a 3-bit vertical counter holds
+
+// Debounces every button of a mask at once. A press is taken on the first sample
+// that shows it; a release only after release_samples consecutive released samples,
+// so bounce on either edge never produces extra transitions.
+//
+// Bit i of cnt0..cnt2 together form a 3-bit counter of consecutive released samples
+// for button i, so each update is the same few bitwise operations for any mask.
+typedef struct
+{
+    gamepad_buttons_t state; // Debounced mask, bit set while pressed
+    gamepad_buttons_t cnt0;
+    gamepad_buttons_t cnt1;
+    gamepad_buttons_t cnt2;
+    gamepad_buttons_t n0; // release_samples, bit k spread across every bit of nk
+    gamepad_buttons_t n1;
+    gamepad_buttons_t n2;
+} button_debounce_t;
+
+// release_samples: 1 (no release filtering) to BUTTON_DEBOUNCE_MAX_SAMPLES
+void button_debounce_init(button_debounce_t *db, unsigned release_samples);
+
+// Feed one raw sample (bit set while pressed), returns the debounced mask
+static inline gamepad_buttons_t button_debounce_update(button_debounce_t *db, gamepad_buttons_t raw)
+{
+    gamepad_buttons_t releasing = db->state & ~raw;
+
+    // Count consecutive released samples, reset wherever the button reads pressed
+    gamepad_buttons_t carry0 = db->cnt0 & releasing;
+    gamepad_buttons_t carry1 = db->cnt1 & carry0;
+    db->cnt0 = (db->cnt0 ^ releasing) & releasing;
+    db->cnt1 = (db->cnt1 ^ carry0) & releasing;
+    db->cnt2 = (db->cnt2 ^ carry1) & releasing;
+
+    gamepad_buttons_t released = releasing & ~(db->cnt0 ^ db->n0) & ~(db->cnt1 ^ db->n1) & ~(db->cnt2 ^ db->n2);
+    db->cnt0 &= ~released;
+    db->cnt1 &= ~released;
+    db->cnt2 &= ~released;
+
+    db->state = (db->state | raw) & ~released; // Presses go straight through
+    return db->state;
+}
+
+// True while a release is being filtered and more samples are needed
+static inline bool button_debounce_busy(const button_debounce_t *db)
+{
+    return (db->cnt0 | db->cnt1 | db->cnt2) != 0;
+}
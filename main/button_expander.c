@@ -0,0 +1,122 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "button_expander.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "driver/spi_master.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#if CONFIG_GAMEPAD_CONSOLE
+#include "esp_console.h"
+#endif
+
+#include "latency_hist.h"
+#include "shift_chain.h"
+
+#define EXPANDER_SPI_HOST SPI3_HOST
+#define EXPANDER_BYTES CONFIG_GAMEPAD_SHIFT_REG_COUNT
+
+_Static_assert(EXPANDER_BYTES * 8 == GAMEPAD_NUM_BUTTONS, "one button per register input");
+
+static const char *TAG = "expander";
+
+static spi_device_handle_t s_device;
+static DMA_ATTR uint8_t s_rx[(EXPANDER_BYTES + 3) & ~3]; // DMA writes whole words
+static gamepad_buttons_t s_last;
+static latency_hist_t s_read_hist; // Transaction time in us, recorded by the input task
+
+gamepad_buttons_t button_expander_read(void)
+{
+    // SH/LD is the chip select: low between reads keeps the registers loading, going high
+    // latches every input at once and the clock shifts them out
+    spi_transaction_t trans = {
+        .rxlength = EXPANDER_BYTES * 8,
+        .rx_buffer = s_rx,
+    };
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = spi_device_polling_transmit(s_device, &trans);
+    latency_hist_record(&s_read_hist, (uint32_t)(esp_timer_get_time() - start_us));
+
+    if (ret == ESP_OK)
+    {
+        s_last = shift_chain_unpack(s_rx, EXPANDER_BYTES);
+    }
+    return s_last; // Hold the previous state over a failed read
+}
+
+#if CONFIG_GAMEPAD_CONSOLE
+static int cmd_expander(int argc, char **argv)
+{
+    latency_summary_t read;
+    latency_hist_summary(&s_read_hist, &read);
+
+    printf("registers     %8d (%d buttons)\n", EXPANDER_BYTES, GAMEPAD_NUM_BUTTONS);
+    printf("clock         %8d Hz\n", CONFIG_GAMEPAD_SHIFT_REG_CLOCK_HZ);
+    printf("pressed       0x%0*" PRIx64 "\n", EXPANDER_BYTES * 2, (uint64_t)s_last);
+    printf("reads         %8" PRIu32 "\n", read.count);
+    printf("read p50      %8" PRIu32 " us\n", read.p50);
+    printf("read p99      %8" PRIu32 " us\n", read.p99);
+    printf("read max      %8" PRIu32 " us\n", read.max);
+    return 0;
+}
+#endif
+
+esp_err_t button_expander_start(void)
+{
+    esp_err_t ret;
+
+    if (s_device)
+    {
+        return ESP_OK;
+    }
+
+    const spi_bus_config_t bus_cfg = {
+        .mosi_io_num = -1,
+        .miso_io_num = CONFIG_GAMEPAD_SHIFT_REG_DATA_GPIO,
+        .sclk_io_num = CONFIG_GAMEPAD_SHIFT_REG_CLOCK_GPIO,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = sizeof(s_rx),
+    };
+    if ((ret = spi_bus_initialize(EXPANDER_SPI_HOST, &bus_cfg, SPI_DMA_CH_AUTO)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "bus init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // The 74HC165 shifts on the rising clock edge and QH already holds input H once
+    // SH/LD goes high, so mode 0 samples every bit. Read-only transfers are half duplex,
+    // which also allows the chip select lead time for QH to settle.
+    const spi_device_interface_config_t dev_cfg = {
+        .mode = 0,
+        .clock_speed_hz = CONFIG_GAMEPAD_SHIFT_REG_CLOCK_HZ,
+        .spics_io_num = CONFIG_GAMEPAD_SHIFT_REG_LOAD_GPIO,
+        .cs_ena_pretrans = 1,
+        .queue_size = 1,
+        .flags = SPI_DEVICE_HALFDUPLEX | SPI_DEVICE_POSITIVE_CS,
+    };
+    if ((ret = spi_bus_add_device(EXPANDER_SPI_HOST, &dev_cfg, &s_device)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "add device failed: %s", esp_err_to_name(ret));
+        spi_bus_free(EXPANDER_SPI_HOST);
+        return ret;
+    }
+
+    latency_hist_reset(&s_read_hist);
+    ESP_LOGI(TAG, "%d shift registers, %d buttons, %d Hz", EXPANDER_BYTES, GAMEPAD_NUM_BUTTONS,
+             CONFIG_GAMEPAD_SHIFT_REG_CLOCK_HZ);
+
+#if CONFIG_GAMEPAD_CONSOLE
+    const esp_console_cmd_t cmd = {
+        .command = "expander",
+        .help = "Show the shift-register chain's pressed inputs and read time",
+        .func = cmd_expander,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+#endif
+    return ESP_OK;
+}
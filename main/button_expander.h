@@ -0,0 +1,15 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include "esp_err.h"
+#include "gamepad_inputs.h"
+
+// Set up the SPI bus for the shift-register chain and register the "expander"
+// console command. Calling it again does nothing.
+esp_err_t button_expander_start(void);
+
+// Latch every input and clock the whole chain in with one DMA transaction.
+// Blocks for the transfer, about one microsecond per register at 8 MHz.
+gamepad_buttons_t button_expander_read(void);
@@ -0,0 +1,30 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "button_map.h"
+
+#include <string.h>
+
+void button_map_init(button_map_t *map)
+{
+    memset(map, 0, sizeof(*map));
+}
+
+void button_map_set(button_map_t *map, int index, int pin)
+{
+    if (index < 0 || index >= BUTTON_MAP_MAX_BUTTONS || pin < 0 || pin >= BUTTON_MAP_NUM_PINS)
+    {
+        return;
+    }
+
+    int byte = pin / 8;
+    uint32_t pin_bit = 1U << (pin % 8);
+    for (uint32_t value = 0; value < 256; value++)
+    {
+        if (value & pin_bit)
+        {
+            map->lut[byte][value] |= 1U << index;
+        }
+    }
+    map->all_mask |= 1U << index;
+}
@@ -0,0 +1,35 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+// GPIO 0-31 come from the first input register, GPIO 32-39 from the second
+#define BUTTON_MAP_NUM_PINS 40
+#define BUTTON_MAP_NUM_BYTES (BUTTON_MAP_NUM_PINS / 8)
+#define BUTTON_MAP_MAX_BUTTONS 16
+
+// Byte-wise permutation from the raw GPIO input registers to the button mask.
+// lut[n][v] holds the button bits that are high when byte n of the inputs equals v.
+typedef struct
+{
+    uint16_t lut[BUTTON_MAP_NUM_BYTES][256];
+    uint16_t all_mask;
+} button_map_t;
+
+void button_map_init(button_map_t *map);
+
+// Map GPIO pin to bit index of the button mask
+void button_map_set(button_map_t *map, int index, int pin);
+
+// Turn one snapshot of both input registers into the active-low button mask
+static inline uint16_t button_map_apply(const button_map_t *map, uint32_t in0, uint32_t in1)
+{
+    uint16_t high = map->lut[0][in0 & 0xFF] |
+                    map->lut[1][(in0 >> 8) & 0xFF] |
+                    map->lut[2][(in0 >> 16) & 0xFF] |
+                    map->lut[3][in0 >> 24] |
+                    map->lut[4][in1 & 0xFF];
+    return ~high & map->all_mask; // Low for button pressed
+}
@@ -0,0 +1,172 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "calibration.h"
+
+#include "esp_log.h"
+#include "nvs.h"
+
+#include "axis_calibration.h"
+
+#define CALIBRATION_NVS_NAMESPACE "gamepad"
+#define CALIBRATION_NVS_KEY "axis_cal"
+#define CALIBRATION_VERSION 1
+
+#define CALIBRATION_CENTER_MS 1000
+#define CALIBRATION_RANGE_MS 5000
+
+#if CONFIG_GAMEPAD_STICK_CURVE_QUADRATIC
+#define CALIBRATION_CURVE AXIS_CURVE_QUADRATIC
+#elif CONFIG_GAMEPAD_STICK_CURVE_CUBIC
+#define CALIBRATION_CURVE AXIS_CURVE_CUBIC
+#else
+#define CALIBRATION_CURVE AXIS_CURVE_LINEAR
+#endif
+
+typedef struct
+{
+    uint8_t version;
+    axis_calibration_t axes[GAMEPAD_NUM_AXES];
+} calibration_blob_t;
+
+static const char *TAG = "calibration";
+
+static int16_t s_axis_lut[GAMEPAD_NUM_AXES][AXIS_LUT_SIZE];
+static axis_capture_t s_capture;
+static uint16_t s_combo_mask;
+static int64_t s_combo_since_us = -1;
+
+static void build_tables(const axis_calibration_t cal[GAMEPAD_NUM_AXES])
+{
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        axis_lut_build(s_axis_lut[i], &cal[i], CALIBRATION_CURVE);
+    }
+}
+
+static bool load_calibration(calibration_blob_t *blob)
+{
+    nvs_handle_t handle;
+    size_t len = sizeof(*blob);
+    bool ok = false;
+
+    if (nvs_open(CALIBRATION_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+    {
+        return false;
+    }
+    if (nvs_get_blob(handle, CALIBRATION_NVS_KEY, blob, &len) == ESP_OK &&
+        len == sizeof(*blob) && blob->version == CALIBRATION_VERSION)
+    {
+        ok = true;
+        for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+        {
+            ok = ok && axis_calibration_valid(&blob->axes[i]);
+        }
+    }
+    nvs_close(handle);
+    return ok;
+}
+
+static esp_err_t save_calibration(const calibration_blob_t *blob)
+{
+    nvs_handle_t handle;
+    esp_err_t ret;
+
+    if ((ret = nvs_open(CALIBRATION_NVS_NAMESPACE, NVS_READWRITE, &handle)) != ESP_OK)
+    {
+        return ret;
+    }
+    ret = nvs_set_blob(handle, CALIBRATION_NVS_KEY, blob, sizeof(*blob));
+    if (ret == ESP_OK)
+    {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
+
+void calibration_init(uint16_t combo_mask)
+{
+    calibration_blob_t blob;
+
+    s_combo_mask = combo_mask;
+    s_combo_since_us = -1;
+    s_capture.phase = AXIS_CAPTURE_IDLE;
+
+    if (load_calibration(&blob))
+    {
+        ESP_LOGI(TAG, "loaded stored calibration");
+    }
+    else
+    {
+        ESP_LOGI(TAG, "no stored calibration, using defaults");
+        for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+        {
+            axis_calibration_default(&blob.axes[i]);
+        }
+    }
+    build_tables(blob.axes);
+}
+
+void calibration_map(const uint16_t raw[GAMEPAD_NUM_AXES], int16_t axes[GAMEPAD_NUM_AXES])
+{
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        axes[i] = axis_lut_apply(s_axis_lut[i], raw[i]);
+    }
+    stick_radial_deadzone(&axes[0], &axes[1], CONFIG_GAMEPAD_STICK_DEADZONE);
+    stick_radial_deadzone(&axes[2], &axes[3], CONFIG_GAMEPAD_STICK_DEADZONE);
+}
+
+bool calibration_poll(const uint16_t raw[GAMEPAD_NUM_AXES], gamepad_buttons_t buttons, int64_t now_us)
+{
+    if (s_capture.phase == AXIS_CAPTURE_CENTER || s_capture.phase == AXIS_CAPTURE_RANGE)
+    {
+        axis_capture_phase_t prev = s_capture.phase;
+        axis_capture_phase_t phase = axis_capture_step(&s_capture, raw, now_us);
+        if (prev == AXIS_CAPTURE_CENTER && phase == AXIS_CAPTURE_RANGE)
+        {
+            ESP_LOGI(TAG, "rotate both sticks to their limits");
+        }
+        else if (phase == AXIS_CAPTURE_DONE)
+        {
+            calibration_blob_t blob = {.version = CALIBRATION_VERSION};
+            axis_capture_result(&s_capture, blob.axes);
+            build_tables(blob.axes);
+            esp_err_t ret = save_calibration(&blob);
+            if (ret != ESP_OK)
+            {
+                ESP_LOGE(TAG, "saving calibration failed: %s", esp_err_to_name(ret));
+            }
+            for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+            {
+                ESP_LOGI(TAG, "axis %d: min %d center %d max %d", i, blob.axes[i].min, blob.axes[i].center,
+                         blob.axes[i].max);
+            }
+        }
+        else if (phase == AXIS_CAPTURE_FAILED)
+        {
+            ESP_LOGE(TAG, "capture failed, move the sticks to their limits; keeping the previous calibration");
+        }
+        return phase == AXIS_CAPTURE_CENTER || phase == AXIS_CAPTURE_RANGE;
+    }
+
+    // Holding the combo starts a capture
+    if ((buttons & s_combo_mask) != s_combo_mask)
+    {
+        s_combo_since_us = -1;
+        return false;
+    }
+    if (s_combo_since_us < 0)
+    {
+        s_combo_since_us = now_us;
+    }
+    if (now_us - s_combo_since_us >= (int64_t)CONFIG_GAMEPAD_CALIBRATION_HOLD_MS * 1000)
+    {
+        ESP_LOGI(TAG, "release the sticks, capturing center");
+        axis_capture_begin(&s_capture, CALIBRATION_CENTER_MS, CALIBRATION_RANGE_MS, now_us);
+        s_combo_since_us = -1;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,20 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gamepad_state.h"
+
+// Load the stored axis calibration from NVS (or defaults) and build the lookup
+// tables. Holding every button in combo_mask starts a new capture.
+void calibration_init(uint16_t combo_mask);
+
+// Raw 12-bit readings -> calibrated report values, with the stick deadzone applied
+void calibration_map(const uint16_t raw[GAMEPAD_NUM_AXES], int16_t axes[GAMEPAD_NUM_AXES]);
+
+// Watch for the capture combo and run the capture. Returns true while a capture
+// is in progress, during which reports should not be sent.
+bool calibration_poll(const uint16_t raw[GAMEPAD_NUM_AXES], gamepad_buttons_t buttons, int64_t now_us);
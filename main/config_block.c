@@ -0,0 +1,103 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "config_block.h"
+
+#include "sdkconfig.h"
+
+#include "gamepad_inputs.h"
+
+// Same limits as the matching menuconfig options
+#define SAMPLE_US_MIN 250
+#define SAMPLE_US_MAX 100000
+#define REPORT_US_MIN 1000
+#define REPORT_US_MAX 100000
+#define IDLE_TIMEOUT_MS_MIN 100
+#define IDLE_TIMEOUT_MS_MAX 600000
+#define AXIS_DEADBAND_MAX 32767
+#define KEEPALIVE_MS_MAX 60000
+
+void config_block_defaults(config_block_t *cfg)
+{
+    cfg->fixed_rate = false;
+    cfg->axis_bits = GAMEPAD_AXIS_BITS;
+    cfg->axis_deadband = CONFIG_GAMEPAD_AXIS_DEADBAND;
+    cfg->keepalive_ms = CONFIG_GAMEPAD_KEEPALIVE_MS;
+    cfg->sample_us = CONFIG_GAMEPAD_ACTIVE_SAMPLE_PERIOD_US;
+    cfg->report_us = CONFIG_GAMEPAD_ACTIVE_REPORT_INTERVAL_US;
+    cfg->idle_timeout_ms = CONFIG_GAMEPAD_IDLE_TIMEOUT_MS;
+}
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    put_le16(p, (uint16_t)v);
+    put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return get_le16(p) | ((uint32_t)get_le16(p + 2) << 16);
+}
+
+uint16_t config_block_encode(const config_block_t *cfg, uint8_t *buf)
+{
+    buf[0] = CONFIG_BLOCK_VERSION;
+    buf[1] = cfg->fixed_rate ? CONFIG_BLOCK_FLAG_FIXED_RATE : 0;
+    buf[2] = cfg->axis_bits;
+    buf[3] = 0;
+    put_le16(buf + 4, cfg->axis_deadband);
+    put_le16(buf + 6, cfg->keepalive_ms);
+    put_le32(buf + 8, cfg->sample_us);
+    put_le32(buf + 12, cfg->report_us);
+    put_le32(buf + 16, cfg->idle_timeout_ms);
+    return CONFIG_BLOCK_SIZE;
+}
+
+config_block_status_t config_block_parse(const uint8_t *buf, uint16_t len, config_block_t *cfg, bool *save)
+{
+    if (len != CONFIG_BLOCK_SIZE)
+    {
+        return CONFIG_BLOCK_ERR_LENGTH;
+    }
+    if (buf[0] != CONFIG_BLOCK_VERSION)
+    {
+        return CONFIG_BLOCK_ERR_VERSION;
+    }
+
+    uint8_t flags = buf[1];
+    uint16_t axis_deadband = get_le16(buf + 4);
+    uint16_t keepalive_ms = get_le16(buf + 6);
+    uint32_t sample_us = get_le32(buf + 8);
+    uint32_t report_us = get_le32(buf + 12);
+    uint32_t idle_timeout_ms = get_le32(buf + 16);
+
+    // The axis width byte is ignored, a host writing back what it read must not fail on it
+    if ((flags & ~(CONFIG_BLOCK_FLAG_FIXED_RATE | CONFIG_BLOCK_FLAG_SAVE)) || buf[3] != 0 ||
+        axis_deadband > AXIS_DEADBAND_MAX || keepalive_ms > KEEPALIVE_MS_MAX ||
+        sample_us < SAMPLE_US_MIN || sample_us > SAMPLE_US_MAX ||
+        report_us < REPORT_US_MIN || report_us > REPORT_US_MAX ||
+        idle_timeout_ms < IDLE_TIMEOUT_MS_MIN || idle_timeout_ms > IDLE_TIMEOUT_MS_MAX)
+    {
+        return CONFIG_BLOCK_ERR_RANGE;
+    }
+
+    cfg->fixed_rate = flags & CONFIG_BLOCK_FLAG_FIXED_RATE;
+    cfg->axis_deadband = axis_deadband;
+    cfg->keepalive_ms = keepalive_ms;
+    cfg->sample_us = sample_us;
+    cfg->report_us = report_us;
+    cfg->idle_timeout_ms = idle_timeout_ms;
+    *save = flags & CONFIG_BLOCK_FLAG_SAVE;
+    return CONFIG_BLOCK_OK;
+}
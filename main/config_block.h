@@ -0,0 +1,54 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Runtime settings exchanged with the host as a feature report. All fields are
+// little-endian:
+//
+//   0  u8   version (CONFIG_BLOCK_VERSION)
+//   1  u8   flags (CONFIG_BLOCK_FLAG_*)
+//   2  u8   axis width in the input report, read-only
+//   3  u8   reserved, 0
+//   4  u16  axis deadband (report units)
+//   6  u16  keepalive (ms), 0 disables it
+//   8  u32  active sample period (us)
+//   12 u32  active minimum report interval (us)
+//   16 u32  idle timeout (ms)
+#define CONFIG_BLOCK_VERSION 1
+#define CONFIG_BLOCK_SIZE 20
+
+#define CONFIG_BLOCK_FLAG_FIXED_RATE 0x01 // Never slow down when idle
+#define CONFIG_BLOCK_FLAG_SAVE 0x02       // Write only: also store the settings in flash
+
+typedef struct
+{
+    bool fixed_rate;
+    uint8_t axis_bits;
+    uint16_t axis_deadband;
+    uint16_t keepalive_ms;
+    uint32_t sample_us;
+    uint32_t report_us;
+    uint32_t idle_timeout_ms;
+} config_block_t;
+
+typedef enum
+{
+    CONFIG_BLOCK_OK = 0,
+    CONFIG_BLOCK_ERR_LENGTH,  // Not CONFIG_BLOCK_SIZE bytes
+    CONFIG_BLOCK_ERR_VERSION, // Written by an incompatible host tool
+    CONFIG_BLOCK_ERR_RANGE,   // A field is out of range or a reserved bit is set
+} config_block_status_t;
+
+// The menuconfig settings, used until the host or NVS provides others
+void config_block_defaults(config_block_t *cfg);
+
+// Serialize cfg into buf (CONFIG_BLOCK_SIZE bytes), returns the length
+uint16_t config_block_encode(const config_block_t *cfg, uint8_t *buf);
+
+// Validate and decode a block. cfg is only written when the result is CONFIG_BLOCK_OK;
+// axis_bits is left as it was. save tells whether the host asked to store the settings.
+config_block_status_t config_block_parse(const uint8_t *buf, uint16_t len, config_block_t *cfg, bool *save);
@@ -0,0 +1,31 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "console.h"
+
+#include "esp_console.h"
+#include "esp_log.h"
+
+static const char *TAG = "console";
+
+esp_err_t console_start(void)
+{
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    esp_console_dev_uart_config_t uart_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    esp_err_t ret;
+
+    repl_config.prompt = "gamepad>";
+    if ((ret = esp_console_new_repl_uart(&uart_config, &repl_config, &repl)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "create repl failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    esp_console_register_help_command();
+
+    if ((ret = esp_console_start_repl(repl)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "start repl failed: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
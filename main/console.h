@@ -0,0 +1,9 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include "esp_err.h"
+
+// Start the serial console. Modules register their commands with esp_console_cmd_register.
+esp_err_t console_start(void);
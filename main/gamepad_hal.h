@@ -0,0 +1,38 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "gamepad_state.h"
+
+// Input and output hardware behind the report path. gamepad_hal_esp.c drives the
+// real pins, ADC and PWM; gamepad_hal_sim.c replays scripted input and records the
+// outputs for the linux target. Reports leave through gamepad_transport.h.
+
+// Set up buttons and joysticks once at boot. Button edges notify the calling task.
+void gamepad_hal_input_init(void);
+
+// Mask of buttons that may have changed since the last call (every button when they
+// aren't edge-triggered). first_edge_us is latency_now() of the earliest edge, or now.
+gamepad_buttons_t gamepad_hal_take_edges(uint32_t *first_edge_us);
+
+// Bit i set when button i is pressed
+gamepad_buttons_t gamepad_hal_read_buttons(void);
+
+// Latest 12-bit reading of every axis, in report order
+void gamepad_hal_read_axes(uint16_t raw[GAMEPAD_NUM_AXES]);
+
+// Let every button wake the chip from light sleep: each pin wakes on the level
+// opposite to its current one. With interrupt capture the pin's edge still reaches
+// take_edges. disarm restores normal edge capture.
+void gamepad_hal_sleep_arm(void);
+void gamepad_hal_sleep_disarm(void);
+
+// Set up the rumble motors and player LEDs once at boot, all off
+void gamepad_hal_output_init(void);
+
+// Drive the motors (0 stops, 255 is fully on) and light player LED i + 1 for bit i.
+// Called from the actuator task only.
+void gamepad_hal_output_set(const gamepad_output_t *cmd);
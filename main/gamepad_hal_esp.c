@@ -0,0 +1,205 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "gamepad_hal.h"
+
+#include "hal/adc_types.h"
+#if !CONFIG_GAMEPAD_JOYSTICK_ADC_CONTINUOUS
+#include "driver/adc.h"
+#endif
+#include "esp_err.h"
+#if CONFIG_GAMEPAD_OUTPUT_REPORT
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+#endif
+
+#include "button_capture.h"
+#include "button_expander.h"
+#include "gamepad_report.h"
+#include "gpio_port.h"
+#include "joystick_adc.h"
+#include "latency_stats.h"
+
+// ADC1 channel of each axis, in report order
+static const uint8_t joystick_channels[GAMEPAD_NUM_AXES] = {
+#define AXIS_CHANNEL(name, channel, usage, bits) channel,
+    GAMEPAD_AXIS_LIST(AXIS_CHANNEL)
+#undef AXIS_CHANNEL
+};
+
+void gamepad_hal_input_init(void)
+{
+#if CONFIG_GAMEPAD_BUTTONS_SHIFT_REG
+    ESP_ERROR_CHECK(button_expander_start());
+#else
+    button_capture_init();
+#endif
+#if CONFIG_GAMEPAD_JOYSTICK_ADC_CONTINUOUS
+    joystick_adc_start(joystick_channels);
+#endif
+}
+
+#if CONFIG_GAMEPAD_BUTTONS_SHIFT_REG
+gamepad_buttons_t gamepad_hal_take_edges(uint32_t *first_edge_us)
+{
+    *first_edge_us = latency_now();
+    return GAMEPAD_ALL_BUTTONS_MASK;
+}
+
+gamepad_buttons_t gamepad_hal_read_buttons(void)
+{
+    return button_expander_read();
+}
+#else
+gamepad_buttons_t gamepad_hal_take_edges(uint32_t *first_edge_us)
+{
+    return button_capture_take_edges(first_edge_us);
+}
+
+gamepad_buttons_t gamepad_hal_read_buttons(void)
+{
+    return button_capture_read();
+}
+#endif
+
+void gamepad_hal_read_axes(uint16_t raw[GAMEPAD_NUM_AXES])
+{
+#if CONFIG_GAMEPAD_JOYSTICK_ADC_CONTINUOUS
+    joystick_adc_read(raw); // Averaged in the background, never blocks
+#else
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        raw[i] = adc1_get_raw((adc1_channel_t)joystick_channels[i]);
+    }
+#endif
+}
+
+// The shift-register chain has no wake-up pins; its presses are seen on the next doze sample
+void gamepad_hal_sleep_arm(void)
+{
+#if !CONFIG_GAMEPAD_BUTTONS_SHIFT_REG
+    gpio_port_wake_arm();
+#endif
+}
+
+void gamepad_hal_sleep_disarm(void)
+{
+#if !CONFIG_GAMEPAD_BUTTONS_SHIFT_REG
+    gpio_port_wake_disarm();
+#endif
+}
+
+#if CONFIG_GAMEPAD_OUTPUT_REPORT
+
+#define OUTPUT_LEDC_MODE LEDC_HIGH_SPEED_MODE
+#define OUTPUT_LEDC_TIMER LEDC_TIMER_0
+#define OUTPUT_DUTY_BITS LEDC_TIMER_8_BIT
+
+enum
+{
+    RUMBLE_STRONG = 0,
+    RUMBLE_WEAK,
+    RUMBLE_COUNT,
+};
+
+static const int s_rumble_pins[RUMBLE_COUNT] = {CONFIG_GAMEPAD_RUMBLE_STRONG_GPIO, CONFIG_GAMEPAD_RUMBLE_WEAK_GPIO};
+static const int s_led_pins[GAMEPAD_PLAYER_LEDS] = {CONFIG_GAMEPAD_PLAYER_LED1_GPIO, CONFIG_GAMEPAD_PLAYER_LED2_GPIO,
+                                                    CONFIG_GAMEPAD_PLAYER_LED3_GPIO, CONFIG_GAMEPAD_PLAYER_LED4_GPIO};
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t s_pwm_lock; // Held while a motor runs: PWM needs a steady APB clock and no sleep
+static bool s_motors_running;
+#endif
+
+void gamepad_hal_output_init(void)
+{
+    const ledc_timer_config_t timer_cfg = {
+        .speed_mode = OUTPUT_LEDC_MODE,
+        .duty_resolution = OUTPUT_DUTY_BITS,
+        .timer_num = OUTPUT_LEDC_TIMER,
+        .freq_hz = CONFIG_GAMEPAD_RUMBLE_PWM_HZ,
+        .clk_cfg = LEDC_AUTO_CLK,
+    };
+    ESP_ERROR_CHECK(ledc_timer_config(&timer_cfg));
+    for (int i = 0; i < RUMBLE_COUNT; i++)
+    {
+        if (s_rumble_pins[i] < 0)
+        {
+            continue;
+        }
+        const ledc_channel_config_t channel_cfg = {
+            .gpio_num = s_rumble_pins[i],
+            .speed_mode = OUTPUT_LEDC_MODE,
+            .channel = (ledc_channel_t)i,
+            .intr_type = LEDC_INTR_DISABLE,
+            .timer_sel = OUTPUT_LEDC_TIMER,
+            .duty = 0,
+        };
+        ESP_ERROR_CHECK(ledc_channel_config(&channel_cfg));
+    }
+    for (int i = 0; i < GAMEPAD_PLAYER_LEDS; i++)
+    {
+        if (s_led_pins[i] >= 0)
+        {
+            gpio_reset_pin(s_led_pins[i]);
+            gpio_set_direction(s_led_pins[i], GPIO_MODE_OUTPUT);
+            gpio_set_level(s_led_pins[i], 0);
+        }
+    }
+
+#if CONFIG_PM_ENABLE
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "rumble", &s_pwm_lock));
+#endif
+}
+
+void gamepad_hal_output_set(const gamepad_output_t *cmd)
+{
+    const uint8_t levels[RUMBLE_COUNT] = {cmd->rumble_strong, cmd->rumble_weak};
+
+#if CONFIG_PM_ENABLE
+    bool running = cmd->rumble_strong || cmd->rumble_weak;
+    if (running && !s_motors_running)
+    {
+        esp_pm_lock_acquire(s_pwm_lock);
+    }
+#endif
+    for (int i = 0; i < RUMBLE_COUNT; i++)
+    {
+        if (s_rumble_pins[i] >= 0)
+        {
+            // 255 is fully on: with 8 duty bits that takes a duty of 256
+            uint32_t duty = levels[i] == UINT8_MAX ? 1U << OUTPUT_DUTY_BITS : levels[i];
+            ledc_set_duty(OUTPUT_LEDC_MODE, (ledc_channel_t)i, duty);
+            ledc_update_duty(OUTPUT_LEDC_MODE, (ledc_channel_t)i);
+        }
+    }
+    for (int i = 0; i < GAMEPAD_PLAYER_LEDS; i++)
+    {
+        if (s_led_pins[i] >= 0)
+        {
+            gpio_set_level(s_led_pins[i], (cmd->player_leds >> i) & 1);
+        }
+    }
+#if CONFIG_PM_ENABLE
+    if (!running && s_motors_running)
+    {
+        esp_pm_lock_release(s_pwm_lock);
+    }
+    s_motors_running = running;
+#endif
+}
+
+#else
+
+void gamepad_hal_output_init(void)
+{
+}
+
+void gamepad_hal_output_set(const gamepad_output_t *cmd)
+{
+}
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "gamepad_hal.h"
+#include "gamepad_sim.h"
+
+#include <string.h>
+
+static const gamepad_sim_frame_t *s_frames;
+static size_t s_frame_count;
+static size_t s_next_frame;
+static uint32_t s_now_us;
+static uint32_t s_change_us;
+static gamepad_sim_frame_t s_current;
+static gamepad_buttons_t s_pending_buttons;
+static uint32_t s_first_edge_us;
+static gamepad_output_t s_output;
+static unsigned s_output_sets;
+
+void gamepad_sim_load(const gamepad_sim_frame_t *frames, size_t count)
+{
+    s_frames = frames;
+    s_frame_count = count;
+    s_next_frame = 0;
+    s_now_us = 0;
+    s_change_us = 0;
+    memset(&s_current, 0, sizeof(s_current));
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        s_current.axes[i] = 2048; // Sticks at rest until the script says otherwise
+    }
+}
+
+uint32_t gamepad_sim_advance(uint32_t now_us)
+{
+    s_now_us = now_us;
+    for (; s_next_frame < s_frame_count && s_frames[s_next_frame].time_us <= now_us; s_next_frame++)
+    {
+        const gamepad_sim_frame_t *frame = &s_frames[s_next_frame];
+        gamepad_buttons_t changed = frame->buttons ^ s_current.buttons;
+
+        if (changed)
+        {
+            if (!s_pending_buttons)
+            {
+                s_first_edge_us = frame->time_us;
+            }
+            s_pending_buttons |= changed;
+        }
+        if (changed || memcmp(frame->axes, s_current.axes, sizeof(frame->axes)) != 0)
+        {
+            s_change_us = frame->time_us;
+        }
+        s_current = *frame;
+    }
+    return s_change_us;
+}
+
+unsigned gamepad_sim_output(gamepad_output_t *last)
+{
+    *last = s_output;
+    return s_output_sets;
+}
+
+uint32_t gamepad_sim_end_us(void)
+{
+    return s_frame_count ? s_frames[s_frame_count - 1].time_us : 0;
+}
+
+void gamepad_hal_input_init(void)
+{
+    s_pending_buttons = GAMEPAD_ALL_BUTTONS_MASK; // Read every button on the first pass
+    s_first_edge_us = s_now_us;
+}
+
+gamepad_buttons_t gamepad_hal_take_edges(uint32_t *first_edge_us)
+{
+    gamepad_buttons_t pending = s_pending_buttons;
+
+    *first_edge_us = pending ? s_first_edge_us : s_now_us;
+    s_pending_buttons = 0;
+    return pending;
+}
+
+gamepad_buttons_t gamepad_hal_read_buttons(void)
+{
+    return s_current.buttons;
+}
+
+void gamepad_hal_read_axes(uint16_t raw[GAMEPAD_NUM_AXES])
+{
+    memcpy(raw, s_current.axes, sizeof(s_current.axes));
+}
+
+// Simulated time never sleeps
+void gamepad_hal_sleep_arm(void)
+{
+}
+
+void gamepad_hal_sleep_disarm(void)
+{
+}
+
+void gamepad_hal_output_init(void)
+{
+    memset(&s_output, 0, sizeof(s_output));
+    s_output_sets = 0;
+}
+
+void gamepad_hal_output_set(const gamepad_output_t *cmd)
+{
+    s_output = *cmd;
+    s_output_sets++;
+}
@@ -0,0 +1,82 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+#if CONFIG_GAMEPAD_REPORT_COMPACT
+#define GAMEPAD_AXIS_BITS 12 // The ADC's resolution; four axes fit in 6 bytes
+#else
+#define GAMEPAD_AXIS_BITS 16
+#endif
+
+// Every input on the pad, in report order. The HID descriptor, report layout,
+// packer and pin tables are all generated from these two lists.
+
+// AXIS(name, adc1_channel, usage, bits): Generic Desktop usage and report field width.
+// The axis value is reported as a signed field of the given width.
+#define GAMEPAD_AXIS_LIST(AXIS)                                            \
+    AXIS(LEFT_X, ADC_CHANNEL_7, 0x30, GAMEPAD_AXIS_BITS)  /* GPIO35 */     \
+    AXIS(LEFT_Y, ADC_CHANNEL_6, 0x31, GAMEPAD_AXIS_BITS)  /* GPIO34 */     \
+    AXIS(RIGHT_X, ADC_CHANNEL_3, 0x33, GAMEPAD_AXIS_BITS) /* GPIO39/ VN */ \
+    AXIS(RIGHT_Y, ADC_CHANNEL_0, 0x34, GAMEPAD_AXIS_BITS) /* GPIO36/ VP */
+
+// BUTTON(name, gpio): reported as Button 1..n in list order, one bit each. With a
+// shift-register chain the gpio column is unused and the named buttons are the first
+// inputs of the chain; the rest of the chain follows as unnamed buttons.
+#define GAMEPAD_BUTTON_LIST(BUTTON)                                        \
+    BUTTON(START, 22)                                                      \
+    BUTTON(MODE, 23)                                                       \
+    BUTTON(DPAD_UP, 5)                                                     \
+    BUTTON(DPAD_DOWN, 18)                                                  \
+    BUTTON(DPAD_LEFT, 19)                                                  \
+    BUTTON(DPAD_RIGHT, 21)                                                 \
+    BUTTON(A, 13)                                                          \
+    BUTTON(B, 12)                                                          \
+    BUTTON(X, 14)                                                          \
+    BUTTON(Y, 27)                                                          \
+    BUTTON(LEFT_BUMPER, 16)                                                \
+    BUTTON(LEFT_TRIGGER, 17)                                               \
+    BUTTON(RIGHT_BUMPER, 26)                                               \
+    BUTTON(RIGHT_TRIGGER, 25)                                              \
+    BUTTON(LEFT_JOYSTICK_BUTTON, 33)                                       \
+    BUTTON(RIGHT_JOYSTICK_BUTTON, 32)
+
+enum
+{
+#define GAMEPAD_AXIS_INDEX(name, channel, usage, bits) GAMEPAD_AXIS_##name,
+    GAMEPAD_AXIS_LIST(GAMEPAD_AXIS_INDEX)
+#undef GAMEPAD_AXIS_INDEX
+    GAMEPAD_NUM_AXES
+};
+
+enum
+{
+#define GAMEPAD_BUTTON_INDEX(name, gpio) GAMEPAD_BUTTON_##name,
+    GAMEPAD_BUTTON_LIST(GAMEPAD_BUTTON_INDEX)
+#undef GAMEPAD_BUTTON_INDEX
+    GAMEPAD_NUM_NAMED_BUTTONS
+};
+
+#if CONFIG_GAMEPAD_BUTTONS_SHIFT_REG
+#define GAMEPAD_NUM_BUTTONS (CONFIG_GAMEPAD_SHIFT_REG_COUNT * 8)
+#else
+#define GAMEPAD_NUM_BUTTONS GAMEPAD_NUM_NAMED_BUTTONS
+#endif
+
+// Button mask, bit i set when button i is pressed; just wide enough for every button
+#if CONFIG_GAMEPAD_BUTTONS_SHIFT_REG && CONFIG_GAMEPAD_SHIFT_REG_COUNT > 4
+typedef uint64_t gamepad_buttons_t;
+#elif CONFIG_GAMEPAD_BUTTONS_SHIFT_REG && CONFIG_GAMEPAD_SHIFT_REG_COUNT > 2
+typedef uint32_t gamepad_buttons_t;
+#else
+typedef uint16_t gamepad_buttons_t;
+#endif
+
+#define GAMEPAD_ALL_BUTTONS_MASK ((gamepad_buttons_t)-1 >> (sizeof(gamepad_buttons_t) * 8 - GAMEPAD_NUM_BUTTONS))
+
+_Static_assert(GAMEPAD_NUM_BUTTONS <= sizeof(gamepad_buttons_t) * 8, "button mask too narrow");
+_Static_assert(GAMEPAD_NUM_NAMED_BUTTONS <= GAMEPAD_NUM_BUTTONS, "chain too short for the named buttons");
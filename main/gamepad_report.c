@@ -0,0 +1,137 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "gamepad_report.h"
+
+#include <string.h>
+
+#include "config_block.h"
+
+#define LE16(v) (uint8_t)((v) & 0xFF), (uint8_t)(((v) >> 8) & 0xFF)
+
+// One signed field per axis
+#define AXIS_DESCRIPTOR(name, channel, usage, bits)                              \
+    0x09, usage,                         /* Usage */                             \
+    0x16, LE16(-(1 << ((bits) - 1))),    /* Logical Minimum */                   \
+    0x26, LE16((1 << ((bits) - 1)) - 1), /* Logical Maximum */                   \
+    0x75, bits,                          /* Report Size */                       \
+    0x95, 0x01,                          /* Report Count (1) */                  \
+    0x81, 0x02,                          /* Input (Data, Variable, Absolute) */
+
+const uint8_t gamepad_report_descriptor[] = {
+    0x05, 0x01, // Usage Page (Generic Desktop)
+    0x09, 0x05, // Usage (Gamepad)
+    0xA1, 0x01, // Collection (Application)
+
+    // Report ID
+    0x85, GAMEPAD_REPORT_ID,
+
+    // Joysticks
+    GAMEPAD_AXIS_LIST(AXIS_DESCRIPTOR)
+
+    // Buttons
+    0x05, 0x09,                // Usage Page (Button)
+    0x19, 0x01,                // Usage Minimum (Button 1)
+    0x29, GAMEPAD_NUM_BUTTONS, // Usage Maximum
+    0x15, 0x00,                // Logical Minimum (0)
+    0x25, 0x01,                // Logical Maximum (1)
+    0x75, 0x01,                // Report Size (1 bit)
+    0x95, GAMEPAD_NUM_BUTTONS, // Report Count
+    0x81, 0x02,                // Input (Data, Variable, Absolute)
+
+    // Runtime settings, opaque bytes read and written with GET_REPORT / SET_REPORT
+    0x85, GAMEPAD_CONFIG_REPORT_ID,
+    0x06, 0x00, 0xFF,          // Usage Page (Vendor Defined 0xFF00)
+    0x09, 0x01,                // Usage (0x01)
+    0x15, 0x00,                // Logical Minimum (0)
+    0x26, 0xFF, 0x00,          // Logical Maximum (255)
+    0x75, 0x08,                // Report Size (8 bits)
+    0x95, CONFIG_BLOCK_SIZE,   // Report Count
+    0xB1, 0x02,                // Feature (Data, Variable, Absolute)
+
+#if CONFIG_GAMEPAD_OUTPUT_REPORT
+    // Rumble motor strengths and player LEDs, written by the host
+    0x85, GAMEPAD_OUTPUT_REPORT_ID,
+    0x06, 0x00, 0xFF,          // Usage Page (Vendor Defined 0xFF00)
+    0x09, 0x02,                // Usage (0x02)
+    0x15, 0x00,                // Logical Minimum (0)
+    0x26, 0xFF, 0x00,          // Logical Maximum (255)
+    0x75, 0x08,                // Report Size (8 bits)
+    0x95, 0x02,                // Report Count (2)
+    0x91, 0x02,                // Output (Data, Variable, Absolute)
+    0x05, 0x08,                // Usage Page (LEDs)
+    0x19, 0x61,                // Usage Minimum (Player 1)
+    0x29, 0x60 + GAMEPAD_PLAYER_LEDS, // Usage Maximum
+    0x25, 0x01,                // Logical Maximum (1)
+    0x75, 0x01,                // Report Size (1 bit)
+    0x95, GAMEPAD_PLAYER_LEDS, // Report Count
+    0x91, 0x02,                // Output (Data, Variable, Absolute)
+    0x75, 8 - GAMEPAD_PLAYER_LEDS, // Report Size (padding)
+    0x95, 0x01,                // Report Count (1)
+    0x91, 0x03,                // Output (Constant)
+#endif
+
+    // End Collection
+    0xC0};
+
+const int gamepad_report_descriptor_len = sizeof(gamepad_report_descriptor);
+
+// OR the low bits of value into buf at bit offset off, least significant bit first.
+// Offset and width are constants at every call, so this folds to a few shifts and ORs.
+static inline void put_field(uint8_t *buf, unsigned off, unsigned bits, uint32_t value)
+{
+    uint32_t v = (value & ((1UL << bits) - 1)) << (off % 8);
+
+    buf[off / 8] |= (uint8_t)v;
+    if (off % 8 + bits > 8)
+    {
+        buf[off / 8 + 1] |= (uint8_t)(v >> 8);
+    }
+    if (off % 8 + bits > 16)
+    {
+        buf[off / 8 + 2] |= (uint8_t)(v >> 16);
+    }
+}
+
+// The buttons start on a byte boundary and may be wider than put_field handles, so they
+// go in a byte at a time; bits past the last button are left clear
+static inline void put_buttons(uint8_t *buf, gamepad_buttons_t buttons)
+{
+    _Static_assert(GAMEPAD_REPORT_BUTTONS_OFFSET % 8 == 0, "buttons must start on a byte boundary");
+
+    buttons &= GAMEPAD_ALL_BUTTONS_MASK;
+    for (unsigned i = 0; i < (GAMEPAD_NUM_BUTTONS + 7) / 8; i++)
+    {
+        buf[GAMEPAD_REPORT_BUTTONS_OFFSET / 8 + i] = (uint8_t)(buttons >> (8 * i));
+    }
+}
+
+// Axes narrower than 16 bits keep their most significant bits
+#define AXIS_PACK(name, channel, usage, bits)                                    \
+    _Static_assert((bits) >= 2 && (bits) <= 16, #name " width out of range");    \
+    put_field(buf, GAMEPAD_REPORT_##name##_OFFSET, bits, (uint32_t)(state->axes[GAMEPAD_AXIS_##name] >> (16 - (bits))));
+
+uint16_t gamepad_report_pack(const gamepad_state_t *state, uint8_t *buf)
+{
+    memset(buf, 0, GAMEPAD_REPORT_SIZE);
+    GAMEPAD_AXIS_LIST(AXIS_PACK)
+    put_buttons(buf, state->buttons);
+    return GAMEPAD_REPORT_SIZE;
+}
+
+bool gamepad_output_parse(const uint8_t *data, uint16_t len, gamepad_output_t *out)
+{
+    if (len == GAMEPAD_OUTPUT_REPORT_SIZE + 1 && data[0] == GAMEPAD_OUTPUT_REPORT_ID)
+    {
+        data++; // Report ID left in front of the payload
+        len--;
+    }
+    if (len != GAMEPAD_OUTPUT_REPORT_SIZE)
+    {
+        return false;
+    }
+    out->rumble_strong = data[0];
+    out->rumble_weak = data[1];
+    out->player_leds = data[2] & ((1U << GAMEPAD_PLAYER_LEDS) - 1); // The padding bits are ignored
+    return true;
+}
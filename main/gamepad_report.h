@@ -0,0 +1,44 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gamepad_state.h"
+
+#define GAMEPAD_REPORT_ID 0x01
+#define GAMEPAD_CONFIG_REPORT_ID 0x02 // Feature report carrying a config_block.h settings block
+#define GAMEPAD_OUTPUT_REPORT_ID 0x03 // Rumble and player LEDs, from the host
+
+// Output report: strong motor, weak motor, player LEDs 1-4 in the low nibble
+#define GAMEPAD_OUTPUT_REPORT_SIZE 3
+#define GAMEPAD_PLAYER_LEDS 4
+
+// Report bit layout generated from gamepad_inputs.h: the axes in list order, then one bit
+// per button. Each axis gets an _OFFSET (first bit) and a _LAST (last bit) constant.
+enum
+{
+#define GAMEPAD_REPORT_AXIS_FIELD(name, channel, usage, bits) \
+    GAMEPAD_REPORT_##name##_OFFSET,                           \
+    GAMEPAD_REPORT_##name##_LAST = GAMEPAD_REPORT_##name##_OFFSET + (bits) - 1,
+    GAMEPAD_AXIS_LIST(GAMEPAD_REPORT_AXIS_FIELD)
+#undef GAMEPAD_REPORT_AXIS_FIELD
+    GAMEPAD_REPORT_BUTTONS_OFFSET,
+    GAMEPAD_REPORT_BITS = GAMEPAD_REPORT_BUTTONS_OFFSET + GAMEPAD_NUM_BUTTONS,
+};
+
+#define GAMEPAD_REPORT_SIZE (GAMEPAD_REPORT_BITS / 8)
+
+_Static_assert(GAMEPAD_REPORT_BITS % 8 == 0, "input map must fill whole bytes");
+
+extern const uint8_t gamepad_report_descriptor[];
+extern const int gamepad_report_descriptor_len;
+
+// Build the input report for one sample into buf (GAMEPAD_REPORT_SIZE bytes), returns its length
+uint16_t gamepad_report_pack(const gamepad_state_t *state, uint8_t *buf);
+
+// Read an output report straight from the transport's buffer, with or without the report
+// ID in front. Returns false, leaving out untouched, when the length doesn't match.
+bool gamepad_output_parse(const uint8_t *data, uint16_t len, gamepad_output_t *out);
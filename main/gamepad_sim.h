@@ -0,0 +1,33 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gamepad_state.h"
+
+// Scripted input and recorded outputs behind gamepad_hal.h on the linux target
+
+typedef struct
+{
+    uint32_t time_us;                // The inputs hold these values from this time on
+    gamepad_buttons_t buttons;       // Bit i set when button i is pressed
+    uint16_t axes[GAMEPAD_NUM_AXES]; // Raw 12-bit readings
+} gamepad_sim_frame_t;
+
+// Replay frames, sorted by time. The array must outlive the replay.
+void gamepad_sim_load(const gamepad_sim_frame_t *frames, size_t count);
+
+// Move the simulated clock to now_us, applying every frame due by then.
+// Returns the time of the last input change.
+uint32_t gamepad_sim_advance(uint32_t now_us);
+
+// Time of the last frame in the script
+uint32_t gamepad_sim_end_us(void);
+
+// The last outputs gamepad_hal_output_set was given (all off before the first), and how
+// many times it was called since gamepad_hal_output_init
+unsigned gamepad_sim_output(gamepad_output_t *last);
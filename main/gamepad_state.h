@@ -0,0 +1,24 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "gamepad_inputs.h"
+
+// One sample of every input on the pad, in report units
+typedef struct
+{
+    int16_t axes[GAMEPAD_NUM_AXES]; // Indexed by GAMEPAD_AXIS_*
+    gamepad_buttons_t buttons;      // Bit GAMEPAD_BUTTON_* set when pressed
+} gamepad_state_t;
+
+// Feedback the host asked for with the latest output report
+typedef struct
+{
+    uint8_t rumble_strong; // Heavy (low-frequency) motor, 0 off to 255 full
+    uint8_t rumble_weak;   // Light (high-frequency) motor
+    uint8_t player_leds;   // Bit i lights player LED i + 1
+    uint32_t received_us;  // latency_now() when the report arrived
+} gamepad_output_t;
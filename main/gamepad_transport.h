@@ -0,0 +1,57 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Bluetooth link behind the report path, picked in menuconfig: gamepad_transport_bt.c
+// is Classic BT HID, gamepad_transport_ble.c is HID over GATT (HOGP) on BLE. On the
+// linux target gamepad_transport_fake.c records reports instead. All of them carry the
+// descriptor and reports from gamepad_report.h unchanged.
+
+typedef enum
+{
+    GAMEPAD_REPORT_TYPE_INPUT,
+    GAMEPAD_REPORT_TYPE_OUTPUT,
+    GAMEPAD_REPORT_TYPE_FEATURE,
+} gamepad_report_type_t;
+
+typedef enum
+{
+    GAMEPAD_SET_REPORT_OK,
+    GAMEPAD_SET_REPORT_INVALID,    // Known report, bad contents
+    GAMEPAD_SET_REPORT_UNKNOWN_ID, // No such report of this type
+} gamepad_set_report_status_t;
+
+// Host events, called from a Bluetooth task
+typedef struct
+{
+    // A host connected; the link is up and reports may be sent
+    void (*connected)(void);
+    // The link is gone. May block until the sender stopped.
+    void (*disconnected)(void);
+    // An input report taken by gamepad_transport_send_report has left the stack, or failed
+    void (*sent)(bool ok);
+    // Copy the current report into buf, returns its length or 0 when there is no such report
+    uint16_t (*get_report)(gamepad_report_type_t type, uint8_t report_id, uint8_t *buf, uint16_t size);
+    // The host wrote a report, on either channel
+    gamepad_set_report_status_t (*set_report)(gamepad_report_type_t type, uint8_t report_id, const uint8_t *data,
+                                              uint16_t len);
+    // Boot protocol selected (no reports for a gamepad) or back to report protocol
+    void (*set_protocol)(bool boot);
+} gamepad_transport_callbacks_t;
+
+// Largest report passed to get_report
+#define GAMEPAD_TRANSPORT_MAX_REPORT 32
+
+// Bring up the controller and host stack, register the descriptor and wait for a host.
+// callbacks must stay valid for the whole run.
+esp_err_t gamepad_transport_start(const gamepad_transport_callbacks_t *callbacks);
+
+// Hand an input report to the stack, 0 when accepted; sent() follows for every accepted
+// report. Matches send_pipeline_send_t.
+int gamepad_transport_send_report(void *ctx, uint8_t report_id, const uint8_t *data, uint16_t len);
@@ -0,0 +1,297 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "gamepad_transport.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "esp_bt.h"
+#include "esp_bt_device.h"
+#include "esp_bt_main.h"
+#include "esp_gap_ble_api.h"
+#include "esp_gatts_api.h"
+#include "esp_hidd.h"
+#include "esp_hidd_gatts.h"
+#include "esp_log.h"
+
+#include "boot_metrics.h"
+#include "gamepad_report.h"
+#include "trace_log.h"
+
+// HID over GATT through the esp_hid component. It owns the HID service and its report
+// characteristics; this file does the GAP side (advertising, bonding, connection
+// parameters) and maps its events onto the transport callbacks.
+//
+// Input reports are notifications. Bluedroid reports each one with ESP_GATTS_CONF_EVT
+// once it is handed to the controller, which takes the place of the Classic send
+// completion for the send pipeline's credits.
+
+#define BLE_SUPERVISION_TIMEOUT_MS 4000
+
+static const char *TAG = "transport_ble";
+
+static const gamepad_transport_callbacks_t *s_callbacks;
+static esp_hidd_dev_t *s_dev;
+static atomic_uint s_notifies; // Input notifications not yet confirmed, other confirmations are ignored
+
+static esp_hid_raw_report_map_t s_report_map;
+static esp_hid_device_config_t s_hid_config = {
+    .vendor_id = 0x16C0,
+    .product_id = 0x05DF,
+    .version = 0x0100,
+    .device_name = "ESP32 Gamepad",
+    .manufacturer_name = "Espressif",
+    .serial_number = "1234567890",
+    .report_maps = &s_report_map,
+    .report_maps_len = 1,
+};
+
+// The 16-bit HID service UUID (0x1812) in its 128-bit form
+static uint8_t s_hid_service_uuid[16] = {0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80,
+                                         0x00, 0x10, 0x00, 0x00, 0x12, 0x18, 0x00, 0x00};
+
+static esp_ble_adv_data_t s_adv_data = {
+    .set_scan_rsp = false,
+    .include_name = true,
+    .include_txpower = true,
+    .min_interval = CONFIG_GAMEPAD_BLE_CONN_INTERVAL_MIN, // Peripheral preferred connection interval
+    .max_interval = CONFIG_GAMEPAD_BLE_CONN_INTERVAL_MAX,
+    .appearance = ESP_HID_APPEARANCE_GAMEPAD,
+    .service_uuid_len = sizeof(s_hid_service_uuid),
+    .p_service_uuid = s_hid_service_uuid,
+    .flag = ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT,
+};
+
+static esp_ble_adv_params_t s_adv_params = {
+    .adv_int_min = 0x20, // 20 ms
+    .adv_int_max = 0x30, // 30 ms
+    .adv_type = ADV_TYPE_IND,
+    .own_addr_type = BLE_ADDR_TYPE_PUBLIC,
+    .channel_map = ADV_CHNL_ALL,
+    .adv_filter_policy = ADV_FILTER_ALLOW_SCAN_ANY_CON_ANY,
+};
+
+int gamepad_transport_send_report(void *ctx, uint8_t report_id, const uint8_t *data, uint16_t len)
+{
+    atomic_fetch_add(&s_notifies, 1);
+    esp_err_t ret = esp_hidd_dev_input_set(s_dev, 0, report_id, (uint8_t *)data, len);
+    if (ret != ESP_OK)
+    {
+        atomic_fetch_sub(&s_notifies, 1);
+    }
+    return ret;
+}
+
+static bool take_notify(void)
+{
+    unsigned notifies = atomic_load(&s_notifies);
+    while (notifies > 0 && !atomic_compare_exchange_weak(&s_notifies, &notifies, notifies - 1))
+    {
+    }
+    return notifies > 0;
+}
+
+// GATT serves reads of the settings characteristic from its stored value, so keep it current
+static void refresh_feature(void)
+{
+    uint8_t block[GAMEPAD_TRANSPORT_MAX_REPORT];
+    uint16_t len = s_callbacks->get_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, block, sizeof(block));
+
+    if (len)
+    {
+        esp_hidd_dev_feature_set(s_dev, 0, GAMEPAD_CONFIG_REPORT_ID, block, len);
+    }
+}
+
+static void ble_gap_cb(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param)
+{
+    switch (event)
+    {
+    case ESP_GAP_BLE_ADV_DATA_SET_COMPLETE_EVT:
+        esp_ble_gap_start_advertising(&s_adv_params);
+        break;
+    case ESP_GAP_BLE_ADV_START_COMPLETE_EVT:
+        if (param->adv_start_cmpl.status != ESP_BT_STATUS_SUCCESS)
+        {
+            ESP_LOGE(TAG, "advertising start failed, status:%d", param->adv_start_cmpl.status);
+        }
+        break;
+    case ESP_GAP_BLE_SEC_REQ_EVT:
+        esp_ble_gap_security_rsp(param->ble_security.ble_req.bd_addr, true);
+        break;
+    case ESP_GAP_BLE_AUTH_CMPL_EVT:
+        if (param->ble_security.auth_cmpl.success)
+        {
+            ESP_LOGI(TAG, "authentication success");
+            esp_log_buffer_hex(TAG, param->ble_security.auth_cmpl.bd_addr, ESP_BD_ADDR_LEN);
+        }
+        else
+        {
+            ESP_LOGE(TAG, "authentication failed, reason:0x%x", param->ble_security.auth_cmpl.fail_reason);
+        }
+        break;
+    case ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT:
+        TRACE_LOG3(TRACE_EVT_BLE_CONN_PARAMS, param->update_conn_params.status, param->update_conn_params.conn_int,
+                   param->update_conn_params.latency);
+        break;
+    default:
+        TRACE_LOG1(TRACE_EVT_BLE_GAP_EVENT, event);
+        break;
+    }
+}
+
+static void ble_gatts_cb(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param)
+{
+    switch (event)
+    {
+    case ESP_GATTS_CONNECT_EVT:
+    {
+        // Ask for a short interval straight away; the host has the last word
+        esp_ble_conn_update_params_t conn_params = {
+            .min_int = CONFIG_GAMEPAD_BLE_CONN_INTERVAL_MIN,
+            .max_int = CONFIG_GAMEPAD_BLE_CONN_INTERVAL_MAX,
+            .latency = CONFIG_GAMEPAD_BLE_PERIPHERAL_LATENCY,
+            .timeout = BLE_SUPERVISION_TIMEOUT_MS / 10,
+        };
+        memcpy(conn_params.bda, param->connect.remote_bda, sizeof(esp_bd_addr_t));
+        esp_ble_gap_update_conn_params(&conn_params);
+        break;
+    }
+    case ESP_GATTS_CONF_EVT:
+        if (take_notify())
+        {
+            s_callbacks->sent(param->conf.status == ESP_GATT_OK);
+        }
+        if (param->conf.status != ESP_GATT_OK)
+        {
+            TRACE_LOG2(TRACE_EVT_BLE_NOTIFY_FAILED, param->conf.handle, param->conf.status);
+        }
+        break;
+    default:
+        break;
+    }
+    esp_hidd_gatts_event_handler(event, gatts_if, param);
+}
+
+static void hidd_event_cb(void *handler_args, esp_event_base_t base, int32_t id, void *event_data)
+{
+    esp_hidd_event_data_t *param = event_data;
+
+    switch ((esp_hidd_event_t)id)
+    {
+    case ESP_HIDD_START_EVENT:
+        ESP_LOGI(TAG, "HID service started, advertising");
+        boot_metrics_mark(BOOT_MARK_HID_READY);
+        refresh_feature();
+        esp_ble_gap_config_adv_data(&s_adv_data);
+        break;
+    case ESP_HIDD_CONNECT_EVENT:
+        ESP_LOGI(TAG, "connected");
+        atomic_store(&s_notifies, 0);
+        refresh_feature();
+        s_callbacks->connected();
+        break;
+    case ESP_HIDD_PROTOCOL_MODE_EVENT:
+        ESP_LOGI(TAG, "protocol mode:%u", param->protocol_mode.protocol_mode);
+        s_callbacks->set_protocol(param->protocol_mode.protocol_mode == ESP_HID_PROTOCOL_MODE_BOOT);
+        break;
+    case ESP_HIDD_CONTROL_EVENT:
+        ESP_LOGI(TAG, "%s", param->control.control ? "host exit suspend" : "host suspend");
+        break;
+    case ESP_HIDD_OUTPUT_EVENT:
+        // Rumble and LEDs, written without response; parsed straight from the stack's buffer
+        s_callbacks->set_report(GAMEPAD_REPORT_TYPE_OUTPUT, param->output.report_id, param->output.data,
+                                param->output.length);
+        break;
+    case ESP_HIDD_FEATURE_EVENT:
+        if (s_callbacks->set_report(GAMEPAD_REPORT_TYPE_FEATURE, param->feature.report_id, param->feature.data,
+                                    param->feature.length) != GAMEPAD_SET_REPORT_OK)
+        {
+            ESP_LOGW(TAG, "feature report 0x%02x rejected", param->feature.report_id);
+        }
+        refresh_feature(); // Rejected writes read back as the settings in use
+        break;
+    case ESP_HIDD_DISCONNECT_EVENT:
+        ESP_LOGI(TAG, "disconnected, reason:0x%x", param->disconnect.reason);
+        s_callbacks->disconnected();
+        esp_ble_gap_start_advertising(&s_adv_params);
+        break;
+    case ESP_HIDD_STOP_EVENT:
+        ESP_LOGI(TAG, "HID service stopped");
+        break;
+    default:
+        break;
+    }
+}
+
+esp_err_t gamepad_transport_start(const gamepad_transport_callbacks_t *callbacks)
+{
+    esp_err_t ret;
+
+    s_callbacks = callbacks;
+
+    ESP_ERROR_CHECK(esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT));
+
+    esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
+    if ((ret = esp_bt_controller_init(&bt_cfg)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "initialize controller failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if ((ret = esp_bt_controller_enable(ESP_BT_MODE_BLE)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "enable controller failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if ((ret = esp_bluedroid_init()) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "initialize bluedroid failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if ((ret = esp_bluedroid_enable()) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "enable bluedroid failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if ((ret = esp_ble_gap_register_callback(ble_gap_cb)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "gap register failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if ((ret = esp_ble_gatts_register_callback(ble_gatts_cb)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "gatts register failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    esp_ble_gap_set_device_name(s_hid_config.device_name);
+
+    // Just Works bonding, there is no display or keypad
+    esp_ble_auth_req_t auth_req = ESP_LE_AUTH_BOND;
+    esp_ble_io_cap_t iocap = ESP_IO_CAP_NONE;
+    uint8_t key_size = 16;
+    uint8_t keys = ESP_BLE_ENC_KEY_MASK | ESP_BLE_ID_KEY_MASK;
+    esp_ble_gap_set_security_param(ESP_BLE_SM_AUTHEN_REQ_MODE, &auth_req, sizeof(auth_req));
+    esp_ble_gap_set_security_param(ESP_BLE_SM_IOCAP_MODE, &iocap, sizeof(iocap));
+    esp_ble_gap_set_security_param(ESP_BLE_SM_MAX_KEY_SIZE, &key_size, sizeof(key_size));
+    esp_ble_gap_set_security_param(ESP_BLE_SM_SET_INIT_KEY, &keys, sizeof(keys));
+    esp_ble_gap_set_security_param(ESP_BLE_SM_SET_RSP_KEY, &keys, sizeof(keys));
+
+    // Same descriptor as Classic; esp_hid builds one report characteristic per report ID
+    s_report_map.data = gamepad_report_descriptor;
+    s_report_map.len = gamepad_report_descriptor_len;
+    if ((ret = esp_hidd_dev_init(&s_hid_config, ESP_HID_TRANSPORT_BLE, hidd_event_cb, &s_dev)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "hid device init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Own address:" ESP_BD_ADDR_STR, ESP_BD_ADDR_HEX(esp_bt_dev_get_address()));
+    return ESP_OK;
+}
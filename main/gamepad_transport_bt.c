@@ -0,0 +1,426 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "gamepad_transport.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_bt.h"
+#include "esp_bt_device.h"
+#include "esp_bt_main.h"
+#include "esp_gap_bt_api.h"
+#include "esp_hidd_api.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "boot_metrics.h"
+#include "gamepad_report.h"
+#include "last_host.h"
+#include "trace_log.h"
+
+static const char *TAG = "transport_bt";
+
+static const gamepad_transport_callbacks_t *s_callbacks;
+static esp_hidd_app_param_t s_app_param;
+static esp_hidd_qos_param_t s_both_qos;
+
+static char *bda2str(esp_bd_addr_t bda, char *str, size_t size)
+{
+    if (bda == NULL || str == NULL || size < 18)
+    {
+        return NULL;
+    }
+
+    uint8_t *p = bda;
+    sprintf(str, "%02x:%02x:%02x:%02x:%02x:%02x",
+            p[0], p[1], p[2], p[3], p[4], p[5]);
+    return str;
+}
+
+static gamepad_report_type_t report_type(uint8_t hidd_type)
+{
+    switch (hidd_type)
+    {
+    case ESP_HIDD_REPORT_TYPE_FEATURE:
+        return GAMEPAD_REPORT_TYPE_FEATURE;
+    case ESP_HIDD_REPORT_TYPE_OUTPUT:
+        return GAMEPAD_REPORT_TYPE_OUTPUT;
+    default:
+        return GAMEPAD_REPORT_TYPE_INPUT;
+    }
+}
+
+int gamepad_transport_send_report(void *ctx, uint8_t report_id, const uint8_t *data, uint16_t len)
+{
+    return esp_bt_hid_device_send_report(ESP_HIDD_REPORT_TYPE_INTRDATA, report_id, len, (uint8_t *)data);
+}
+
+void esp_bt_gap_cb(esp_bt_gap_cb_event_t event, esp_bt_gap_cb_param_t *param)
+{
+    const char *TAG = "esp_bt_gap_cb";
+    switch (event)
+    {
+    case ESP_BT_GAP_AUTH_CMPL_EVT:
+    {
+        if (param->auth_cmpl.stat == ESP_BT_STATUS_SUCCESS)
+        {
+            ESP_LOGI(TAG, "authentication success: %s", param->auth_cmpl.device_name);
+            esp_log_buffer_hex(TAG, param->auth_cmpl.bda, ESP_BD_ADDR_LEN);
+        }
+        else
+        {
+            ESP_LOGE(TAG, "authentication failed, status:%d", param->auth_cmpl.stat);
+        }
+        break;
+    }
+    case ESP_BT_GAP_PIN_REQ_EVT:
+    {
+        ESP_LOGI(TAG, "ESP_BT_GAP_PIN_REQ_EVT min_16_digit:%d", param->pin_req.min_16_digit);
+        if (param->pin_req.min_16_digit)
+        {
+            ESP_LOGI(TAG, "Input pin code: 0000 0000 0000 0000");
+            esp_bt_pin_code_t pin_code = {0};
+            esp_bt_gap_pin_reply(param->pin_req.bda, true, 16, pin_code);
+        }
+        else
+        {
+            ESP_LOGI(TAG, "Input pin code: 1234");
+            esp_bt_pin_code_t pin_code;
+            pin_code[0] = '1';
+            pin_code[1] = '2';
+            pin_code[2] = '3';
+            pin_code[3] = '4';
+            esp_bt_gap_pin_reply(param->pin_req.bda, true, 4, pin_code);
+        }
+        break;
+    }
+
+#if (CONFIG_EXAMPLE_SSP_ENABLED == true)
+    case ESP_BT_GAP_CFM_REQ_EVT:
+        ESP_LOGI(TAG, "ESP_BT_GAP_CFM_REQ_EVT Please compare the numeric value: %" PRIu32, param->cfm_req.num_val);
+        esp_bt_gap_ssp_confirm_reply(param->cfm_req.bda, true);
+        break;
+    case ESP_BT_GAP_KEY_NOTIF_EVT:
+        ESP_LOGI(TAG, "ESP_BT_GAP_KEY_NOTIF_EVT passkey:%" PRIu32, param->key_notif.passkey);
+        break;
+    case ESP_BT_GAP_KEY_REQ_EVT:
+        ESP_LOGI(TAG, "ESP_BT_GAP_KEY_REQ_EVT Please enter passkey!");
+        break;
+#endif
+    case ESP_BT_GAP_MODE_CHG_EVT:
+        TRACE_LOG1(TRACE_EVT_GAP_MODE_CHG, param->mode_chg.mode);
+        break;
+    default:
+        TRACE_LOG1(TRACE_EVT_GAP_EVENT, event);
+        break;
+    }
+    return;
+}
+
+static void disconnected(void)
+{
+    ESP_LOGI(TAG, "disconnected!");
+    s_callbacks->disconnected();
+    ESP_LOGI(TAG, "making self discoverable and connectable again.");
+    esp_bt_gap_set_scan_mode(ESP_BT_CONNECTABLE, ESP_BT_GENERAL_DISCOVERABLE);
+}
+
+void esp_bt_hidd_cb(esp_hidd_cb_event_t event, esp_hidd_cb_param_t *param)
+{
+    static const char *TAG = "esp_bt_hidd_cb";
+    switch (event)
+    {
+    case ESP_HIDD_INIT_EVT:
+        if (param->init.status == ESP_HIDD_SUCCESS)
+        {
+            ESP_LOGI(TAG, "setting hid parameters");
+            esp_bt_hid_device_register_app(&s_app_param, &s_both_qos, &s_both_qos);
+        }
+        else
+        {
+            ESP_LOGE(TAG, "init hidd failed!");
+        }
+        break;
+    case ESP_HIDD_DEINIT_EVT:
+        break;
+    case ESP_HIDD_REGISTER_APP_EVT:
+        if (param->register_app.status == ESP_HIDD_SUCCESS)
+        {
+            ESP_LOGI(TAG, "setting hid parameters success!");
+            ESP_LOGI(TAG, "setting to connectable, discoverable");
+            esp_bt_gap_set_scan_mode(ESP_BT_CONNECTABLE, ESP_BT_GENERAL_DISCOVERABLE);
+            boot_metrics_mark(BOOT_MARK_HID_READY);
+            esp_bd_addr_t host;
+            if (last_host_boot_target(param->register_app.in_use, param->register_app.bd_addr, host))
+            {
+                char bda_str[18];
+                ESP_LOGI(TAG, "%s %s", param->register_app.in_use ? "start virtual cable plug!" : "paging last host",
+                         bda2str(host, bda_str, sizeof(bda_str)));
+                boot_metrics_mark(BOOT_MARK_PAGE);
+                esp_bt_hid_device_connect(host);
+            }
+        }
+        else
+        {
+            ESP_LOGE(TAG, "setting hid parameters failed!");
+        }
+        break;
+    case ESP_HIDD_UNREGISTER_APP_EVT:
+        if (param->unregister_app.status == ESP_HIDD_SUCCESS)
+        {
+            ESP_LOGI(TAG, "unregister app success!");
+        }
+        else
+        {
+            ESP_LOGE(TAG, "unregister app failed!");
+        }
+        break;
+    case ESP_HIDD_OPEN_EVT:
+        if (param->open.status == ESP_HIDD_SUCCESS)
+        {
+            if (param->open.conn_status == ESP_HIDD_CONN_STATE_CONNECTING)
+            {
+                ESP_LOGI(TAG, "connecting...");
+            }
+            else if (param->open.conn_status == ESP_HIDD_CONN_STATE_CONNECTED)
+            {
+                ESP_LOGI(TAG, "connected to %02x:%02x:%02x:%02x:%02x:%02x", param->open.bd_addr[0],
+                         param->open.bd_addr[1], param->open.bd_addr[2], param->open.bd_addr[3], param->open.bd_addr[4],
+                         param->open.bd_addr[5]);
+#if CONFIG_GAMEPAD_FAST_RECONNECT
+                last_host_set(param->open.bd_addr);
+#endif
+                s_callbacks->connected();
+                ESP_LOGI(TAG, "making self non-discoverable and non-connectable.");
+                esp_bt_gap_set_scan_mode(ESP_BT_NON_CONNECTABLE, ESP_BT_NON_DISCOVERABLE);
+            }
+            else
+            {
+                ESP_LOGE(TAG, "unknown connection status");
+            }
+        }
+        else
+        {
+            ESP_LOGE(TAG, "open failed!");
+        }
+        break;
+    case ESP_HIDD_CLOSE_EVT:
+        ESP_LOGI(TAG, "ESP_HIDD_CLOSE_EVT");
+        if (param->close.status == ESP_HIDD_SUCCESS)
+        {
+            if (param->close.conn_status == ESP_HIDD_CONN_STATE_DISCONNECTING)
+            {
+                ESP_LOGI(TAG, "disconnecting...");
+            }
+            else if (param->close.conn_status == ESP_HIDD_CONN_STATE_DISCONNECTED)
+            {
+                disconnected();
+            }
+            else
+            {
+                ESP_LOGE(TAG, "unknown connection status");
+            }
+        }
+        else
+        {
+            ESP_LOGE(TAG, "close failed!");
+        }
+        break;
+    case ESP_HIDD_SEND_REPORT_EVT:
+        if (param->send_report.report_type == ESP_HIDD_REPORT_TYPE_INTRDATA)
+        {
+            s_callbacks->sent(param->send_report.status == ESP_HIDD_SUCCESS);
+        }
+        if (param->send_report.status == ESP_HIDD_SUCCESS)
+        {
+            TRACE_LOG2(TRACE_EVT_HIDD_SEND_REPORT, param->send_report.report_id, param->send_report.report_type);
+        }
+        else
+        {
+            TRACE_LOG4(TRACE_EVT_HIDD_SEND_REPORT_FAILED, param->send_report.report_id, param->send_report.report_type,
+                       param->send_report.status, param->send_report.reason);
+        }
+        break;
+    case ESP_HIDD_REPORT_ERR_EVT:
+        TRACE_LOG0(TRACE_EVT_HIDD_REPORT_ERR);
+        break;
+    case ESP_HIDD_GET_REPORT_EVT:
+    {
+        TRACE_LOG3(TRACE_EVT_HIDD_GET_REPORT, param->get_report.report_id, param->get_report.report_type,
+                   param->get_report.buffer_size);
+        uint8_t report[GAMEPAD_TRANSPORT_MAX_REPORT];
+        uint16_t report_len = 0;
+        if (param->get_report.report_type == ESP_HIDD_REPORT_TYPE_INPUT ||
+            param->get_report.report_type == ESP_HIDD_REPORT_TYPE_FEATURE)
+        {
+            report_len = s_callbacks->get_report(report_type(param->get_report.report_type),
+                                                 param->get_report.report_id, report, sizeof(report));
+        }
+        if (report_len)
+        {
+            esp_bt_hid_device_send_report(param->get_report.report_type, param->get_report.report_id, report_len,
+                                          report);
+        }
+        else
+        {
+            esp_bt_hid_device_report_error(ESP_HID_PAR_HANDSHAKE_RSP_ERR_INVALID_REP_ID);
+            ESP_LOGE(TAG, "check_report_id failed!");
+        }
+        break;
+    }
+    case ESP_HIDD_SET_REPORT_EVT:
+        TRACE_LOG3(TRACE_EVT_HIDD_SET_REPORT, param->set_report.report_id, param->set_report.report_type,
+                   param->set_report.len);
+        switch (s_callbacks->set_report(report_type(param->set_report.report_type), param->set_report.report_id,
+                                        param->set_report.data, param->set_report.len))
+        {
+        case GAMEPAD_SET_REPORT_OK:
+            esp_bt_hid_device_report_error(ESP_HID_PAR_HANDSHAKE_RSP_SUCCESS);
+            break;
+        case GAMEPAD_SET_REPORT_INVALID:
+            esp_bt_hid_device_report_error(ESP_HID_PAR_HANDSHAKE_RSP_ERR_INVALID_PARAM);
+            break;
+        default:
+            esp_bt_hid_device_report_error(ESP_HID_PAR_HANDSHAKE_RSP_ERR_INVALID_REP_ID);
+            break;
+        }
+        break;
+    case ESP_HIDD_SET_PROTOCOL_EVT:
+        TRACE_LOG1(TRACE_EVT_HIDD_SET_PROTOCOL, param->set_protocol.protocol_mode);
+        s_callbacks->set_protocol(param->set_protocol.protocol_mode == ESP_HIDD_BOOT_MODE);
+        break;
+    case ESP_HIDD_INTR_DATA_EVT:
+        TRACE_LOG2(TRACE_EVT_HIDD_INTR_DATA, param->intr_data.report_id, param->intr_data.len);
+        // Rumble and LEDs normally arrive here; parsed straight from the stack's buffer, never waits
+        s_callbacks->set_report(GAMEPAD_REPORT_TYPE_OUTPUT, param->intr_data.report_id, param->intr_data.data,
+                                param->intr_data.len);
+        break;
+    case ESP_HIDD_VC_UNPLUG_EVT:
+        ESP_LOGI(TAG, "ESP_HIDD_VC_UNPLUG_EVT");
+        if (param->vc_unplug.status == ESP_HIDD_SUCCESS)
+        {
+#if CONFIG_GAMEPAD_FAST_RECONNECT
+            last_host_clear(); // The host dropped us, don't page it on the next boot
+#endif
+            if (param->close.conn_status == ESP_HIDD_CONN_STATE_DISCONNECTED)
+            {
+                disconnected();
+            }
+            else
+            {
+                ESP_LOGE(TAG, "unknown connection status");
+            }
+        }
+        else
+        {
+            ESP_LOGE(TAG, "close failed!");
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+esp_err_t gamepad_transport_start(const gamepad_transport_callbacks_t *callbacks)
+{
+    esp_err_t ret;
+    char bda_str[18] = {0};
+
+    s_callbacks = callbacks;
+
+    ESP_ERROR_CHECK(esp_bt_controller_mem_release(ESP_BT_MODE_BLE));
+
+    esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
+    if ((ret = esp_bt_controller_init(&bt_cfg)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "initialize controller failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if ((ret = esp_bt_controller_enable(ESP_BT_MODE_CLASSIC_BT)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "enable controller failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    esp_bluedroid_config_t bluedroid_cfg = BT_BLUEDROID_INIT_CONFIG_DEFAULT();
+#if (CONFIG_EXAMPLE_SSP_ENABLED == false)
+    bluedroid_cfg.ssp_en = false;
+#endif
+    if ((ret = esp_bluedroid_init_with_cfg(&bluedroid_cfg)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "%s initialize bluedroid failed: %s", __func__, esp_err_to_name(ret));
+        return ret;
+    }
+
+    if ((ret = esp_bluedroid_enable()) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "enable bluedroid failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if ((ret = esp_bt_gap_register_callback(esp_bt_gap_cb)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "gap register failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "setting device name");
+    esp_bt_gap_set_device_name("ESP32 Gamepad");
+
+    ESP_LOGI(TAG, "setting cod major, peripheral");
+    esp_bt_cod_t cod;
+    cod.major = ESP_BT_COD_MAJOR_DEV_PERIPHERAL;
+    esp_bt_gap_set_cod(cod, ESP_BT_SET_COD_MAJOR_MINOR);
+
+#if !CONFIG_GAMEPAD_FAST_RECONNECT
+    vTaskDelay(2000 / portTICK_PERIOD_MS);
+#endif
+
+    s_app_param.name = "Gamepad";
+    s_app_param.description = "Gamepad Example";
+    s_app_param.provider = "ESP32";
+    s_app_param.subclass = ESP_HID_CLASS_GPD;
+    s_app_param.desc_list = (uint8_t *)gamepad_report_descriptor;
+    s_app_param.desc_list_len = gamepad_report_descriptor_len;
+
+    memset(&s_both_qos, 0, sizeof(esp_hidd_qos_param_t)); // don't set the qos parameters
+#if CONFIG_GAMEPAD_QOS
+    // Ask for the bandwidth and latency of the active report rate
+    s_both_qos.service_type = 0x01;                       // Best effort
+    s_both_qos.token_bucket_size = GAMEPAD_REPORT_SIZE + 2; // HIDP header and report ID
+    s_both_qos.token_rate = s_both_qos.token_bucket_size * (1000000 / CONFIG_GAMEPAD_ACTIVE_REPORT_INTERVAL_US);
+    s_both_qos.peak_bandwidth = s_both_qos.token_rate;
+    s_both_qos.access_latency = CONFIG_GAMEPAD_ACTIVE_REPORT_INTERVAL_US;
+    s_both_qos.delay_variation = 0xFFFFFFFF; // Don't care
+#endif
+
+    ESP_LOGI(TAG, "register hid device callback");
+    esp_bt_hid_device_register_callback(esp_bt_hidd_cb);
+
+    ESP_LOGI(TAG, "starting hid device");
+    esp_bt_hid_device_init();
+
+#if (CONFIG_EXAMPLE_SSP_ENABLED == true)
+    /* Set default parameters for Secure Simple Pairing */
+    esp_bt_sp_param_t param_type = ESP_BT_SP_IOCAP_MODE;
+    esp_bt_io_cap_t iocap = ESP_BT_IO_CAP_NONE;
+    esp_bt_gap_set_security_param(param_type, &iocap, sizeof(uint8_t));
+#endif
+
+    /*
+     * Set default parameters for Legacy Pairing
+     * Use variable pin, input pin code when pairing
+     */
+    esp_bt_pin_type_t pin_type = ESP_BT_PIN_TYPE_VARIABLE;
+    esp_bt_pin_code_t pin_code;
+    esp_bt_gap_set_pin(pin_type, 0, pin_code);
+
+    ESP_LOGI(TAG, "Own address:[%s]", bda2str((uint8_t *)esp_bt_dev_get_address(), bda_str, sizeof(bda_str)));
+    return ESP_OK;
+}
@@ -0,0 +1,104 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "gamepad_transport_fake.h"
+
+static const gamepad_transport_callbacks_t *s_callbacks;
+static gamepad_transport_fake_report_cb_t s_recorder;
+static void *s_recorder_ctx;
+static bool s_connected;
+static bool s_busy;
+static unsigned s_in_flight;
+
+esp_err_t gamepad_transport_start(const gamepad_transport_callbacks_t *callbacks)
+{
+    s_callbacks = callbacks;
+    s_connected = false;
+    s_busy = false;
+    s_in_flight = 0;
+    return ESP_OK;
+}
+
+int gamepad_transport_send_report(void *ctx, uint8_t report_id, const uint8_t *data, uint16_t len)
+{
+    if (!s_connected || s_busy)
+    {
+        return -1;
+    }
+    s_in_flight++;
+    if (s_recorder)
+    {
+        s_recorder(s_recorder_ctx, report_id, data, len);
+    }
+    return 0;
+}
+
+void gamepad_transport_fake_set_recorder(gamepad_transport_fake_report_cb_t cb, void *ctx)
+{
+    s_recorder = cb;
+    s_recorder_ctx = ctx;
+}
+
+void gamepad_transport_fake_set_busy(bool busy)
+{
+    s_busy = busy;
+}
+
+void gamepad_transport_fake_connect(void)
+{
+    s_connected = true;
+    s_in_flight = 0;
+    if (s_callbacks->connected)
+    {
+        s_callbacks->connected();
+    }
+}
+
+void gamepad_transport_fake_disconnect(void)
+{
+    s_connected = false;
+    if (s_callbacks->disconnected)
+    {
+        s_callbacks->disconnected();
+    }
+}
+
+bool gamepad_transport_fake_complete(bool ok)
+{
+    if (s_in_flight == 0)
+    {
+        return false;
+    }
+    s_in_flight--;
+    if (s_callbacks->sent)
+    {
+        s_callbacks->sent(ok);
+    }
+    return true;
+}
+
+unsigned gamepad_transport_fake_in_flight(void)
+{
+    return s_in_flight;
+}
+
+uint16_t gamepad_transport_fake_get_report(gamepad_report_type_t type, uint8_t report_id, uint8_t *buf,
+                                           uint16_t size)
+{
+    return s_callbacks->get_report ? s_callbacks->get_report(type, report_id, buf, size) : 0;
+}
+
+gamepad_set_report_status_t gamepad_transport_fake_set_report(gamepad_report_type_t type, uint8_t report_id,
+                                                              const uint8_t *data, uint16_t len)
+{
+    return s_callbacks->set_report ? s_callbacks->set_report(type, report_id, data, len)
+                                   : GAMEPAD_SET_REPORT_UNKNOWN_ID;
+}
+
+void gamepad_transport_fake_set_protocol(bool boot)
+{
+    if (s_callbacks->set_protocol)
+    {
+        s_callbacks->set_protocol(boot);
+    }
+}
@@ -0,0 +1,38 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gamepad_transport.h"
+
+// Stand-in host behind gamepad_transport.h on the linux target. Accepted reports are
+// recorded instead of sent, and the caller plays the host: it connects, completes
+// reports and issues GET/SET_REPORT, which reach the registered callbacks as they
+// would from a Bluetooth task. Callbacks the caller doesn't need may be NULL.
+
+// Called for every report the transport accepts
+typedef void (*gamepad_transport_fake_report_cb_t)(void *ctx, uint8_t report_id, const uint8_t *data,
+                                                   uint16_t len);
+
+void gamepad_transport_fake_set_recorder(gamepad_transport_fake_report_cb_t cb, void *ctx);
+
+// Refuse reports while set, like a stack whose queue is full
+void gamepad_transport_fake_set_busy(bool busy);
+
+void gamepad_transport_fake_connect(void);
+void gamepad_transport_fake_disconnect(void);
+
+// Complete the oldest accepted report. False when none is outstanding.
+bool gamepad_transport_fake_complete(bool ok);
+
+// Accepted reports not completed yet
+unsigned gamepad_transport_fake_in_flight(void);
+
+uint16_t gamepad_transport_fake_get_report(gamepad_report_type_t type, uint8_t report_id, uint8_t *buf,
+                                           uint16_t size);
+gamepad_set_report_status_t gamepad_transport_fake_set_report(gamepad_report_type_t type, uint8_t report_id,
+                                                              const uint8_t *data, uint16_t len);
+void gamepad_transport_fake_set_protocol(bool boot);
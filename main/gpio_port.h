@@ -0,0 +1,25 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+// Raw GPIO under the direct-wired buttons (button_capture.c). gpio_port_esp.c drives
+// the GPIO driver and input registers; the host tests link a scripted pin bank in its
+// place, so the path from a pin edge to the report also runs off the chip.
+
+// Called from the GPIO interrupt with the index passed to gpio_port_input
+typedef void (*gpio_port_edge_cb_t)(int index);
+
+// Make pin a pulled-up input. With edge_cb, every edge on the pin calls edge_cb(index)
+// and then wakes the task that made this call.
+void gpio_port_input(int pin, int index, gpio_port_edge_cb_t edge_cb);
+
+// One snapshot of both input registers: GPIO 0-31 in in0, GPIO 32-39 in in1
+void gpio_port_read(uint32_t *in0, uint32_t *in1);
+
+// Let every input wake the chip from light sleep on the level opposite to its current
+// one; disarm goes back to edge interrupts
+void gpio_port_wake_arm(void);
+void gpio_port_wake_disarm(void);
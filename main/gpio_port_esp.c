@@ -0,0 +1,114 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "gpio_port.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#if CONFIG_GAMEPAD_LIGHT_SLEEP
+#include "hal/gpio_ll.h"
+#include "soc/gpio_struct.h"
+#endif
+
+#include "gamepad_inputs.h"
+
+static const char *TAG = "gpio_port";
+
+// In DRAM: the edge interrupt reads them while sleep wake-up is armed
+static DRAM_ATTR uint8_t s_pins[GAMEPAD_NUM_BUTTONS];
+static int s_pin_count;
+static gpio_port_edge_cb_t s_edge_cb;
+static TaskHandle_t s_notify_task = NULL;
+#if CONFIG_GAMEPAD_LIGHT_SLEEP
+static atomic_bool s_wake_armed = false;
+#endif
+
+static void IRAM_ATTR edge_isr_handler(void *arg)
+{
+    int index = (uintptr_t)arg;
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+#if CONFIG_GAMEPAD_LIGHT_SLEEP
+    // A wake-up level would fire again until released, go back to edges for this pin
+    if (atomic_load(&s_wake_armed))
+    {
+        gpio_ll_set_intr_type(&GPIO, s_pins[index], GPIO_INTR_ANYEDGE);
+    }
+#endif
+
+    s_edge_cb(index);
+    vTaskNotifyGiveFromISR(s_notify_task, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+void gpio_port_input(int pin, int index, gpio_port_edge_cb_t edge_cb)
+{
+    if (edge_cb && !s_edge_cb)
+    {
+        esp_err_t ret = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) // Another component may have installed it
+        {
+            ESP_LOGE(TAG, "install gpio isr service failed: %s", esp_err_to_name(ret));
+        }
+    }
+    if (edge_cb)
+    {
+        s_edge_cb = edge_cb;
+        s_notify_task = xTaskGetCurrentTaskHandle();
+    }
+    s_pins[index] = pin;
+    if (index >= s_pin_count)
+    {
+        s_pin_count = index + 1;
+    }
+
+    gpio_config_t io_conf = {
+        .intr_type = edge_cb ? GPIO_INTR_ANYEDGE : GPIO_INTR_DISABLE,
+        .pin_bit_mask = (1ULL << pin),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE, // Internal pull-up resistor
+        .pull_down_en = GPIO_PULLDOWN_DISABLE};
+    gpio_config(&io_conf);
+    if (edge_cb)
+    {
+        gpio_isr_handler_add(pin, edge_isr_handler, (void *)(uintptr_t)index);
+    }
+}
+
+void gpio_port_read(uint32_t *in0, uint32_t *in1)
+{
+    *in0 = REG_READ(GPIO_IN_REG);  // GPIO 0-31
+    *in1 = REG_READ(GPIO_IN1_REG); // GPIO 32-39
+}
+
+void gpio_port_wake_arm(void)
+{
+#if CONFIG_GAMEPAD_LIGHT_SLEEP
+    atomic_store(&s_wake_armed, s_edge_cb != NULL);
+#endif
+    // A pin that changes between the read and the arm matches straight away, so no press is lost
+    for (int i = 0; i < s_pin_count; i++)
+    {
+        gpio_wakeup_enable(s_pins[i], gpio_get_level(s_pins[i]) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    }
+}
+
+void gpio_port_wake_disarm(void)
+{
+    for (int i = 0; i < s_pin_count; i++)
+    {
+        gpio_wakeup_disable(s_pins[i]);
+        gpio_set_intr_type(s_pins[i], s_edge_cb ? GPIO_INTR_ANYEDGE : GPIO_INTR_DISABLE);
+    }
+#if CONFIG_GAMEPAD_LIGHT_SLEEP
+    atomic_store(&s_wake_armed, false);
+#endif
+}
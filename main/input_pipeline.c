@@ -0,0 +1,73 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "input_pipeline.h"
+
+#include <string.h>
+
+#include "gamepad_hal.h"
+
+void input_pipeline_init(input_pipeline_t *pipe, input_pipeline_map_t map_axes)
+{
+    memset(pipe, 0, sizeof(*pipe));
+    pipe->map_axes = map_axes;
+}
+
+void input_pipeline_start(input_pipeline_t *pipe)
+{
+    uint32_t first_edge_us;
+
+    button_debounce_init(&pipe->debounce, CONFIG_GAMEPAD_DEBOUNCE_RELEASE_SAMPLES);
+#if CONFIG_GAMEPAD_STICK_FILTER
+    axis_filter_config_t filter_config = {
+        .min_cutoff_mhz = CONFIG_GAMEPAD_STICK_FILTER_MIN_CUTOFF_MHZ,
+        .beta = CONFIG_GAMEPAD_STICK_FILTER_BETA};
+    axis_filter_init(&pipe->axis_filter, &filter_config);
+#endif
+    // Edges latched before now are stale, start from a full read instead
+    gamepad_hal_take_edges(&first_edge_us);
+    pipe->raw_buttons = gamepad_hal_read_buttons();
+    pipe->buttons = button_debounce_update(&pipe->debounce, pipe->raw_buttons);
+}
+
+void input_pipeline_configure(input_pipeline_t *pipe, const config_block_t *cfg, int64_t now_us)
+{
+    report_scheduler_config_t sched_config = {
+        .axis_deadband = cfg->axis_deadband,
+        .keepalive_ms = cfg->keepalive_ms,
+        .min_interval_us = cfg->report_us};
+    rate_governor_config_t gov_config;
+
+    report_scheduler_init(&pipe->scheduler, &sched_config);
+    rate_governor_config_from_block(cfg, &gov_config);
+    rate_governor_init(&pipe->governor, &gov_config, now_us);
+}
+
+void input_pipeline_sample(input_pipeline_t *pipe, gamepad_buttons_t edges, int64_t now_us, input_sample_t *sample)
+{
+    // Keep reading while a release is being filtered, even without new edges
+    if (edges || button_debounce_busy(&pipe->debounce))
+    {
+        pipe->raw_buttons = gamepad_hal_read_buttons();
+        pipe->buttons = button_debounce_update(&pipe->debounce, pipe->raw_buttons);
+    }
+    sample->raw_buttons = pipe->raw_buttons;
+
+    gamepad_hal_read_axes(sample->raw_axes);
+    memcpy(sample->axes, sample->raw_axes, sizeof(sample->axes));
+#if CONFIG_GAMEPAD_STICK_FILTER
+    axis_filter_apply(&pipe->axis_filter, sample->axes, (uint32_t)now_us);
+#endif
+    memset(&sample->state, 0, sizeof(sample->state));
+    pipe->map_axes(sample->axes, sample->state.axes);
+    sample->state.buttons = pipe->buttons;
+
+    // Speed up on any change, back off once idle so the link can drop into sniff mode
+    sample->rate_changed = rate_governor_update(
+        &pipe->governor, report_scheduler_has_change(&pipe->scheduler, &sample->state), now_us);
+    if (sample->rate_changed)
+    {
+        report_scheduler_set_rate(&pipe->scheduler, rate_governor_report_us(&pipe->governor),
+                                  rate_governor_keepalive_ms(&pipe->governor));
+    }
+}
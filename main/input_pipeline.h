@@ -0,0 +1,73 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+#include "axis_filter.h"
+#include "button_debounce.h"
+#include "config_block.h"
+#include "gamepad_state.h"
+#include "rate_governor.h"
+#include "report_scheduler.h"
+
+// One sample of the input-to-report path, shared by the device task (main.c) and the
+// host simulation (sim_main.c): debounced buttons, filtered and calibrated sticks, the
+// rate governor and the report scheduler. Inputs are read through gamepad_hal.h. What
+// surrounds a sample stays with the caller: waiting for it, the sample clock, recording,
+// calibration capture and sending the report.
+
+// Raw 12-bit readings -> report values, with the stick deadzone applied
+typedef void (*input_pipeline_map_t)(const uint16_t raw[GAMEPAD_NUM_AXES], int16_t axes[GAMEPAD_NUM_AXES]);
+
+typedef struct
+{
+    input_pipeline_map_t map_axes;
+    button_debounce_t debounce;
+    gamepad_buttons_t raw_buttons; // Last read, before debouncing
+    gamepad_buttons_t buttons;     // Debounced
+#if CONFIG_GAMEPAD_STICK_FILTER
+    axis_filter_t axis_filter;
+#endif
+    report_scheduler_t scheduler;
+    rate_governor_t governor;
+} input_pipeline_t;
+
+typedef struct
+{
+    gamepad_buttons_t raw_buttons;       // As read, before debouncing
+    uint16_t raw_axes[GAMEPAD_NUM_AXES]; // As read
+    uint16_t axes[GAMEPAD_NUM_AXES];     // Filtered, before calibration
+    gamepad_state_t state;               // What a report would carry
+    bool rate_changed;                   // The governor switched state; the report limits already follow
+} input_sample_t;
+
+void input_pipeline_init(input_pipeline_t *pipe, input_pipeline_map_t map_axes);
+
+// A new connection: debouncer and stick filter start over, stale edges are dropped and
+// every button is read
+void input_pipeline_start(input_pipeline_t *pipe);
+
+// Rebuild the scheduler and governor from the host-tunable settings, starting active
+void input_pipeline_configure(input_pipeline_t *pipe, const config_block_t *cfg, int64_t now_us);
+
+// Read the inputs and update the governor. edges is the mask from gamepad_hal_take_edges;
+// buttons are only read when it is non-zero or a release is being filtered.
+void input_pipeline_sample(input_pipeline_t *pipe, gamepad_buttons_t edges, int64_t now_us, input_sample_t *sample);
+
+// Whether the sample should be reported now, and why
+static inline report_send_reason_t input_pipeline_report(input_pipeline_t *pipe, const input_sample_t *sample,
+                                                         int64_t now_us)
+{
+    return report_scheduler_update(&pipe->scheduler, &sample->state, now_us);
+}
+
+// True while a button release is being filtered, so the caller keeps sampling
+static inline bool input_pipeline_busy(const input_pipeline_t *pipe)
+{
+    return button_debounce_busy(&pipe->debounce);
+}
@@ -0,0 +1,273 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "input_recorder.h"
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#if CONFIG_GAMEPAD_CONSOLE
+#include "esp_console.h"
+#endif
+
+#include "input_trace_codec.h"
+
+#define INPUT_RECORDER_PARTITION "inputtrace"
+
+static const char *TAG = "input_recorder";
+
+static const esp_partition_t *s_partition;
+static uint32_t s_block_count;
+
+// The input task fills one block while the writer task stores the other
+static uint8_t s_blocks[2][INPUT_TRACE_BLOCK_SIZE];
+static atomic_bool s_pending[2]; // Handed to the writer, the input task must not touch it
+static int s_fill;
+static input_trace_writer_t s_writer;
+static uint32_t s_next_seq; // Sequence number of the block being filled
+
+static TaskHandle_t s_writer_task;
+static atomic_bool s_ready; // Set by the writer once it found where the ring continues
+static atomic_uint s_newest_seq;
+static atomic_bool s_has_blocks;
+static atomic_uint s_written;
+static atomic_uint s_dropped;
+// Longest flash operations so far. The cache is off for their whole length, which stalls
+// the input task as well, so these bound the gap it can leave between two samples.
+static atomic_uint s_erase_max_us;
+static atomic_uint s_write_max_us;
+
+static void note_duration(atomic_uint *max_us, int64_t start_us)
+{
+    unsigned elapsed = (unsigned)(esp_timer_get_time() - start_us);
+
+    if (elapsed > atomic_load(max_us))
+    {
+        atomic_store(max_us, elapsed);
+    }
+}
+
+static void submit(void)
+{
+    input_trace_block_finish(&s_writer);
+    if (atomic_load(&s_pending[s_fill ^ 1]))
+    {
+        // Still writing the previous block; lose this one rather than wait for flash
+        atomic_fetch_add(&s_dropped, 1);
+    }
+    else
+    {
+        atomic_store(&s_pending[s_fill], true);
+        xTaskNotifyGive(s_writer_task);
+        s_fill ^= 1;
+        s_next_seq++;
+    }
+    input_trace_block_begin(&s_writer, s_blocks[s_fill], s_next_seq);
+}
+
+void input_recorder_sample(uint32_t now_us, gamepad_buttons_t buttons, const uint16_t axes[GAMEPAD_NUM_AXES])
+{
+    input_trace_frame_t frame = {.time_us = now_us, .buttons = buttons};
+
+    if (!atomic_load_explicit(&s_ready, memory_order_acquire))
+    {
+        return;
+    }
+    memcpy(frame.axes, axes, sizeof(frame.axes));
+    if (!input_trace_block_append(&s_writer, &frame))
+    {
+        submit();
+        input_trace_block_append(&s_writer, &frame);
+    }
+}
+
+void input_recorder_flush(void)
+{
+    if (atomic_load_explicit(&s_ready, memory_order_acquire) && !input_trace_block_empty(&s_writer))
+    {
+        submit();
+    }
+}
+
+static uint32_t block_offset(uint32_t seq)
+{
+    return (seq % s_block_count) * INPUT_TRACE_BLOCK_SIZE;
+}
+
+// Find the newest block. Recording continues at the next sector: the rest of the
+// newest one may hold a torn write and cannot be programmed without an erase.
+static void resume(void)
+{
+    uint8_t header[INPUT_TRACE_HEADER_SIZE];
+    uint32_t blocks_per_sector = s_partition->erase_size / INPUT_TRACE_BLOCK_SIZE;
+    uint32_t newest = 0;
+    bool found = false;
+
+    for (uint32_t i = 0; i < s_block_count; i++)
+    {
+        uint32_t seq;
+        if (esp_partition_read(s_partition, i * INPUT_TRACE_BLOCK_SIZE, header, sizeof(header)) == ESP_OK &&
+            input_trace_header_check(header, &seq) && seq % s_block_count == i && (!found || seq > newest))
+        {
+            newest = seq;
+            found = true;
+        }
+    }
+
+    s_next_seq = found ? (newest / blocks_per_sector + 1) * blocks_per_sector : 0;
+    atomic_store(&s_newest_seq, newest);
+    atomic_store(&s_has_blocks, found);
+    input_trace_block_begin(&s_writer, s_blocks[s_fill], s_next_seq);
+    ESP_LOGI(TAG, "%" PRIu32 " blocks, continuing at %" PRIu32, s_block_count, s_next_seq);
+}
+
+// Stores finished blocks, erasing each sector as the ring reaches it
+static void writer_task(void *pvParameters)
+{
+    resume();
+    atomic_store_explicit(&s_ready, true, memory_order_release);
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (int i = 0; i < 2; i++)
+        {
+            if (!atomic_load(&s_pending[i]))
+            {
+                continue;
+            }
+
+            uint32_t seq;
+            input_trace_header_check(s_blocks[i], &seq);
+            uint32_t offset = block_offset(seq);
+            esp_err_t err = ESP_OK;
+            if (offset % s_partition->erase_size == 0)
+            {
+                int64_t start_us = esp_timer_get_time();
+                err = esp_partition_erase_range(s_partition, offset, s_partition->erase_size);
+                note_duration(&s_erase_max_us, start_us);
+            }
+            if (err == ESP_OK)
+            {
+                int64_t start_us = esp_timer_get_time();
+                err = esp_partition_write(s_partition, offset, s_blocks[i], INPUT_TRACE_BLOCK_SIZE);
+                note_duration(&s_write_max_us, start_us);
+            }
+            if (err == ESP_OK)
+            {
+                atomic_store(&s_newest_seq, seq);
+                atomic_store(&s_has_blocks, true);
+                atomic_fetch_add(&s_written, 1);
+            }
+            else
+            {
+                ESP_LOGE(TAG, "writing block %" PRIu32 " failed: %s", seq, esp_err_to_name(err));
+            }
+            atomic_store(&s_pending[i], false);
+        }
+    }
+}
+
+#if CONFIG_GAMEPAD_CONSOLE
+typedef struct
+{
+    input_trace_timeline_t timeline;
+    uint32_t frames;
+} dump_state_t;
+
+// One line per frame in the host simulation's trace format
+static void print_frame(void *ctx, const input_trace_frame_t *frame)
+{
+    dump_state_t *dump = ctx;
+    uint32_t time_us = input_trace_timeline_map(&dump->timeline, frame->time_us);
+
+    dump->frames++;
+    printf("%" PRIu32 " 0x%04" PRIx64, time_us, (uint64_t)frame->buttons);
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        printf(" %u", frame->axes[i]);
+    }
+    printf("\n");
+}
+
+static void dump(void)
+{
+    static uint8_t block[INPUT_TRACE_BLOCK_SIZE];
+    dump_state_t state = {0};
+    uint32_t newest = atomic_load(&s_newest_seq);
+    uint32_t oldest = newest + 1 >= s_block_count ? newest + 1 - s_block_count : 0;
+    uint32_t skipped = 0;
+
+    printf("# time_us buttons axes..., blocks %" PRIu32 "..%" PRIu32 "\n", oldest, newest);
+    for (uint32_t seq = oldest; seq - oldest <= newest - oldest; seq++)
+    {
+        uint32_t block_seq;
+        // Blocks erased ahead of the writer or overwritten while dumping fail the check
+        if (esp_partition_read(s_partition, block_offset(seq), block, sizeof(block)) != ESP_OK ||
+            !input_trace_block_check(block, &block_seq) || block_seq != seq ||
+            input_trace_block_decode(block, print_frame, &state) < 0)
+        {
+            skipped++;
+        }
+    }
+    printf("# %" PRIu32 " frames, %" PRIu32 " blocks skipped\n", state.frames, skipped);
+}
+
+static int cmd_itrace(int argc, char **argv)
+{
+    if (!atomic_load(&s_ready))
+    {
+        printf("no %s partition\n", INPUT_RECORDER_PARTITION);
+        return 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "dump") == 0)
+    {
+        if (atomic_load(&s_has_blocks))
+        {
+            dump();
+        }
+        return 0;
+    }
+
+    printf("blocks   %" PRIu32 " of %u bytes\n", s_block_count, INPUT_TRACE_BLOCK_SIZE);
+    if (atomic_load(&s_has_blocks))
+    {
+        printf("newest   %u\n", atomic_load(&s_newest_seq));
+    }
+    printf("written  %u\n", atomic_load(&s_written));
+    printf("dropped  %u\n", atomic_load(&s_dropped));
+    printf("erase    %u us longest\n", atomic_load(&s_erase_max_us));
+    printf("write    %u us longest\n", atomic_load(&s_write_max_us));
+    return 0;
+}
+#endif
+
+void input_recorder_init(void)
+{
+    s_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, INPUT_RECORDER_PARTITION);
+    if (!s_partition || s_partition->erase_size % INPUT_TRACE_BLOCK_SIZE || s_partition->size < s_partition->erase_size)
+    {
+        ESP_LOGW(TAG, "no usable %s partition, not recording", INPUT_RECORDER_PARTITION);
+    }
+    else
+    {
+        s_block_count = s_partition->size / s_partition->erase_size * (s_partition->erase_size / INPUT_TRACE_BLOCK_SIZE);
+        xTaskCreate(writer_task, "input_recorder", 3 * 1024, NULL, tskIDLE_PRIORITY + 1, &s_writer_task);
+    }
+
+#if CONFIG_GAMEPAD_CONSOLE
+    const esp_console_cmd_t cmd = {
+        .command = "itrace",
+        .help = "Show the input recorder, \"itrace dump\" prints the recorded frames for the host simulation",
+        .func = cmd_itrace,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+#endif
+}
@@ -0,0 +1,36 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "gamepad_inputs.h"
+
+#if CONFIG_GAMEPAD_INPUT_RECORDER
+
+// Find the "inputtrace" partition, start the flash writer task and register the
+// "itrace" console command. Recording stays off when the partition is missing.
+void input_recorder_init(void);
+
+// Record the raw inputs of one sample. Called by the input task only; it never
+// waits on flash, a block is dropped instead when the writer falls behind.
+//
+// That doesn't keep flash from stalling sampling: on the ESP32 a flash write or
+// sector erase turns the cache off on both cores, and the input task, which runs
+// from flash, stops until it is done. A 1 KB write takes a few milliseconds and
+// the erase every fourth block tens of milliseconds, so with the recorder on the
+// input task misses samples while a block is stored. "itrace" shows the longest
+// write and erase seen.
+void input_recorder_sample(uint32_t now_us, gamepad_buttons_t buttons, const uint16_t axes[GAMEPAD_NUM_AXES]);
+
+// Hand the partly filled block to the writer, e.g. on disconnect. Only while the input task is parked.
+void input_recorder_flush(void);
+
+#else
+
+static inline void input_recorder_init(void) {}
+static inline void input_recorder_sample(uint32_t now_us, gamepad_buttons_t buttons, const uint16_t axes[GAMEPAD_NUM_AXES]) {}
+static inline void input_recorder_flush(void) {}
+
+#endif
@@ -0,0 +1,264 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "input_trace_codec.h"
+
+#include <string.h>
+
+#define FLAG_BUTTONS 0x01
+#define FLAG_AXIS(i) (0x02 << (i))
+#define FLAG_KEYFRAME 0x80
+#define FLAG_ALL_FIELDS (FLAG_AXIS(GAMEPAD_NUM_AXES) - 1) // Buttons and every axis
+
+#define VARINT_MAX_SIZE(bits) (((bits) + 6) / 7)
+
+// Flags, time, buttons and one 16-bit value per axis, each varint at its longest
+#define MAX_RECORD_SIZE (1 + 5 + VARINT_MAX_SIZE(GAMEPAD_NUM_BUTTONS) + 3 * GAMEPAD_NUM_AXES)
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    put_le16(p, (uint16_t)v);
+    put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return get_le16(p) | ((uint32_t)get_le16(p + 2) << 16);
+}
+
+static uint16_t fletcher16(const uint8_t *data, uint16_t len)
+{
+    uint16_t a = 0, b = 0;
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        a = (a + data[i]) % 255;
+        b = (b + a) % 255;
+    }
+    return (uint16_t)((b << 8) | a);
+}
+
+static uint8_t *put_varint(uint8_t *p, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+// NULL when the varint runs past end or is longer than 64 bits
+static const uint8_t *get_varint(const uint8_t *p, const uint8_t *end, uint64_t *v)
+{
+    uint64_t value = 0;
+
+    for (unsigned shift = 0; shift < 70; shift += 7)
+    {
+        if (p == end)
+        {
+            return NULL;
+        }
+        uint8_t byte = *p++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            *v = value;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+void input_trace_block_begin(input_trace_writer_t *w, uint8_t *block, uint32_t seq)
+{
+    memset(block, 0, INPUT_TRACE_HEADER_SIZE);
+    put_le32(block, INPUT_TRACE_MAGIC);
+    put_le32(block + 4, seq);
+    w->block = block;
+    w->used = INPUT_TRACE_HEADER_SIZE;
+    w->has_prev = false;
+}
+
+bool input_trace_block_append(input_trace_writer_t *w, const input_trace_frame_t *frame)
+{
+    uint8_t *start = w->block + w->used;
+    uint8_t *p = start + 1;
+    uint8_t flags = 0;
+
+    if (w->used + MAX_RECORD_SIZE > INPUT_TRACE_BLOCK_SIZE)
+    {
+        return false;
+    }
+
+    if (!w->has_prev)
+    {
+        flags = FLAG_KEYFRAME | FLAG_ALL_FIELDS;
+        p = put_varint(p, frame->time_us);
+        p = put_varint(p, frame->buttons);
+        for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+        {
+            p = put_varint(p, frame->axes[i]);
+        }
+    }
+    else
+    {
+        const input_trace_frame_t *prev = &w->prev;
+
+        if (frame->buttons != prev->buttons)
+        {
+            flags |= FLAG_BUTTONS;
+        }
+        for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+        {
+            if (frame->axes[i] != prev->axes[i])
+            {
+                flags |= FLAG_AXIS(i);
+            }
+        }
+        if (!flags)
+        {
+            return true; // Nothing changed, the replay holds the previous frame
+        }
+
+        p = put_varint(p, frame->time_us - prev->time_us);
+        if (flags & FLAG_BUTTONS)
+        {
+            p = put_varint(p, frame->buttons ^ prev->buttons);
+        }
+        for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+        {
+            if (flags & FLAG_AXIS(i))
+            {
+                p = put_varint(p, zigzag((int32_t)frame->axes[i] - prev->axes[i]));
+            }
+        }
+    }
+
+    *start = flags;
+    w->used += (uint16_t)(p - start);
+    w->prev = *frame;
+    w->has_prev = true;
+    return true;
+}
+
+void input_trace_block_finish(input_trace_writer_t *w)
+{
+    // Erased flash reads back as 0xFF, keep the unused tail that way
+    memset(w->block + w->used, 0xFF, INPUT_TRACE_BLOCK_SIZE - w->used);
+    put_le16(w->block + 8, w->used);
+    put_le16(w->block + 10, fletcher16(w->block + INPUT_TRACE_HEADER_SIZE, w->used - INPUT_TRACE_HEADER_SIZE));
+}
+
+bool input_trace_header_check(const uint8_t *header, uint32_t *seq)
+{
+    uint16_t used = get_le16(header + 8);
+
+    if (get_le32(header) != INPUT_TRACE_MAGIC || used < INPUT_TRACE_HEADER_SIZE || used > INPUT_TRACE_BLOCK_SIZE)
+    {
+        return false;
+    }
+    *seq = get_le32(header + 4);
+    return true;
+}
+
+bool input_trace_block_check(const uint8_t *block, uint32_t *seq)
+{
+    uint16_t used = get_le16(block + 8);
+
+    return input_trace_header_check(block, seq) &&
+           get_le16(block + 10) == fletcher16(block + INPUT_TRACE_HEADER_SIZE, used - INPUT_TRACE_HEADER_SIZE);
+}
+
+int input_trace_block_decode(const uint8_t *block, input_trace_frame_cb_t cb, void *ctx)
+{
+    const uint8_t *p = block + INPUT_TRACE_HEADER_SIZE;
+    const uint8_t *end = block + get_le16(block + 8);
+    input_trace_frame_t frame = {0};
+    int count = 0;
+
+    while (p < end)
+    {
+        uint8_t flags = *p++;
+        bool keyframe = flags & FLAG_KEYFRAME;
+        uint64_t v;
+
+        // Only the first record is a keyframe, and it carries every field
+        if (keyframe != (count == 0) || (keyframe && flags != (FLAG_KEYFRAME | FLAG_ALL_FIELDS)) ||
+            (flags & ~(FLAG_KEYFRAME | FLAG_ALL_FIELDS)))
+        {
+            return -1;
+        }
+
+        if (!(p = get_varint(p, end, &v)) || v > UINT32_MAX)
+        {
+            return -1;
+        }
+        frame.time_us = keyframe ? (uint32_t)v : frame.time_us + (uint32_t)v;
+
+        if (flags & FLAG_BUTTONS)
+        {
+            if (!(p = get_varint(p, end, &v)) || (v & ~(uint64_t)GAMEPAD_ALL_BUTTONS_MASK))
+            {
+                return -1;
+            }
+            frame.buttons = keyframe ? (gamepad_buttons_t)v : frame.buttons ^ (gamepad_buttons_t)v;
+        }
+        for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+        {
+            if (flags & FLAG_AXIS(i))
+            {
+                if (!(p = get_varint(p, end, &v)) || v > UINT32_MAX)
+                {
+                    return -1;
+                }
+                int64_t axis = keyframe ? (int64_t)v : (int64_t)frame.axes[i] + unzigzag((uint32_t)v);
+                if (axis < 0 || axis > UINT16_MAX)
+                {
+                    return -1;
+                }
+                frame.axes[i] = (uint16_t)axis;
+            }
+        }
+
+        cb(ctx, &frame);
+        count++;
+    }
+    return count;
+}
+
+uint32_t input_trace_timeline_map(input_trace_timeline_t *timeline, uint32_t time_us)
+{
+    uint32_t mapped = time_us + timeline->offset;
+
+    if (timeline->started && (int32_t)(mapped - timeline->last_us) < 0)
+    {
+        timeline->offset += timeline->last_us - mapped;
+        mapped = timeline->last_us;
+    }
+    timeline->started = true;
+    timeline->last_us = mapped;
+    return mapped;
+}
@@ -0,0 +1,86 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gamepad_inputs.h"
+
+// Raw input samples delta-encoded into fixed-size, self-contained blocks. A block
+// starts with a header and a keyframe, so every block decodes on its own and a
+// ring of them can lose its oldest blocks at any time.
+//
+// Header (little-endian): magic u32, sequence u32, used bytes u16, checksum u16
+// (Fletcher-16 of the records). Each record is a flags byte followed by varints:
+//
+//   flags bit 0     buttons changed
+//   flags bit 1+i   axis i changed
+//   flags bit 7     keyframe: every field present and absolute
+//   time            since the previous record (absolute in a keyframe)
+//   buttons         XOR with the previous mask (absolute in a keyframe)
+//   axes            zigzag delta from the previous value (absolute in a keyframe)
+//
+// Samples identical to the previous one are not stored; a replay holds each
+// frame until the next.
+#define INPUT_TRACE_BLOCK_SIZE 1024
+#define INPUT_TRACE_HEADER_SIZE 12
+#define INPUT_TRACE_MAGIC 0x31525449 // "ITR1"
+
+_Static_assert(GAMEPAD_NUM_AXES <= 6, "axis flags must fit below the keyframe bit");
+
+typedef struct
+{
+    uint32_t time_us;
+    gamepad_buttons_t buttons;       // Raw pin state, bit i set when button i is pressed
+    uint16_t axes[GAMEPAD_NUM_AXES]; // Raw 12-bit readings
+} input_trace_frame_t;
+
+typedef struct
+{
+    uint8_t *block;
+    uint16_t used;
+    bool has_prev;
+    input_trace_frame_t prev;
+} input_trace_writer_t;
+
+// Timestamps restart on every boot. Maps the frames of consecutive blocks onto one
+// increasing timeline by shifting each later session; start from a zeroed struct.
+typedef struct
+{
+    bool started;
+    uint32_t offset;
+    uint32_t last_us;
+} input_trace_timeline_t;
+
+typedef void (*input_trace_frame_cb_t)(void *ctx, const input_trace_frame_t *frame);
+
+// Start filling block (INPUT_TRACE_BLOCK_SIZE bytes) as block number seq
+void input_trace_block_begin(input_trace_writer_t *w, uint8_t *block, uint32_t seq);
+
+// Append a sample. False, with nothing written, when the block has no room left
+// for it; finish the block and append the sample to the next one.
+bool input_trace_block_append(input_trace_writer_t *w, const input_trace_frame_t *frame);
+
+// True when nothing but the header has been written
+static inline bool input_trace_block_empty(const input_trace_writer_t *w)
+{
+    return w->used == INPUT_TRACE_HEADER_SIZE;
+}
+
+// Seal the header; the whole block is then ready to store
+void input_trace_block_finish(input_trace_writer_t *w);
+
+// Cheap check of just the header (INPUT_TRACE_HEADER_SIZE bytes) for scanning flash;
+// seq is the block's sequence number. The records still need input_trace_block_check.
+bool input_trace_header_check(const uint8_t *header, uint32_t *seq);
+
+// True when the whole block is intact; seq is its sequence number
+bool input_trace_block_check(const uint8_t *block, uint32_t *seq);
+
+uint32_t input_trace_timeline_map(input_trace_timeline_t *timeline, uint32_t time_us);
+
+// Call cb for every frame in a checked block. Returns the number of frames, or -1
+// when a record is malformed (frames before it have been delivered).
+int input_trace_block_decode(const uint8_t *block, input_trace_frame_cb_t cb, void *ctx);
@@ -0,0 +1,109 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "joystick_adc.h"
+
+#include "esp_adc/adc_continuous.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "axis_decimator.h"
+
+#define JOYSTICK_ADC_FRAME_SIZE (GAMEPAD_NUM_AXES * CONFIG_GAMEPAD_ADC_OVERSAMPLE * SOC_ADC_DIGI_RESULT_BYTES)
+
+static const char *TAG = "joystick_adc";
+
+static adc_continuous_handle_t s_adc_handle = NULL;
+static axis_decimator_t s_decimator;
+
+static void joystick_adc_task(void *pvParameters)
+{
+    static uint8_t frame[JOYSTICK_ADC_FRAME_SIZE];
+
+    for (;;)
+    {
+        uint32_t len = 0;
+        esp_err_t ret = adc_continuous_read(s_adc_handle, frame, sizeof(frame), &len, portMAX_DELAY);
+        if (ret == ESP_OK)
+        {
+            axis_decimator_push_frame(&s_decimator, frame, len);
+        }
+        else if (ret != ESP_ERR_TIMEOUT)
+        {
+            ESP_LOGE(TAG, "read failed: %s", esp_err_to_name(ret));
+        }
+    }
+}
+
+esp_err_t joystick_adc_start(const uint8_t channels[GAMEPAD_NUM_AXES])
+{
+    esp_err_t ret;
+
+    if (s_adc_handle)
+    {
+        return ESP_OK;
+    }
+
+    axis_decimator_init(&s_decimator, channels, CONFIG_GAMEPAD_ADC_OVERSAMPLE);
+
+    adc_continuous_handle_cfg_t handle_cfg = {
+        .max_store_buf_size = 4 * JOYSTICK_ADC_FRAME_SIZE,
+        .conv_frame_size = JOYSTICK_ADC_FRAME_SIZE,
+    };
+    if ((ret = adc_continuous_new_handle(&handle_cfg, &s_adc_handle)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "new handle failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    adc_digi_pattern_config_t pattern[GAMEPAD_NUM_AXES] = {0};
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        pattern[i].atten = ADC_ATTEN_DB_12; // Full 0-3.3 V stick travel
+        pattern[i].channel = channels[i];
+        pattern[i].unit = ADC_UNIT_1;
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+
+    adc_continuous_config_t dig_cfg = {
+        .pattern_num = GAMEPAD_NUM_AXES,
+        .adc_pattern = pattern,
+        .sample_freq_hz = CONFIG_GAMEPAD_ADC_SAMPLE_RATE_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
+    };
+    if ((ret = adc_continuous_config(s_adc_handle, &dig_cfg)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "config failed: %s", esp_err_to_name(ret));
+        goto err;
+    }
+
+    if ((ret = adc_continuous_start(s_adc_handle)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "start failed: %s", esp_err_to_name(ret));
+        goto err;
+    }
+
+    if (xTaskCreate(joystick_adc_task, "joystick_adc", 2 * 1024, NULL, configMAX_PRIORITIES - 4, NULL) != pdPASS)
+    {
+        ESP_LOGE(TAG, "task create failed");
+        adc_continuous_stop(s_adc_handle);
+        ret = ESP_ERR_NO_MEM;
+        goto err;
+    }
+
+    ESP_LOGI(TAG, "sampling at %d Hz, averaging %d samples per axis", CONFIG_GAMEPAD_ADC_SAMPLE_RATE_HZ,
+             CONFIG_GAMEPAD_ADC_OVERSAMPLE);
+    return ESP_OK;
+
+err:
+    adc_continuous_deinit(s_adc_handle);
+    s_adc_handle = NULL;
+    return ret;
+}
+
+void joystick_adc_read(uint16_t raw[GAMEPAD_NUM_AXES])
+{
+    axis_decimator_latest(&s_decimator, raw);
+}
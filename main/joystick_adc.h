@@ -0,0 +1,16 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "gamepad_state.h"
+
+// Start background DMA sampling of the joystick channels. channels[i] is the
+// ADC1 channel of axis i. Calling it again while running does nothing.
+esp_err_t joystick_adc_start(const uint8_t channels[GAMEPAD_NUM_AXES]);
+
+// Latest averaged 12-bit reading of every axis, never blocks
+void joystick_adc_read(uint16_t raw[GAMEPAD_NUM_AXES]);
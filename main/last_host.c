@@ -0,0 +1,110 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "last_host.h"
+
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_gap_bt_api.h"
+#include "esp_log.h"
+#include "nvs.h"
+
+#define LAST_HOST_NVS_NAMESPACE "gamepad"
+#define LAST_HOST_NVS_KEY "last_host"
+#define LAST_HOST_MAX_BONDS 8
+
+static const char *TAG = "last_host";
+
+static bool load_host(esp_bd_addr_t bda)
+{
+    nvs_handle_t handle;
+    size_t len = ESP_BD_ADDR_LEN;
+    bool ok;
+
+    if (nvs_open(LAST_HOST_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+    {
+        return false;
+    }
+    ok = nvs_get_blob(handle, LAST_HOST_NVS_KEY, bda, &len) == ESP_OK && len == ESP_BD_ADDR_LEN;
+    nvs_close(handle);
+    return ok;
+}
+
+static bool is_bonded(const esp_bd_addr_t bda)
+{
+    esp_bd_addr_t bonds[LAST_HOST_MAX_BONDS];
+    int count = LAST_HOST_MAX_BONDS;
+
+    if (esp_bt_gap_get_bond_device_list(&count, bonds) != ESP_OK)
+    {
+        return false;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (memcmp(bonds[i], bda, ESP_BD_ADDR_LEN) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool last_host_get(esp_bd_addr_t bda)
+{
+    return load_host(bda) && is_bonded(bda);
+}
+
+void last_host_set(const esp_bd_addr_t bda)
+{
+    esp_bd_addr_t stored;
+    nvs_handle_t handle;
+    esp_err_t ret;
+
+    if (load_host(stored) && memcmp(stored, bda, ESP_BD_ADDR_LEN) == 0)
+    {
+        return;
+    }
+    if ((ret = nvs_open(LAST_HOST_NVS_NAMESPACE, NVS_READWRITE, &handle)) == ESP_OK)
+    {
+        ret = nvs_set_blob(handle, LAST_HOST_NVS_KEY, bda, ESP_BD_ADDR_LEN);
+        if (ret == ESP_OK)
+        {
+            ret = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "saving last host failed: %s", esp_err_to_name(ret));
+    }
+}
+
+void last_host_clear(void)
+{
+    nvs_handle_t handle;
+
+    if (nvs_open(LAST_HOST_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK)
+    {
+        if (nvs_erase_key(handle, LAST_HOST_NVS_KEY) == ESP_OK)
+        {
+            nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+}
+
+bool last_host_boot_target(bool in_use, const esp_bd_addr_t plugged, esp_bd_addr_t host)
+{
+    if (in_use)
+    {
+        memcpy(host, plugged, ESP_BD_ADDR_LEN);
+        return true;
+    }
+#if CONFIG_GAMEPAD_FAST_RECONNECT
+    return last_host_get(host);
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,24 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+
+#include "esp_bt_defs.h"
+
+// The host we were last connected to, kept in NVS so it can be paged straight after boot
+
+// Copy out the stored host. False when there is none or it is no longer bonded.
+bool last_host_get(esp_bd_addr_t bda);
+
+// Remember bda; flash is only written when it changed
+void last_host_set(const esp_bd_addr_t bda);
+
+// Forget the stored host, e.g. after a virtual cable unplug
+void last_host_clear(void);
+
+// The host to page once the HID app is registered: the virtual-cable host the stack
+// reported (plugged, when in_use), otherwise with fast reconnect the stored one.
+// False when there is nothing to page.
+bool last_host_boot_target(bool in_use, const esp_bd_addr_t plugged, esp_bd_addr_t host);
@@ -0,0 +1,85 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "latency_hist.h"
+
+#include <string.h>
+
+uint32_t latency_hist_bucket(uint32_t value)
+{
+    if (value < LATENCY_HIST_SUB_BUCKETS)
+    {
+        return value;
+    }
+
+    uint32_t msb = 31 - __builtin_clz(value);
+    uint32_t shift = msb - LATENCY_HIST_SUB_BITS;
+    uint32_t sub = (value >> shift) & (LATENCY_HIST_SUB_BUCKETS - 1);
+    uint32_t bucket = (shift + 1) * LATENCY_HIST_SUB_BUCKETS + sub;
+
+    return bucket < LATENCY_HIST_NUM_BUCKETS ? bucket : LATENCY_HIST_NUM_BUCKETS - 1;
+}
+
+uint32_t latency_hist_bucket_upper(uint32_t bucket)
+{
+    if (bucket < LATENCY_HIST_SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    uint32_t shift = bucket / LATENCY_HIST_SUB_BUCKETS - 1;
+    uint32_t sub = bucket % LATENCY_HIST_SUB_BUCKETS;
+    uint32_t lower = (LATENCY_HIST_SUB_BUCKETS + sub) << shift;
+    return lower + (1U << shift) - 1;
+}
+
+void latency_hist_reset(latency_hist_t *hist)
+{
+    memset(hist, 0, sizeof(*hist));
+}
+
+void latency_hist_record(latency_hist_t *hist, uint32_t value)
+{
+    hist->buckets[latency_hist_bucket(value)]++;
+    hist->count++;
+    if (value > hist->max)
+    {
+        hist->max = value;
+    }
+}
+
+uint32_t latency_hist_percentile(const latency_hist_t *hist, uint32_t per_mille)
+{
+    uint32_t count = hist->count;
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // Rank of the sample we want, 1-based and rounded up
+    uint64_t rank = ((uint64_t)count * per_mille + 999) / 1000;
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < LATENCY_HIST_NUM_BUCKETS; i++)
+    {
+        seen += hist->buckets[i];
+        if (seen >= rank)
+        {
+            uint32_t upper = latency_hist_bucket_upper(i);
+            return upper < hist->max ? upper : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+void latency_hist_summary(const latency_hist_t *hist, latency_summary_t *summary)
+{
+    summary->count = hist->count;
+    summary->p50 = latency_hist_percentile(hist, 500);
+    summary->p99 = latency_hist_percentile(hist, 990);
+    summary->max = hist->max;
+}
@@ -0,0 +1,43 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+// Log-linear buckets: 4 linear sub-buckets per power of two, up to 2^24 us (~16 s).
+// A bucket's width is at most 25% of its lower bound.
+#define LATENCY_HIST_SUB_BITS 2
+#define LATENCY_HIST_SUB_BUCKETS (1 << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_MAX_BITS 24
+#define LATENCY_HIST_NUM_BUCKETS ((LATENCY_HIST_MAX_BITS - LATENCY_HIST_SUB_BITS + 1) * LATENCY_HIST_SUB_BUCKETS)
+
+// Fixed-size latency histogram, no allocation. One task records, anyone may read
+// (a concurrent read may miss the latest few samples).
+typedef struct
+{
+    uint32_t buckets[LATENCY_HIST_NUM_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+} latency_hist_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t p50;
+    uint32_t p99;
+    uint32_t max;
+} latency_summary_t;
+
+void latency_hist_reset(latency_hist_t *hist);
+
+void latency_hist_record(latency_hist_t *hist, uint32_t value);
+
+// Upper bound of the bucket holding the given percentile (per mille), 0 when empty
+uint32_t latency_hist_percentile(const latency_hist_t *hist, uint32_t per_mille);
+
+void latency_hist_summary(const latency_hist_t *hist, latency_summary_t *summary);
+
+// Bucket mapping, exposed for testing
+uint32_t latency_hist_bucket(uint32_t value);
+uint32_t latency_hist_bucket_upper(uint32_t bucket);
@@ -0,0 +1,177 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "latency_stats.h"
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#if CONFIG_GAMEPAD_CONSOLE
+#include "esp_console.h"
+#endif
+
+#include "latency_hist.h"
+
+// Power of two. A completion can come in after the pipeline reused its credit, so one
+// more report than CONFIG_GAMEPAD_REPORTS_IN_FLIGHT can be on record; after a clear the
+// forgotten ones stay until the next completion drops them, next to as many new ones.
+#define LATENCY_IN_FLIGHT_SLOTS 64
+
+_Static_assert(LATENCY_IN_FLIGHT_SLOTS >= 2 * (CONFIG_GAMEPAD_REPORTS_IN_FLIGHT + 1), "too few in-flight slots");
+_Static_assert((LATENCY_IN_FLIGHT_SLOTS & (LATENCY_IN_FLIGHT_SLOTS - 1)) == 0, "in-flight slots not a power of two");
+
+typedef struct
+{
+    uint32_t sample_us;
+    uint32_t sent_us;
+} in_flight_report_t;
+
+static const char *TAG = "latency";
+
+static const char *s_stage_names[LATENCY_STAGE_COUNT] = {"sample", "pack", "submit", "complete", "total",
+                                                           "output"};
+static latency_hist_t s_hist[LATENCY_STAGE_COUNT];
+
+// Reports inside the stack, pushed by the gamepad task and popped in order by the completion
+// callback. Only the gamepad task writes head and clear, only the completion callback writes tail.
+static in_flight_report_t s_in_flight[LATENCY_IN_FLIGHT_SLOTS];
+static atomic_uint s_in_flight_head;
+static atomic_uint s_in_flight_tail;
+static atomic_uint s_in_flight_clear; // Reports before this one were forgotten
+
+void latency_stats_record(latency_stage_t stage, uint32_t start_us, uint32_t end_us)
+{
+    latency_hist_record(&s_hist[stage], end_us - start_us);
+}
+
+void latency_stats_sent(uint32_t sample_us, uint32_t sent_us)
+{
+    unsigned head = atomic_load_explicit(&s_in_flight_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&s_in_flight_tail, memory_order_acquire);
+
+    if (head - tail >= LATENCY_IN_FLIGHT_SLOTS)
+    {
+        return; // Completions stopped coming; skip rather than block
+    }
+    s_in_flight[head % LATENCY_IN_FLIGHT_SLOTS].sample_us = sample_us;
+    s_in_flight[head % LATENCY_IN_FLIGHT_SLOTS].sent_us = sent_us;
+    atomic_store_explicit(&s_in_flight_head, head + 1, memory_order_release);
+}
+
+void latency_stats_completed(uint32_t now_us)
+{
+    unsigned tail = atomic_load_explicit(&s_in_flight_tail, memory_order_relaxed);
+    unsigned clear = atomic_load_explicit(&s_in_flight_clear, memory_order_acquire);
+    unsigned head = atomic_load_explicit(&s_in_flight_head, memory_order_acquire);
+
+    // Drop the forgotten reports, unless this callback already popped past them
+    if (clear - tail <= head - tail)
+    {
+        tail = clear;
+    }
+    if (tail == head)
+    {
+        atomic_store_explicit(&s_in_flight_tail, tail, memory_order_release);
+        return;
+    }
+    in_flight_report_t report = s_in_flight[tail % LATENCY_IN_FLIGHT_SLOTS];
+    atomic_store_explicit(&s_in_flight_tail, tail + 1, memory_order_release);
+
+    latency_stats_record(LATENCY_STAGE_COMPLETE, report.sent_us, now_us);
+    latency_stats_record(LATENCY_STAGE_TOTAL, report.sample_us, now_us);
+}
+
+// The completion callback drops them itself: moving tail from here could race with a
+// pop and put a forgotten report back
+void latency_stats_clear_in_flight(void)
+{
+    atomic_store_explicit(&s_in_flight_clear, atomic_load_explicit(&s_in_flight_head, memory_order_relaxed),
+                          memory_order_release);
+}
+
+void latency_stats_get(latency_stage_t stage, latency_summary_t *summary)
+{
+    latency_hist_summary(&s_hist[stage], summary);
+}
+
+void latency_stats_log(void)
+{
+    char line[160];
+    int len = 0;
+
+    for (int i = 0; i < LATENCY_STAGE_COUNT && len < sizeof(line); i++)
+    {
+        latency_summary_t summary;
+        latency_stats_get(i, &summary);
+        len += snprintf(line + len, sizeof(line) - len, "%s %" PRIu32 "/%" PRIu32 "/%" PRIu32 " ", s_stage_names[i],
+                        summary.p50, summary.p99, summary.max);
+    }
+    ESP_LOGI(TAG, "%sus (p50/p99/max), n=%" PRIu32, line, s_hist[LATENCY_STAGE_TOTAL].count);
+}
+
+#if CONFIG_GAMEPAD_LATENCY_LOG_INTERVAL_S > 0
+static void latency_log_timer_cb(void *arg)
+{
+    if (s_hist[LATENCY_STAGE_SAMPLE].count)
+    {
+        latency_stats_log();
+    }
+}
+#endif
+
+#if CONFIG_GAMEPAD_CONSOLE
+static int cmd_latency(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "reset") == 0)
+    {
+        for (int i = 0; i < LATENCY_STAGE_COUNT; i++)
+        {
+            latency_hist_reset(&s_hist[i]);
+        }
+        return 0;
+    }
+
+    printf("%-9s %8s %8s %8s %8s\n", "stage", "count", "p50 us", "p99 us", "max us");
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++)
+    {
+        latency_summary_t summary;
+        latency_stats_get(i, &summary);
+        printf("%-9s %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 "\n", s_stage_names[i], summary.count,
+               summary.p50, summary.p99, summary.max);
+    }
+    return 0;
+}
+#endif
+
+void latency_stats_init(void)
+{
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++)
+    {
+        latency_hist_reset(&s_hist[i]);
+    }
+
+#if CONFIG_GAMEPAD_LATENCY_LOG_INTERVAL_S > 0
+    esp_timer_handle_t timer;
+    const esp_timer_create_args_t timer_args = {
+        .callback = latency_log_timer_cb,
+        .name = "latency_log",
+    };
+    if (esp_timer_create(&timer_args, &timer) == ESP_OK)
+    {
+        esp_timer_start_periodic(timer, (uint64_t)CONFIG_GAMEPAD_LATENCY_LOG_INTERVAL_S * 1000000);
+    }
+#endif
+
+#if CONFIG_GAMEPAD_CONSOLE
+    const esp_console_cmd_t cmd = {
+        .command = "latency",
+        .help = "Show per-stage report latency (p50/p99/max), or 'latency reset' to clear it",
+        .hint = "[reset]",
+        .func = cmd_latency,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+#endif
+}
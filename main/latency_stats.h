@@ -0,0 +1,67 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+#include "latency_hist.h"
+
+typedef enum
+{
+    LATENCY_STAGE_SAMPLE = 0, // Button edge (or wake-up) until all inputs are read
+    LATENCY_STAGE_PACK,       // Building the report
+    LATENCY_STAGE_SUBMIT,     // Send pipeline and the call into the stack
+    LATENCY_STAGE_COMPLETE,   // Handed to the stack until its send completion event
+    LATENCY_STAGE_TOTAL,      // Sample start until send completion
+    LATENCY_STAGE_OUTPUT,     // Output report from the host until the actuators were set
+    LATENCY_STAGE_COUNT,
+} latency_stage_t;
+
+#if CONFIG_GAMEPAD_LATENCY_STATS
+
+#include "esp_timer.h"
+
+// Timestamps are the low 32 bits of esp_timer_get_time(), differences stay valid across the wrap
+static inline uint32_t latency_now(void)
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+// Start the periodic summary log and register the "latency" console command
+void latency_stats_init(void);
+
+void latency_stats_record(latency_stage_t stage, uint32_t start_us, uint32_t end_us);
+
+// A report sampled at sample_us was handed to the stack at sent_us
+void latency_stats_sent(uint32_t sample_us, uint32_t sent_us);
+
+// The oldest report handed to the stack has completed
+void latency_stats_completed(uint32_t now_us);
+
+// Forget reports still in the stack, e.g. on a new connection. Called by the task that
+// reports sends; the next completion drops them.
+void latency_stats_clear_in_flight(void);
+
+// p50/p99/max of one stage since boot or the last "latency reset"
+void latency_stats_get(latency_stage_t stage, latency_summary_t *summary);
+
+void latency_stats_log(void);
+
+#else
+
+static inline uint32_t latency_now(void) { return 0; }
+static inline void latency_stats_init(void) {}
+static inline void latency_stats_record(latency_stage_t stage, uint32_t start_us, uint32_t end_us) {}
+static inline void latency_stats_sent(uint32_t sample_us, uint32_t sent_us) {}
+static inline void latency_stats_completed(uint32_t now_us) {}
+static inline void latency_stats_clear_in_flight(void) {}
+static inline void latency_stats_get(latency_stage_t stage, latency_summary_t *summary)
+{
+    *summary = (latency_summary_t){0};
+}
+static inline void latency_stats_log(void) {}
+
+#endif
@@ -0,0 +1,62 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "mem_stats.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#if CONFIG_GAMEPAD_CONSOLE
+#include "esp_console.h"
+#endif
+
+static const char *TAG = "mem";
+
+static TaskHandle_t s_task;
+static size_t s_last_free; // Free heap at the previous mem_stats_log, 0 before the first
+
+void mem_stats_watch_task(TaskHandle_t task)
+{
+    s_task = task;
+}
+
+void mem_stats_log(const char *when)
+{
+    size_t free_heap = esp_get_free_heap_size();
+    unsigned stack_free = s_task ? (unsigned)uxTaskGetStackHighWaterMark(s_task) : 0;
+
+    ESP_LOGI(TAG, "%s: heap free %u min %u largest %u, heap change %+d, input task stack free %u", when,
+             (unsigned)free_heap, (unsigned)esp_get_minimum_free_heap_size(),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT),
+             s_last_free ? (int)free_heap - (int)s_last_free : 0, stack_free);
+    s_last_free = free_heap;
+}
+
+#if CONFIG_GAMEPAD_CONSOLE
+static int cmd_mem(int argc, char **argv)
+{
+    printf("heap free     %8u\n", (unsigned)esp_get_free_heap_size());
+    printf("heap min free %8u\n", (unsigned)esp_get_minimum_free_heap_size());
+    printf("largest block %8u\n", (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT));
+    if (s_task)
+    {
+        printf("stack free    %8u (input task high-water)\n", (unsigned)uxTaskGetStackHighWaterMark(s_task));
+    }
+    return 0;
+}
+#endif
+
+void mem_stats_init(void)
+{
+#if CONFIG_GAMEPAD_CONSOLE
+    const esp_console_cmd_t cmd = {
+        .command = "mem",
+        .help = "Show free heap, minimum-ever free heap and the input task's stack high-water mark",
+        .func = cmd_mem,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+#endif
+}
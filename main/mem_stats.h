@@ -0,0 +1,17 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Register the "mem" console command
+void mem_stats_init(void);
+
+// Include task's stack high-water mark in the memory reports
+void mem_stats_watch_task(TaskHandle_t task);
+
+// Log free and minimum-ever free heap, the watched task's stack high-water mark and
+// how much the free heap changed since the previous call
+void mem_stats_log(const char *when);
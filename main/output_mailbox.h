@@ -0,0 +1,67 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "gamepad_state.h"
+
+// Single-slot, latest-wins mailbox for host output commands. The writer never waits:
+// a new command replaces one the reader hasn't taken yet, so a flood of commands costs
+// the writer the same as one. Built like report_seqlock.h, with the published sequence
+// number telling the reader whether anything new arrived.
+//
+// seq is odd while a write is in progress. The published slot is (seq >> 1) & 1.
+typedef struct
+{
+    atomic_uint seq;
+    gamepad_output_t slot[2];
+} output_mailbox_t;
+
+static inline void output_mailbox_init(output_mailbox_t *mb)
+{
+    memset(mb, 0, sizeof(*mb));
+    atomic_init(&mb->seq, 0);
+}
+
+// Publish a command. Only one task may write.
+static inline void output_mailbox_put(output_mailbox_t *mb, const gamepad_output_t *cmd)
+{
+    unsigned seq = atomic_load_explicit(&mb->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&mb->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release); // Claim before touching the idle slot
+    mb->slot[((seq >> 1) + 1) & 1] = *cmd;
+    atomic_store_explicit(&mb->seq, seq + 2, memory_order_release);
+}
+
+// Copy the newest command into out if one was published since *seen (start from 0).
+// Returns how many commands were published since: 0 when there is nothing new, more than
+// 1 when some were replaced before being taken. Only one task may take.
+static inline unsigned output_mailbox_take(output_mailbox_t *mb, gamepad_output_t *out, unsigned *seen)
+{
+    for (;;)
+    {
+        unsigned start = atomic_load_explicit(&mb->seq, memory_order_acquire);
+        unsigned version = start & ~1U;
+
+        if (version == *seen)
+        {
+            return 0;
+        }
+        gamepad_output_t cmd = mb->slot[(start >> 1) & 1];
+        atomic_thread_fence(memory_order_acquire);
+
+        // The copied slot is only rewritten once the writer starts the write after next
+        unsigned end = atomic_load_explicit(&mb->seq, memory_order_relaxed);
+        if (end - version < 3)
+        {
+            unsigned published = (version - *seen) / 2;
+            *out = cmd;
+            *seen = version;
+            return published;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "period_stats.h"
+
+#include <string.h>
+
+void period_stats_reset(period_stats_t *stats, uint32_t period_us, uint32_t ticks)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->period_us = period_us;
+    stats->last_ticks = ticks;
+    latency_hist_reset(&stats->jitter);
+}
+
+void period_stats_rebase(period_stats_t *stats, uint32_t period_us, uint32_t ticks)
+{
+    stats->period_us = period_us;
+    stats->started = false;
+    stats->last_ticks = ticks;
+}
+
+bool period_stats_record(period_stats_t *stats, uint32_t now_us, uint32_t ticks)
+{
+    uint32_t elapsed_ticks = ticks - stats->last_ticks;
+    if (elapsed_ticks == 0)
+    {
+        return false;
+    }
+    if (!stats->started)
+    {
+        stats->started = true;
+        stats->start_us = stats->last_us = now_us;
+        stats->start_ticks = stats->last_ticks = ticks;
+        return true;
+    }
+    stats->missed += elapsed_ticks - 1;
+
+    // Compare against the ticks that actually elapsed, so one late wake isn't counted twice
+    int32_t jitter = (int32_t)(now_us - stats->last_us - elapsed_ticks * stats->period_us);
+    int32_t drift = (int32_t)(now_us - stats->start_us - (ticks - stats->start_ticks) * stats->period_us);
+    bool first = stats->jitter.count == 0;
+
+    latency_hist_record(&stats->jitter, jitter < 0 ? (uint32_t)-jitter : (uint32_t)jitter);
+    if (first || jitter < stats->jitter_min)
+    {
+        stats->jitter_min = jitter;
+    }
+    if (first || jitter > stats->jitter_max)
+    {
+        stats->jitter_max = jitter;
+    }
+    stats->drift = drift;
+    if (first || drift < stats->drift_min)
+    {
+        stats->drift_min = drift;
+    }
+    if (first || drift > stats->drift_max)
+    {
+        stats->drift_max = drift;
+    }
+
+    stats->last_us = now_us;
+    stats->last_ticks = ticks;
+    return true;
+}
+
+void period_stats_summary(const period_stats_t *stats, period_summary_t *summary)
+{
+    summary->period_us = stats->period_us;
+    summary->count = stats->jitter.count;
+    summary->missed = stats->missed;
+    summary->jitter_p50 = latency_hist_percentile(&stats->jitter, 500);
+    summary->jitter_p99 = latency_hist_percentile(&stats->jitter, 990);
+    summary->jitter_min = stats->jitter_min;
+    summary->jitter_max = stats->jitter_max;
+    summary->drift = stats->drift;
+    summary->drift_min = stats->drift_min;
+    summary->drift_max = stats->drift_max;
+}
@@ -0,0 +1,56 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "latency_hist.h"
+
+// Timing of a periodic wake-up against its ideal grid. Each wake passes the
+// number of clock ticks seen so far, so wakes caused by something other than
+// the clock can be told apart and missed ticks counted.
+typedef struct
+{
+    uint32_t period_us;
+    bool started;
+    uint32_t start_us;    // First wake, the origin of the ideal grid
+    uint32_t start_ticks;
+    uint32_t last_us;
+    uint32_t last_ticks;
+    uint32_t missed;      // Ticks that never got a wake of their own
+    int32_t jitter_min;   // Wake interval minus the expected interval
+    int32_t jitter_max;
+    int32_t drift;        // Latest wake against the ideal grid
+    int32_t drift_min;
+    int32_t drift_max;
+    latency_hist_t jitter; // |wake interval - expected interval|
+} period_stats_t;
+
+typedef struct
+{
+    uint32_t period_us;
+    uint32_t count;
+    uint32_t missed;
+    uint32_t jitter_p50;
+    uint32_t jitter_p99;
+    int32_t jitter_min;
+    int32_t jitter_max;
+    int32_t drift;
+    int32_t drift_min;
+    int32_t drift_max;
+} period_summary_t;
+
+// Start over; ticks is the current tick count, the next tick after it becomes the grid origin
+void period_stats_reset(period_stats_t *stats, uint32_t period_us, uint32_t ticks);
+
+// Start a new grid at period_us, e.g. after the clock was restarted at another period, but
+// keep the counts, jitter and drift ranges so far. The next wake becomes the new origin.
+void period_stats_rebase(period_stats_t *stats, uint32_t period_us, uint32_t ticks);
+
+// A wake at now_us after ticks clock ticks in total. Returns false (and records
+// nothing) when no tick happened since the previous wake.
+bool period_stats_record(period_stats_t *stats, uint32_t now_us, uint32_t ticks);
+
+void period_stats_summary(const period_stats_t *stats, period_summary_t *summary);
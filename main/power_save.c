@@ -0,0 +1,180 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "power_save.h"
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#if CONFIG_GAMEPAD_CONSOLE
+#include "esp_console.h"
+#endif
+
+#include "gamepad_hal.h"
+#include "latency_hist.h"
+#include "sleep_policy.h"
+
+static const char *TAG = "power";
+
+static esp_pm_lock_handle_t s_awake_lock; // Held unless the input task is dozing
+
+// Updated by the light sleep exit callback
+static atomic_uint s_light_sleeps;
+static atomic_uint s_last_exit_us;
+static uint64_t s_slept_us;
+
+// Owned by the input task; the console reads them as a status display
+static sleep_policy_t s_policy;
+static int64_t s_start_us;
+static uint32_t s_start_sleeps;
+static uint64_t s_start_slept_us;
+static uint32_t s_doze_sleeps; // s_light_sleeps when the current doze began
+static uint32_t s_wake_us;
+static bool s_wake_pending;
+static latency_hist_t s_wake_hist; // Doze end to the first report handed to the send pipeline
+
+static esp_err_t IRAM_ATTR power_save_on_sleep_exit(int64_t sleep_time_us, void *arg)
+{
+    s_slept_us += sleep_time_us;
+    atomic_store(&s_last_exit_us, (uint32_t)esp_timer_get_time());
+    atomic_fetch_add(&s_light_sleeps, 1);
+    return ESP_OK;
+}
+
+static void power_save_wake(void)
+{
+    ESP_ERROR_CHECK(esp_pm_lock_acquire(s_awake_lock));
+    gamepad_hal_sleep_disarm();
+}
+
+bool power_save_update(bool idle, bool busy, int64_t now_us)
+{
+    if (!sleep_policy_update(&s_policy, idle, busy, now_us))
+    {
+        return false;
+    }
+
+    if (sleep_policy_state(&s_policy) == SLEEP_POLICY_DOZE)
+    {
+        s_doze_sleeps = atomic_load(&s_light_sleeps);
+        gamepad_hal_sleep_arm();
+        ESP_ERROR_CHECK(esp_pm_lock_release(s_awake_lock));
+        return true;
+    }
+
+    power_save_wake();
+    // Count from the light sleep exit that ended the doze, or from now when the chip never slept
+    s_wake_us = atomic_load(&s_light_sleeps) != s_doze_sleeps ? atomic_load(&s_last_exit_us) : (uint32_t)now_us;
+    s_wake_pending = true;
+    return true;
+}
+
+bool power_save_dozing(void)
+{
+    return sleep_policy_state(&s_policy) == SLEEP_POLICY_DOZE;
+}
+
+void power_save_reported(int64_t now_us)
+{
+    if (s_wake_pending)
+    {
+        latency_hist_record(&s_wake_hist, (uint32_t)now_us - s_wake_us);
+        s_wake_pending = false;
+    }
+}
+
+void power_save_start(int64_t now_us)
+{
+    const sleep_policy_config_t config = {.settle_ms = CONFIG_GAMEPAD_LIGHT_SLEEP_SETTLE_MS};
+    sleep_policy_init(&s_policy, &config, now_us);
+    latency_hist_reset(&s_wake_hist);
+    s_wake_pending = false;
+    s_start_us = now_us;
+    s_start_sleeps = atomic_load(&s_light_sleeps);
+    s_start_slept_us = s_slept_us;
+}
+
+void power_save_stop(int64_t now_us)
+{
+    if (power_save_dozing())
+    {
+        sleep_policy_update(&s_policy, false, false, now_us);
+        power_save_wake();
+    }
+}
+
+void power_save_log(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    uint64_t connected_us = now_us - s_start_us;
+    uint64_t slept_us = s_slept_us - s_start_slept_us;
+    latency_summary_t wake;
+    latency_hist_summary(&s_wake_hist, &wake);
+
+    ESP_LOGI(TAG,
+             "dozes %" PRIu32 " dozing %" PRIu64 "ms, light sleeps %" PRIu32 " asleep %" PRIu64 "ms (%" PRIu64
+             "%%), wake-to-report p50/p99/max %" PRIu32 "/%" PRIu32 "/%" PRIu32 "us",
+             s_policy.dozes, sleep_policy_doze_us(&s_policy, now_us) / 1000,
+             atomic_load(&s_light_sleeps) - s_start_sleeps, slept_us / 1000,
+             connected_us ? slept_us * 100 / connected_us : 0, wake.p50, wake.p99, wake.max);
+}
+
+#if CONFIG_GAMEPAD_CONSOLE
+static int cmd_power(int argc, char **argv)
+{
+    int64_t now_us = esp_timer_get_time();
+    uint64_t connected_us = now_us - s_start_us;
+    uint64_t slept_us = s_slept_us - s_start_slept_us;
+    latency_summary_t wake;
+    latency_hist_summary(&s_wake_hist, &wake);
+
+    printf("state         %8s\n", power_save_dozing() ? "doze" : "awake");
+    printf("dozes         %8" PRIu32 "\n", s_policy.dozes);
+    printf("dozing        %8" PRIu64 " ms\n", sleep_policy_doze_us(&s_policy, now_us) / 1000);
+    printf("light sleeps  %8" PRIu32 "\n", atomic_load(&s_light_sleeps) - s_start_sleeps);
+    printf("asleep        %8" PRIu64 " ms (%" PRIu64 "%% of the connection)\n", slept_us / 1000,
+           connected_us ? slept_us * 100 / connected_us : 0);
+    printf("wake p50      %8" PRIu32 " us\n", wake.p50);
+    printf("wake p99      %8" PRIu32 " us\n", wake.p99);
+    printf("wake max      %8" PRIu32 " us (n=%" PRIu32 ")\n", wake.max, wake.count);
+    return 0;
+}
+#endif
+
+void power_save_init(void)
+{
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "input", &s_awake_lock));
+    ESP_ERROR_CHECK(esp_pm_lock_acquire(s_awake_lock));
+
+    // The CPU drops to the crystal frequency when nothing holds a lock and light-sleeps
+    // whenever every task is blocked for long enough
+    const esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_XTAL_FREQ,
+        .light_sleep_enable = true};
+    ESP_ERROR_CHECK(esp_pm_configure(&pm_config));
+    ESP_ERROR_CHECK(esp_sleep_enable_gpio_wakeup());
+
+    esp_pm_sleep_cbs_register_config_t cbs = {
+        .exit_cb = power_save_on_sleep_exit,
+    };
+    ESP_ERROR_CHECK(esp_pm_light_sleep_register_cbs(&cbs));
+
+    latency_hist_reset(&s_wake_hist);
+    ESP_LOGI(TAG, "light sleep between idle samples enabled");
+
+#if CONFIG_GAMEPAD_CONSOLE
+    const esp_console_cmd_t cmd = {
+        .command = "power",
+        .help = "Show time dozing and asleep, light sleep count and wake-to-report latency",
+        .func = cmd_power,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+#endif
+}
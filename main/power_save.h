@@ -0,0 +1,46 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+#if CONFIG_GAMEPAD_LIGHT_SLEEP
+
+// Enable automatic light sleep with button GPIO wake-up and register the "power"
+// console command. The chip is kept awake until the input task starts dozing.
+void power_save_init(void);
+
+// A connection starts awake
+void power_save_start(int64_t now_us);
+
+// Feed one sample to the sleep policy. Returns true when the input task started or
+// stopped dozing: while dozing the chip may light-sleep between samples, so the caller
+// must stop its sample clock and pace itself from the tick instead.
+bool power_save_update(bool idle, bool busy, int64_t now_us);
+
+bool power_save_dozing(void);
+
+// A report was handed to the send pipeline; measures wake-to-report after a doze
+void power_save_reported(int64_t now_us);
+
+// Stop dozing when the input task parks
+void power_save_stop(int64_t now_us);
+
+// Log time asleep, wake count and wake-to-report latency of the current connection
+void power_save_log(void);
+
+#else
+
+static inline void power_save_init(void) {}
+static inline void power_save_start(int64_t now_us) {}
+static inline bool power_save_update(bool idle, bool busy, int64_t now_us) { return false; }
+static inline bool power_save_dozing(void) { return false; }
+static inline void power_save_reported(int64_t now_us) {}
+static inline void power_save_stop(int64_t now_us) {}
+static inline void power_save_log(void) {}
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "rate_governor.h"
+
+#include "sdkconfig.h"
+
+static uint32_t at_least(uint32_t value, uint32_t min)
+{
+    return value > min ? value : min;
+}
+
+void rate_governor_config_from_block(const config_block_t *cfg, rate_governor_config_t *config)
+{
+    config->active_sample_us = cfg->sample_us;
+    config->active_report_us = cfg->report_us;
+    config->active_keepalive_ms = cfg->keepalive_ms;
+    config->idle_timeout_ms = cfg->idle_timeout_ms;
+    if (cfg->fixed_rate)
+    {
+        config->idle_sample_us = cfg->sample_us;
+        config->idle_report_us = cfg->report_us;
+        config->idle_keepalive_ms = cfg->keepalive_ms;
+        return;
+    }
+    // The host may set an active period slower than the idle default; idle must not speed it up
+    config->idle_sample_us = at_least(CONFIG_GAMEPAD_IDLE_SAMPLE_PERIOD_US, cfg->sample_us);
+    config->idle_report_us = at_least(CONFIG_GAMEPAD_IDLE_SAMPLE_PERIOD_US, cfg->report_us);
+    config->idle_keepalive_ms = CONFIG_GAMEPAD_IDLE_KEEPALIVE_MS;
+}
+
+void rate_governor_init(rate_governor_t *gov, const rate_governor_config_t *config, int64_t now_us)
+{
+    gov->config = *config;
+    gov->state = RATE_GOVERNOR_ACTIVE;
+    gov->last_activity_us = now_us;
+    gov->transitions = 0;
+}
+
+bool rate_governor_update(rate_governor_t *gov, bool activity, int64_t now_us)
+{
+    rate_governor_state_t next = gov->state;
+
+    if (activity)
+    {
+        gov->last_activity_us = now_us;
+        next = RATE_GOVERNOR_ACTIVE;
+    }
+    else if (now_us - gov->last_activity_us >= (int64_t)gov->config.idle_timeout_ms * 1000)
+    {
+        next = RATE_GOVERNOR_IDLE;
+    }
+
+    if (next == gov->state)
+    {
+        return false;
+    }
+    gov->state = next;
+    gov->transitions++;
+    return true;
+}
+
+uint32_t rate_governor_sample_us(const rate_governor_t *gov)
+{
+    return gov->state == RATE_GOVERNOR_ACTIVE ? gov->config.active_sample_us : gov->config.idle_sample_us;
+}
+
+uint32_t rate_governor_report_us(const rate_governor_t *gov)
+{
+    return gov->state == RATE_GOVERNOR_ACTIVE ? gov->config.active_report_us : gov->config.idle_report_us;
+}
+
+uint32_t rate_governor_keepalive_ms(const rate_governor_t *gov)
+{
+    return gov->state == RATE_GOVERNOR_ACTIVE ? gov->config.active_keepalive_ms : gov->config.idle_keepalive_ms;
+}
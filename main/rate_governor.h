@@ -0,0 +1,55 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config_block.h"
+
+typedef enum
+{
+    RATE_GOVERNOR_ACTIVE = 0, // Inputs changing: fast sampling and reports
+    RATE_GOVERNOR_IDLE,       // Nothing changed for the idle timeout: slow sampling, link may sleep
+} rate_governor_state_t;
+
+typedef struct
+{
+    uint32_t active_sample_us;   // Sample period while active
+    uint32_t active_report_us;   // Minimum report interval while active
+    uint32_t active_keepalive_ms;
+    uint32_t idle_sample_us;     // Sample period while idle
+    uint32_t idle_report_us;     // Minimum report interval while idle
+    uint32_t idle_keepalive_ms;  // Long enough to let the link drop into sniff mode
+    uint32_t idle_timeout_ms;    // Time without activity before going idle
+} rate_governor_config_t;
+
+// Activity-driven rate state machine. Any activity makes it active straight away;
+// it goes idle only after idle_timeout_ms without activity.
+typedef struct
+{
+    rate_governor_config_t config;
+    rate_governor_state_t state;
+    int64_t last_activity_us;
+    uint32_t transitions;
+} rate_governor_t;
+
+// Governor settings for the host-tunable settings in cfg. Idle uses the menuconfig idle
+// rates, but never samples or reports faster than active does; with cfg->fixed_rate the
+// idle state runs at the active rate.
+void rate_governor_config_from_block(const config_block_t *cfg, rate_governor_config_t *config);
+
+void rate_governor_init(rate_governor_t *gov, const rate_governor_config_t *config, int64_t now_us);
+
+// Feed one sample; activity is true when any input changed. Returns true when the state changed.
+bool rate_governor_update(rate_governor_t *gov, bool activity, int64_t now_us);
+
+static inline rate_governor_state_t rate_governor_state(const rate_governor_t *gov)
+{
+    return gov->state;
+}
+
+uint32_t rate_governor_sample_us(const rate_governor_t *gov);
+uint32_t rate_governor_report_us(const rate_governor_t *gov);
+uint32_t rate_governor_keepalive_ms(const rate_governor_t *gov);
@@ -0,0 +1,76 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "report_requests.h"
+
+#include "actuator.h"
+#include "gamepad_report.h"
+#include "runtime_config.h"
+
+_Static_assert(REPORT_SEQLOCK_CAPACITY <= GAMEPAD_TRANSPORT_MAX_REPORT &&
+                   CONFIG_BLOCK_SIZE <= GAMEPAD_TRANSPORT_MAX_REPORT,
+               "GET_REPORT buffer too small");
+
+void report_requests_init(report_requests_t *req, report_scheduler_t *scheduler)
+{
+    uint8_t empty_report[GAMEPAD_REPORT_SIZE] = {0};
+
+    // Report Protocol Mode is the default mode, according to Bluetooth HID specification
+    atomic_store(&req->boot_protocol, false);
+    report_seqlock_init(&req->report);
+    report_seqlock_write(&req->report, empty_report, sizeof(empty_report));
+    req->scheduler = scheduler;
+}
+
+void report_requests_publish(report_requests_t *req, const uint8_t *report, uint16_t len)
+{
+    report_seqlock_write(&req->report, report, len);
+}
+
+bool report_requests_boot_protocol(report_requests_t *req)
+{
+    return atomic_load(&req->boot_protocol);
+}
+
+void report_requests_set_protocol(report_requests_t *req, bool boot)
+{
+    atomic_store(&req->boot_protocol, boot);
+}
+
+uint16_t report_requests_get(report_requests_t *req, gamepad_report_type_t type, uint8_t report_id, uint8_t *buf,
+                             uint16_t size)
+{
+    if (type == GAMEPAD_REPORT_TYPE_FEATURE && report_id == GAMEPAD_CONFIG_REPORT_ID)
+    {
+        return runtime_config_read(buf); // Settings are available in either protocol mode
+    }
+    if (type == GAMEPAD_REPORT_TYPE_INPUT && report_id == GAMEPAD_REPORT_ID && !report_requests_boot_protocol(req))
+    {
+        uint16_t len = report_seqlock_read(&req->report, buf);
+        report_scheduler_force(req->scheduler); // Follow up with a fresh interrupt report
+        return len;
+    }
+    return 0;
+}
+
+gamepad_set_report_status_t report_requests_set(report_requests_t *req, gamepad_report_type_t type,
+                                                uint8_t report_id, const uint8_t *data, uint16_t len)
+{
+    if (type == GAMEPAD_REPORT_TYPE_FEATURE && report_id == GAMEPAD_CONFIG_REPORT_ID)
+    {
+        if (len == CONFIG_BLOCK_SIZE + 1 && data[0] == GAMEPAD_CONFIG_REPORT_ID)
+        {
+            data++; // Report ID left in front of the payload
+            len--;
+        }
+        // The input task applies the new settings before its next sample
+        return runtime_config_write(data, len) == CONFIG_BLOCK_OK ? GAMEPAD_SET_REPORT_OK : GAMEPAD_SET_REPORT_INVALID;
+    }
+#if CONFIG_GAMEPAD_OUTPUT_REPORT
+    if (type == GAMEPAD_REPORT_TYPE_OUTPUT && report_id == GAMEPAD_OUTPUT_REPORT_ID)
+    {
+        return actuator_submit(data, len) ? GAMEPAD_SET_REPORT_OK : GAMEPAD_SET_REPORT_INVALID;
+    }
+#endif
+    return GAMEPAD_SET_REPORT_UNKNOWN_ID;
+}
@@ -0,0 +1,41 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gamepad_transport.h"
+#include "report_scheduler.h"
+#include "report_seqlock.h"
+
+// The host's GET_REPORT, SET_REPORT and SET_PROTOCOL requests. The input task publishes
+// every packed input report here; the transport callbacks answer from it in the Bluetooth
+// task and never wait for the input task.
+
+typedef struct
+{
+    atomic_bool boot_protocol;
+    report_seqlock_t report;       // Latest input report, written by the input task, read by GET_REPORT
+    report_scheduler_t *scheduler; // Told to follow an input GET_REPORT with an interrupt report
+} report_requests_t;
+
+// Starts in report protocol mode with an all-zero input report
+void report_requests_init(report_requests_t *req, report_scheduler_t *scheduler);
+
+// Input task: the report about to be sent
+void report_requests_publish(report_requests_t *req, const uint8_t *report, uint16_t len);
+
+bool report_requests_boot_protocol(report_requests_t *req);
+void report_requests_set_protocol(report_requests_t *req, bool boot);
+
+// Answer a GET_REPORT into buf (GAMEPAD_TRANSPORT_MAX_REPORT bytes), returns its length, 0 when
+// there is no such report
+uint16_t report_requests_get(report_requests_t *req, gamepad_report_type_t type, uint8_t report_id, uint8_t *buf,
+                             uint16_t size);
+
+// Apply a SET_REPORT: the settings block or an output report
+gamepad_set_report_status_t report_requests_set(report_requests_t *req, gamepad_report_type_t type,
+                                                uint8_t report_id, const uint8_t *data, uint16_t len);
@@ -0,0 +1,89 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "report_scheduler.h"
+
+#include <stdlib.h>
+
+void report_scheduler_init(report_scheduler_t *sched, const report_scheduler_config_t *config)
+{
+    sched->config = *config;
+    atomic_init(&sched->force, false);
+    report_scheduler_reset(sched);
+}
+
+void report_scheduler_reset(report_scheduler_t *sched)
+{
+    sched->has_sent = false;
+    sched->last_send_us = 0;
+    atomic_store(&sched->force, false);
+}
+
+void report_scheduler_force(report_scheduler_t *sched)
+{
+    atomic_store(&sched->force, true);
+}
+
+void report_scheduler_set_rate(report_scheduler_t *sched, uint32_t min_interval_us, uint32_t keepalive_ms)
+{
+    sched->config.min_interval_us = min_interval_us;
+    sched->config.keepalive_ms = keepalive_ms;
+}
+
+static bool axes_moved(const report_scheduler_t *sched, const gamepad_state_t *state)
+{
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        int delta = abs((int)state->axes[i] - (int)sched->last_sent.axes[i]);
+        if (delta > sched->config.axis_deadband)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool report_scheduler_has_change(const report_scheduler_t *sched, const gamepad_state_t *state)
+{
+    return !sched->has_sent || state->buttons != sched->last_sent.buttons || axes_moved(sched, state);
+}
+
+report_send_reason_t report_scheduler_update(report_scheduler_t *sched, const gamepad_state_t *state, int64_t now_us)
+{
+    report_send_reason_t reason = REPORT_SEND_NONE;
+
+    if (!sched->has_sent)
+    {
+        reason = REPORT_SEND_FIRST;
+    }
+    else if (state->buttons != sched->last_sent.buttons)
+    {
+        reason = REPORT_SEND_BUTTONS;
+    }
+    else if (now_us - sched->last_send_us < sched->config.min_interval_us)
+    {
+        reason = REPORT_SEND_NONE; // Rate limited, the change is still pending next time
+    }
+    else if (axes_moved(sched, state))
+    {
+        reason = REPORT_SEND_AXES;
+    }
+    else if (atomic_load(&sched->force))
+    {
+        reason = REPORT_SEND_FORCED;
+    }
+    else if (sched->config.keepalive_ms != 0 &&
+             now_us - sched->last_send_us >= (int64_t)sched->config.keepalive_ms * 1000)
+    {
+        reason = REPORT_SEND_KEEPALIVE;
+    }
+
+    if (reason != REPORT_SEND_NONE)
+    {
+        atomic_store(&sched->force, false);
+        sched->last_sent = *state;
+        sched->last_send_us = now_us;
+        sched->has_sent = true;
+    }
+    return reason;
+}
@@ -0,0 +1,54 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gamepad_state.h"
+
+typedef enum
+{
+    REPORT_SEND_NONE = 0,  // Nothing worth sending
+    REPORT_SEND_FIRST,     // First report since reset
+    REPORT_SEND_BUTTONS,   // At least one button edge
+    REPORT_SEND_AXES,      // An axis moved past the deadband
+    REPORT_SEND_FORCED,    // Requested by the host (GET_REPORT)
+    REPORT_SEND_KEEPALIVE, // Idle for longer than the keepalive interval
+} report_send_reason_t;
+
+typedef struct
+{
+    uint16_t axis_deadband;      // Minimum axis change (report units) that triggers a send
+    uint32_t keepalive_ms;       // Resend the last state after this much idle time, 0 to disable
+    uint32_t min_interval_us;    // Minimum time between axis-only or keepalive reports; button edges ignore it
+} report_scheduler_config_t;
+
+typedef struct
+{
+    report_scheduler_config_t config;
+    gamepad_state_t last_sent;
+    int64_t last_send_us;
+    bool has_sent;
+    atomic_bool force;
+} report_scheduler_t;
+
+void report_scheduler_init(report_scheduler_t *sched, const report_scheduler_config_t *config);
+
+// Forget the last sent state so the next update always sends
+void report_scheduler_reset(report_scheduler_t *sched);
+
+// Make the next update send regardless of changes. Safe to call from another task.
+void report_scheduler_force(report_scheduler_t *sched);
+
+// Change the report rate limits, e.g. when the pad goes idle
+void report_scheduler_set_rate(report_scheduler_t *sched, uint32_t min_interval_us, uint32_t keepalive_ms);
+
+// True when state differs from the last sent report by a button or by more than the deadband
+bool report_scheduler_has_change(const report_scheduler_t *sched, const gamepad_state_t *state);
+
+// Decide whether state must be sent at now_us. When the result is not
+// REPORT_SEND_NONE the state is recorded as sent and the caller must send it.
+report_send_reason_t report_scheduler_update(report_scheduler_t *sched, const gamepad_state_t *state, int64_t now_us);
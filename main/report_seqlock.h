@@ -0,0 +1,69 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef REPORT_SEQLOCK_CAPACITY
+#define REPORT_SEQLOCK_CAPACITY 32
+#endif
+
+// Single-writer, multi-reader report buffer. The writer fills the buffer that is
+// not published and never waits; readers copy the published buffer and retry only
+// if the writer came back around to it while they were copying.
+//
+// seq is odd while a write is in progress. The published buffer is (seq >> 1) & 1.
+typedef struct
+{
+    atomic_uint seq;
+    uint16_t len[2];
+    uint8_t buf[2][REPORT_SEQLOCK_CAPACITY];
+} report_seqlock_t;
+
+static inline void report_seqlock_init(report_seqlock_t *rs)
+{
+    memset(rs, 0, sizeof(*rs));
+    atomic_init(&rs->seq, 0);
+}
+
+// Publish a report. Only one task may write.
+static inline void report_seqlock_write(report_seqlock_t *rs, const uint8_t *data, uint16_t len)
+{
+    unsigned seq = atomic_load_explicit(&rs->seq, memory_order_relaxed);
+    unsigned idx = ((seq >> 1) + 1) & 1;
+
+    if (len > REPORT_SEQLOCK_CAPACITY)
+    {
+        len = REPORT_SEQLOCK_CAPACITY;
+    }
+
+    atomic_store_explicit(&rs->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release); // Claim before touching the idle buffer
+    memcpy(rs->buf[idx], data, len);
+    rs->len[idx] = len;
+    atomic_store_explicit(&rs->seq, seq + 2, memory_order_release);
+}
+
+// Copy the latest published report into out (REPORT_SEQLOCK_CAPACITY bytes), returns its length
+static inline uint16_t report_seqlock_read(report_seqlock_t *rs, uint8_t *out)
+{
+    for (;;)
+    {
+        unsigned start = atomic_load_explicit(&rs->seq, memory_order_acquire);
+        unsigned idx = (start >> 1) & 1;
+        uint16_t len = rs->len[idx];
+
+        memcpy(out, rs->buf[idx], len);
+        atomic_thread_fence(memory_order_acquire);
+
+        // The copied buffer is only rewritten once the writer starts the write after next
+        unsigned end = atomic_load_explicit(&rs->seq, memory_order_relaxed);
+        if (end - (start & ~1U) < 3)
+        {
+            return len;
+        }
+    }
+}
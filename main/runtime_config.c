@@ -0,0 +1,148 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "runtime_config.h"
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "nvs.h"
+
+#include "report_seqlock.h"
+
+#define RUNTIME_CONFIG_NVS_NAMESPACE "gamepad"
+#define RUNTIME_CONFIG_NVS_KEY "config"
+
+_Static_assert(sizeof(config_block_t) <= REPORT_SEQLOCK_CAPACITY, "settings don't fit the seqlock");
+
+static const char *TAG = "runtime_config";
+
+// Written by the Bluetooth task, read by the input task and GET_REPORT without locking
+static report_seqlock_t s_config;
+static atomic_uint s_generation;
+static atomic_bool s_save_requested; // Set by the Bluetooth task, the input task writes the flash
+
+static void publish(const config_block_t *cfg)
+{
+    report_seqlock_write(&s_config, (const uint8_t *)cfg, sizeof(*cfg));
+    atomic_fetch_add_explicit(&s_generation, 1, memory_order_release);
+}
+
+static void save(const config_block_t *cfg)
+{
+    uint8_t block[CONFIG_BLOCK_SIZE];
+    nvs_handle_t handle;
+    esp_err_t ret;
+
+    config_block_encode(cfg, block);
+
+    if ((ret = nvs_open(RUNTIME_CONFIG_NVS_NAMESPACE, NVS_READWRITE, &handle)) == ESP_OK)
+    {
+        ret = nvs_set_blob(handle, RUNTIME_CONFIG_NVS_KEY, block, CONFIG_BLOCK_SIZE);
+        if (ret == ESP_OK)
+        {
+            ret = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "saving settings failed: %s", esp_err_to_name(ret));
+    }
+}
+
+// Stored blocks keep their version byte, so settings saved by an incompatible firmware are ignored
+static bool load(config_block_t *cfg)
+{
+    uint8_t block[CONFIG_BLOCK_SIZE];
+    size_t len = sizeof(block);
+    nvs_handle_t handle;
+    bool save_flag;
+    esp_err_t ret;
+
+    if (nvs_open(RUNTIME_CONFIG_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+    {
+        return false;
+    }
+    ret = nvs_get_blob(handle, RUNTIME_CONFIG_NVS_KEY, block, &len);
+    nvs_close(handle);
+    return ret == ESP_OK && config_block_parse(block, len, cfg, &save_flag) == CONFIG_BLOCK_OK;
+}
+
+void runtime_config_init(void)
+{
+    config_block_t cfg;
+
+    config_block_defaults(&cfg);
+
+    report_seqlock_init(&s_config);
+    atomic_store(&s_save_requested, false);
+    if (load(&cfg))
+    {
+        ESP_LOGI(TAG, "using saved settings");
+    }
+    publish(&cfg);
+}
+
+void runtime_config_get(config_block_t *cfg)
+{
+    uint8_t buf[REPORT_SEQLOCK_CAPACITY];
+
+    report_seqlock_read(&s_config, buf);
+    memcpy(cfg, buf, sizeof(*cfg));
+}
+
+uint32_t runtime_config_generation(void)
+{
+    return atomic_load_explicit(&s_generation, memory_order_acquire);
+}
+
+uint16_t runtime_config_read(uint8_t *buf)
+{
+    config_block_t cfg;
+
+    runtime_config_get(&cfg);
+    return config_block_encode(&cfg, buf);
+}
+
+config_block_status_t runtime_config_write(const uint8_t *data, uint16_t len)
+{
+    config_block_t cfg;
+    bool save_flag;
+
+    runtime_config_get(&cfg);
+    config_block_status_t status = config_block_parse(data, len, &cfg, &save_flag);
+    if (status != CONFIG_BLOCK_OK)
+    {
+        ESP_LOGW(TAG, "rejected settings block, status %d", status);
+        return status;
+    }
+
+    // Flagged before the new generation is published, so the input task sees both together
+    if (save_flag)
+    {
+        atomic_store(&s_save_requested, true);
+    }
+    publish(&cfg);
+    ESP_LOGI(TAG, "sample %" PRIu32 " us, report %" PRIu32 " us, deadband %u, keepalive %u ms, idle %" PRIu32
+                  " ms%s%s",
+             cfg.sample_us, cfg.report_us, cfg.axis_deadband, cfg.keepalive_ms, cfg.idle_timeout_ms,
+             cfg.fixed_rate ? ", fixed rate" : "", save_flag ? ", saving" : "");
+    return CONFIG_BLOCK_OK;
+}
+
+bool runtime_config_save_if_requested(void)
+{
+    config_block_t cfg;
+
+    if (!atomic_exchange(&s_save_requested, false))
+    {
+        return false;
+    }
+    // The settings in use now, which may be newer than the block that asked for the save
+    runtime_config_get(&cfg);
+    save(&cfg);
+    return true;
+}
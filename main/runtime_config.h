@@ -0,0 +1,32 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config_block.h"
+
+// Settings the host can read and change through the config feature report
+
+// Load the settings saved in NVS, or the menuconfig defaults when there are none
+void runtime_config_init(void);
+
+// Copy out the current settings. Safe from any task.
+void runtime_config_get(config_block_t *cfg);
+
+// Bumped every time new settings are applied, so the input task can tell when to pick them up
+uint32_t runtime_config_generation(void);
+
+// Current settings as a feature report payload (CONFIG_BLOCK_SIZE bytes), returns its length
+uint16_t runtime_config_read(uint8_t *buf);
+
+// Apply a block written by the host. Only one task may write. When the host asks for the
+// settings to be stored, the flash write is left to runtime_config_save_if_requested so the
+// Bluetooth task never waits on it.
+config_block_status_t runtime_config_write(const uint8_t *data, uint16_t len);
+
+// Input task, between samples: store the current settings in NVS if a write asked for it
+// since the last call. Returns whether it did.
+bool runtime_config_save_if_requested(void);
@@ -0,0 +1,209 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "sample_clock.h"
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#if CONFIG_GAMEPAD_CONSOLE
+#include "esp_console.h"
+#endif
+
+#include "period_stats.h"
+
+#define SAMPLE_CLOCK_RESOLUTION_HZ 1000000 // 1 tick = 1 us
+
+static const char *TAG = "sample_clock";
+
+static gptimer_handle_t s_timer;
+static bool s_running;
+static TaskHandle_t s_task;
+static atomic_uint s_ticks;
+static atomic_bool s_reset_requested;
+static atomic_bool s_rebase_requested;
+static uint32_t s_period_us;
+static period_stats_t s_stats; // Only touched by the sampling task
+
+static bool IRAM_ATTR sample_clock_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata,
+                                            void *user_ctx)
+{
+    BaseType_t woken = pdFALSE;
+    atomic_fetch_add_explicit(&s_ticks, 1, memory_order_release);
+    vTaskNotifyGiveFromISR(s_task, &woken);
+    return woken == pdTRUE;
+}
+
+static esp_err_t sample_clock_create(void)
+{
+    const gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = SAMPLE_CLOCK_RESOLUTION_HZ,
+    };
+    esp_err_t err = gptimer_new_timer(&timer_config, &s_timer);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    const gptimer_event_callbacks_t callbacks = {
+        .on_alarm = sample_clock_on_alarm,
+    };
+    err = gptimer_register_event_callbacks(s_timer, &callbacks, NULL);
+    if (err != ESP_OK)
+    {
+        gptimer_del_timer(s_timer);
+        s_timer = NULL;
+    }
+    return err;
+}
+
+static esp_err_t sample_clock_run(uint32_t period_us)
+{
+    esp_err_t err;
+
+    // Restart from zero so the first period after a change is a full one
+    const gptimer_alarm_config_t alarm_config = {
+        .alarm_count = period_us,
+        .reload_count = 0,
+        .flags.auto_reload_on_alarm = true,
+    };
+    gptimer_set_raw_count(s_timer, 0);
+    err = gptimer_set_alarm_action(s_timer, &alarm_config);
+    if (err == ESP_OK)
+    {
+        err = gptimer_enable(s_timer);
+    }
+    if (err == ESP_OK && (err = gptimer_start(s_timer)) != ESP_OK)
+    {
+        gptimer_disable(s_timer);
+    }
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "timer start at %" PRIu32 " us failed: %s", period_us, esp_err_to_name(err));
+        return err;
+    }
+    s_running = true;
+    return ESP_OK;
+}
+
+esp_err_t sample_clock_start(TaskHandle_t task, uint32_t period_us)
+{
+    esp_err_t err;
+    bool was_running = s_running;
+
+    if (!s_timer && (err = sample_clock_create()) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "timer create failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    sample_clock_stop();
+
+    s_task = task;
+    if ((err = sample_clock_run(period_us)) != ESP_OK)
+    {
+        if (was_running && sample_clock_run(s_period_us) == ESP_OK)
+        {
+            atomic_store(&s_rebase_requested, true); // Same period as before, from a new origin
+        }
+        return err;
+    }
+    s_period_us = period_us;
+    atomic_store(&s_rebase_requested, true);
+    return ESP_OK;
+}
+
+void sample_clock_stop(void)
+{
+    if (s_running)
+    {
+        // Disabling also drops the timer's power management lock, so the chip may sleep
+        gptimer_stop(s_timer);
+        gptimer_disable(s_timer);
+        s_running = false;
+    }
+}
+
+bool sample_clock_running(void)
+{
+    return s_running;
+}
+
+void sample_clock_reset_stats(void)
+{
+    atomic_store(&s_reset_requested, true);
+}
+
+bool sample_clock_wake(uint32_t now_us)
+{
+    uint32_t ticks = atomic_load_explicit(&s_ticks, memory_order_acquire);
+    bool rebase = atomic_exchange(&s_rebase_requested, false);
+
+    if (atomic_exchange(&s_reset_requested, false))
+    {
+        period_stats_reset(&s_stats, s_period_us, ticks);
+        return false;
+    }
+    if (rebase)
+    {
+        period_stats_rebase(&s_stats, s_period_us, ticks);
+        return false;
+    }
+    return period_stats_record(&s_stats, now_us, ticks);
+}
+
+void sample_clock_log(void)
+{
+    period_summary_t summary;
+    period_stats_summary(&s_stats, &summary);
+    ESP_LOGI(TAG,
+             "period %" PRIu32 "us n=%" PRIu32 " missed=%" PRIu32 " jitter p50/p99 %" PRIu32 "/%" PRIu32
+             "us min/max %" PRId32 "/%" PRId32 "us drift %" PRId32 "us (%" PRId32 "..%" PRId32 ")",
+             summary.period_us, summary.count, summary.missed, summary.jitter_p50, summary.jitter_p99,
+             summary.jitter_min, summary.jitter_max, summary.drift, summary.drift_min, summary.drift_max);
+}
+
+#if CONFIG_GAMEPAD_CONSOLE
+static int cmd_clock(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "reset") == 0)
+    {
+        sample_clock_reset_stats();
+        return 0;
+    }
+
+    // Read by the console task while the sampling task updates it; good enough for a status display
+    period_summary_t summary;
+    period_stats_summary(&s_stats, &summary);
+    printf("period     %8" PRIu32 " us\n", summary.period_us);
+    printf("wakes      %8" PRIu32 "\n", summary.count);
+    printf("missed     %8" PRIu32 "\n", summary.missed);
+    printf("jitter p50 %8" PRIu32 " us\n", summary.jitter_p50);
+    printf("jitter p99 %8" PRIu32 " us\n", summary.jitter_p99);
+    printf("jitter min %8" PRId32 " us\n", summary.jitter_min);
+    printf("jitter max %8" PRId32 " us\n", summary.jitter_max);
+    printf("drift      %8" PRId32 " us (min %" PRId32 ", max %" PRId32 ")\n", summary.drift, summary.drift_min,
+           summary.drift_max);
+    return 0;
+}
+#endif
+
+void sample_clock_init(void)
+{
+    period_stats_reset(&s_stats, 0, 0);
+
+#if CONFIG_GAMEPAD_CONSOLE
+    const esp_console_cmd_t cmd = {
+        .command = "clock",
+        .help = "Show sampling clock jitter and drift, or 'clock reset' to clear them",
+        .hint = "[reset]",
+        .func = cmd_clock,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+#endif
+}
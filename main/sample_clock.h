@@ -0,0 +1,32 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Register the "clock" console command
+void sample_clock_init(void);
+
+// Notify task from a hardware timer interrupt every period_us, restarting the clock when
+// already running. The statistics carry on, measured against the new period. On failure
+// a running clock keeps its previous period.
+esp_err_t sample_clock_start(TaskHandle_t task, uint32_t period_us);
+
+void sample_clock_stop(void);
+
+bool sample_clock_running(void);
+
+// Clear the statistics, e.g. on a new connection. Safe from any task.
+void sample_clock_reset_stats(void);
+
+// Call after every wake of the sampling task; records period jitter and drift.
+// Returns false when the wake wasn't caused by the clock.
+bool sample_clock_wake(uint32_t now_us);
+
+void sample_clock_log(void);
@@ -0,0 +1,114 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "send_pipeline.h"
+
+#include <string.h>
+
+void send_pipeline_init(send_pipeline_t *pipe, unsigned max_in_flight, uint32_t stall_timeout_ms,
+                        send_pipeline_send_t send, void *ctx)
+{
+    memset(pipe, 0, sizeof(*pipe));
+    pipe->send = send;
+    pipe->ctx = ctx;
+    pipe->max_in_flight = max_in_flight ? max_in_flight : 1;
+    pipe->stall_timeout_us = (int64_t)stall_timeout_ms * 1000;
+    atomic_init(&pipe->in_flight, 0);
+}
+
+static void release_credit(send_pipeline_t *pipe)
+{
+    unsigned in_flight = atomic_load(&pipe->in_flight);
+    while (in_flight > 0 && !atomic_compare_exchange_weak(&pipe->in_flight, &in_flight, in_flight - 1))
+    {
+    }
+}
+
+void send_pipeline_reset(send_pipeline_t *pipe)
+{
+    atomic_store(&pipe->in_flight, 0);
+    pipe->has_pending = false;
+    pipe->stalled = false;
+}
+
+void send_pipeline_flush(send_pipeline_t *pipe, int64_t now_us)
+{
+    if (!pipe->has_pending)
+    {
+        return;
+    }
+
+    // Completions can get lost when the link drops; don't wait for them forever
+    if (atomic_load(&pipe->in_flight) >= pipe->max_in_flight)
+    {
+        if (pipe->stall_timeout_us == 0 || now_us - pipe->last_send_us < pipe->stall_timeout_us)
+        {
+            return;
+        }
+        atomic_store(&pipe->in_flight, 0);
+        atomic_fetch_add(&pipe->stalls, 1);
+        pipe->stalled = true;
+    }
+
+    // Only this task adds to in_flight, so the room seen above can't be taken by anyone else
+    atomic_fetch_add(&pipe->in_flight, 1);
+    pipe->has_pending = false;
+    pipe->last_send_us = now_us;
+    if (pipe->send(pipe->ctx, pipe->pending_id, pipe->pending, pipe->pending_len) == 0)
+    {
+        atomic_fetch_add(&pipe->sent, 1);
+    }
+    else
+    {
+        release_credit(pipe); // Never made it into the transport, no completion will come
+        atomic_fetch_add(&pipe->dropped, 1);
+    }
+}
+
+void send_pipeline_submit(send_pipeline_t *pipe, uint8_t report_id, const uint8_t *data, uint16_t len, int64_t now_us)
+{
+    if (len > SEND_PIPELINE_MAX_REPORT)
+    {
+        len = SEND_PIPELINE_MAX_REPORT;
+    }
+
+    atomic_fetch_add(&pipe->submitted, 1);
+    if (pipe->has_pending)
+    {
+        atomic_fetch_add(&pipe->coalesced, 1);
+    }
+    pipe->pending_id = report_id;
+    pipe->pending_len = len;
+    memcpy(pipe->pending, data, len);
+    pipe->has_pending = true;
+
+    send_pipeline_flush(pipe, now_us);
+}
+
+void send_pipeline_complete(send_pipeline_t *pipe, bool success)
+{
+    release_credit(pipe);
+    atomic_fetch_add(&pipe->completed, 1);
+    if (!success)
+    {
+        atomic_fetch_add(&pipe->failed, 1);
+    }
+}
+
+bool send_pipeline_take_stall(send_pipeline_t *pipe)
+{
+    bool stalled = pipe->stalled;
+    pipe->stalled = false;
+    return stalled;
+}
+
+void send_pipeline_get_stats(send_pipeline_t *pipe, send_pipeline_stats_t *stats)
+{
+    stats->submitted = atomic_load(&pipe->submitted);
+    stats->sent = atomic_load(&pipe->sent);
+    stats->completed = atomic_load(&pipe->completed);
+    stats->coalesced = atomic_load(&pipe->coalesced);
+    stats->dropped = atomic_load(&pipe->dropped);
+    stats->failed = atomic_load(&pipe->failed);
+    stats->stalls = atomic_load(&pipe->stalls);
+}
@@ -0,0 +1,80 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef SEND_PIPELINE_MAX_REPORT
+#define SEND_PIPELINE_MAX_REPORT 32
+#endif
+
+// Hands a report to the transport, returns 0 when it was accepted
+typedef int (*send_pipeline_send_t)(void *ctx, uint8_t report_id, const uint8_t *data, uint16_t len);
+
+typedef struct
+{
+    uint32_t submitted; // Reports handed to the pipeline
+    uint32_t sent;      // Reports handed to the transport
+    uint32_t completed; // Completions received
+    uint32_t coalesced; // Pending reports replaced by a newer one before they were sent
+    uint32_t dropped;   // Reports the transport refused to take
+    uint32_t failed;    // Completions with an error status
+    uint32_t stalls;    // Times the in-flight count was reset after completions stopped arriving
+} send_pipeline_stats_t;
+
+// Keeps at most max_in_flight reports inside the transport. While it is full only
+// the newest report is kept; older pending ones are replaced, not queued.
+//
+// submit/flush must be called from one task; complete may be called from any task.
+typedef struct
+{
+    send_pipeline_send_t send;
+    void *ctx;
+    unsigned max_in_flight;
+    int64_t stall_timeout_us;
+    atomic_uint in_flight;
+    int64_t last_send_us;
+    bool stalled; // In-flight count reset since the last send_pipeline_take_stall
+    bool has_pending;
+    uint8_t pending_id;
+    uint16_t pending_len;
+    uint8_t pending[SEND_PIPELINE_MAX_REPORT];
+    atomic_uint submitted;
+    atomic_uint sent;
+    atomic_uint completed;
+    atomic_uint coalesced;
+    atomic_uint dropped;
+    atomic_uint failed;
+    atomic_uint stalls;
+} send_pipeline_t;
+
+void send_pipeline_init(send_pipeline_t *pipe, unsigned max_in_flight, uint32_t stall_timeout_ms,
+                        send_pipeline_send_t send, void *ctx);
+
+// Forget in-flight and pending reports, e.g. on a new connection. Statistics are kept.
+void send_pipeline_reset(send_pipeline_t *pipe);
+
+// Queue the newest report, sending it straight away if there is room
+void send_pipeline_submit(send_pipeline_t *pipe, uint8_t report_id, const uint8_t *data, uint16_t len, int64_t now_us);
+
+// Send the pending report if a completion has freed room
+void send_pipeline_flush(send_pipeline_t *pipe, int64_t now_us);
+
+// A report handed to the transport has completed
+void send_pipeline_complete(send_pipeline_t *pipe, bool success);
+
+// True once after the in-flight count was reset because completions stopped arriving, so
+// the caller can forget its own record of reports in flight. Called from the submitting
+// task; the send callback runs there too and may call it before sending.
+bool send_pipeline_take_stall(send_pipeline_t *pipe);
+
+// True while reports are in flight or one waits for room. Called from the submitting task.
+static inline bool send_pipeline_busy(send_pipeline_t *pipe)
+{
+    return atomic_load(&pipe->in_flight) != 0 || pipe->has_pending;
+}
+
+void send_pipeline_get_stats(send_pipeline_t *pipe, send_pipeline_stats_t *stats);
@@ -0,0 +1,30 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "gamepad_inputs.h"
+
+// Chained 74HC165 parallel-in shift registers read as one SPI transfer. Register 0 is
+// the one whose QH drives MISO, so its byte arrives first; SPI takes bits MSB first and
+// the register shifts out H first, so byte k of the read holds inputs H..A of register k
+// in bits 7..0. Button 8k + n is input n (A = 0) of register k.
+
+// Turn one read of the chain into the button mask. Inputs are pulled up and read
+// low while pressed.
+static inline gamepad_buttons_t shift_chain_unpack(const uint8_t *rx, unsigned registers)
+{
+    gamepad_buttons_t high = 0;
+
+    for (unsigned k = registers; k-- > 0;)
+    {
+        high = (gamepad_buttons_t)(high << 8) | rx[k];
+    }
+    if (registers < sizeof(gamepad_buttons_t))
+    {
+        return (gamepad_buttons_t)~high & (((gamepad_buttons_t)1 << (registers * 8)) - 1);
+    }
+    return (gamepad_buttons_t)~high;
+}
@@ -0,0 +1,373 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// Host simulation of the input-to-report path for the linux target. Replays an
+// input script through the device's input pipeline (debounce, stick filter,
+// calibration, governor and scheduler), packer and send pipeline, against the fake
+// transport with a fixed link latency. The device's sleep policy runs alongside and
+// reports how long the pad would have dozed. Output commands go through the actuator
+// to the outputs gamepad_hal_sim.c records, polled once per sample.
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sdkconfig.h"
+
+#include "actuator.h"
+#include "axis_calibration.h"
+#include "config_block.h"
+#include "gamepad_hal.h"
+#include "gamepad_report.h"
+#include "gamepad_sim.h"
+#include "gamepad_transport_fake.h"
+#include "input_pipeline.h"
+#include "input_trace_codec.h"
+#include "latency_hist.h"
+#include "send_pipeline.h"
+#include "sleep_policy.h"
+
+#define SIM_TRACE_ENV "GAMEPAD_SIM_TRACE"
+#define SIM_FLASH_TRACE_ENV "GAMEPAD_SIM_FLASH_TRACE"
+#define SIM_MAX_BLOCKS 4096
+#define SIM_MAX_FRAMES 100000
+#define SIM_LINK_LATENCY_US 1250 // Send until completion, two baseband slot pairs
+#define SIM_IN_FLIGHT_SLOTS 16   // More than CONFIG_GAMEPAD_REPORTS_IN_FLIGHT
+#define SIM_SYNTHETIC_US 10000000
+
+#if CONFIG_GAMEPAD_LIGHT_SLEEP
+#define SIM_SETTLE_MS CONFIG_GAMEPAD_LIGHT_SLEEP_SETTLE_MS
+#else
+#define SIM_SETTLE_MS 100 // The menuconfig default, light sleep itself is off in this configuration
+#endif
+
+#if CONFIG_GAMEPAD_STICK_CURVE_QUADRATIC
+#define SIM_CURVE AXIS_CURVE_QUADRATIC
+#elif CONFIG_GAMEPAD_STICK_CURVE_CUBIC
+#define SIM_CURVE AXIS_CURVE_CUBIC
+#else
+#define SIM_CURVE AXIS_CURVE_LINEAR
+#endif
+
+typedef struct
+{
+    uint32_t input_us;    // Input change the report carries
+    uint32_t complete_us; // When the simulated link completes it
+    bool timed;           // Carries a change, not a keepalive or host request
+} sim_in_flight_t;
+
+static gamepad_sim_frame_t s_frames[SIM_MAX_FRAMES];
+static int16_t s_axis_lut[GAMEPAD_NUM_AXES][AXIS_LUT_SIZE];
+static input_pipeline_t s_input;
+static send_pipeline_t s_pipeline;
+static latency_hist_t s_latency;
+static sleep_policy_t s_sleep;
+static latency_hist_t s_wake_latency; // Doze end to the first report, as power_save.c measures it
+static int64_t s_wake_us = -1;
+
+static sim_in_flight_t s_in_flight[SIM_IN_FLIGHT_SLOTS];
+static unsigned s_in_flight_head;
+static unsigned s_in_flight_tail;
+static uint32_t s_report_input_us; // Input change carried by the newest submitted report
+static bool s_report_timed;
+static uint32_t s_reports;
+static uint32_t s_now_us;
+
+// One frame per line: time_us buttons axis0 axis1 axis2 axis3, '#' starts a comment
+static size_t load_trace(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[128];
+    size_t count = 0;
+
+    if (!f)
+    {
+        perror(path);
+        return 0;
+    }
+    while (count < SIM_MAX_FRAMES && fgets(line, sizeof(line), f))
+    {
+        gamepad_sim_frame_t *frame = &s_frames[count];
+        char buttons[24]; // Up to 64 bits, usually in hex
+        unsigned axes[GAMEPAD_NUM_AXES];
+
+        if (line[0] == '#' ||
+            sscanf(line, "%" SCNu32 " %23s %u %u %u %u", &frame->time_us, buttons, &axes[0], &axes[1], &axes[2],
+                   &axes[3]) != 6)
+        {
+            continue;
+        }
+        frame->buttons = (gamepad_buttons_t)strtoull(buttons, NULL, 0) & GAMEPAD_ALL_BUTTONS_MASK;
+        for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+        {
+            frame->axes[i] = axes[i] & AXIS_RAW_MAX;
+        }
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+typedef struct
+{
+    uint32_t seq;
+    uint32_t index;
+} sim_block_t;
+
+typedef struct
+{
+    input_trace_timeline_t timeline;
+    size_t count;
+} sim_decode_t;
+
+static int compare_blocks(const void *a, const void *b)
+{
+    uint32_t sa = ((const sim_block_t *)a)->seq, sb = ((const sim_block_t *)b)->seq;
+    return sa < sb ? -1 : sa > sb;
+}
+
+static void add_frame(void *ctx, const input_trace_frame_t *frame)
+{
+    sim_decode_t *decode = ctx;
+
+    if (decode->count < SIM_MAX_FRAMES)
+    {
+        gamepad_sim_frame_t *out = &s_frames[decode->count++];
+        out->time_us = input_trace_timeline_map(&decode->timeline, frame->time_us);
+        out->buttons = frame->buttons;
+        for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+        {
+            out->axes[i] = frame->axes[i] & AXIS_RAW_MAX;
+        }
+    }
+}
+
+// A copy of the device's "inputtrace" partition, e.g. from parttool.py read_partition.
+// Intact blocks are replayed oldest first.
+static size_t load_flash_trace(const char *path)
+{
+    static uint8_t blocks[SIM_MAX_BLOCKS][INPUT_TRACE_BLOCK_SIZE];
+    static sim_block_t order[SIM_MAX_BLOCKS];
+    FILE *f = fopen(path, "rb");
+    size_t count = 0;
+    sim_decode_t decode = {0};
+
+    if (!f)
+    {
+        perror(path);
+        return 0;
+    }
+    size_t read = fread(blocks, INPUT_TRACE_BLOCK_SIZE, SIM_MAX_BLOCKS, f);
+    fclose(f);
+
+    for (uint32_t i = 0; i < read; i++)
+    {
+        if (input_trace_block_check(blocks[i], &order[count].seq))
+        {
+            order[count++].index = i;
+        }
+    }
+    qsort(order, count, sizeof(order[0]), compare_blocks);
+    for (size_t i = 0; i < count; i++)
+    {
+        input_trace_block_decode(blocks[order[i].index], add_frame, &decode);
+    }
+    printf("%zu of %zu blocks intact\n", count, read);
+    return decode.count;
+}
+
+// Sticks sweeping and a button tapped every 100 ms, with a still stretch in the middle to let the pad go idle
+static size_t synthesize_trace(void)
+{
+    size_t count = 0;
+
+    for (uint32_t t = 0; t < SIM_SYNTHETIC_US && count < SIM_MAX_FRAMES; t += 1000)
+    {
+        gamepad_sim_frame_t *frame = &s_frames[count++];
+        bool still = t >= 4000000 && t < 8000000;
+        uint32_t phase = still ? 0 : (t / 1000) % 1000;
+        uint16_t sweep = phase < 500 ? phase * 8 : (1000 - phase) * 8;
+
+        frame->time_us = t;
+        frame->buttons = (!still && (t / 100000) % 2) ? (1U << GAMEPAD_BUTTON_A) : 0;
+        frame->axes[0] = sweep & AXIS_RAW_MAX;
+        frame->axes[1] = (AXIS_RAW_MAX - sweep) & AXIS_RAW_MAX;
+        frame->axes[2] = 2048;
+        frame->axes[3] = 2048;
+    }
+    return count;
+}
+
+static void record_report(void *ctx, uint8_t report_id, const uint8_t *data, uint16_t len)
+{
+    // The pipeline only ever sends the newest report
+    sim_in_flight_t *slot = &s_in_flight[s_in_flight_head++ % SIM_IN_FLIGHT_SLOTS];
+    slot->input_us = s_report_input_us;
+    slot->complete_us = s_now_us + SIM_LINK_LATENCY_US;
+    slot->timed = s_report_timed;
+    s_reports++;
+}
+
+static void complete_reports(uint32_t now_us)
+{
+    while (s_in_flight_tail != s_in_flight_head &&
+           s_in_flight[s_in_flight_tail % SIM_IN_FLIGHT_SLOTS].complete_us <= now_us)
+    {
+        sim_in_flight_t *slot = &s_in_flight[s_in_flight_tail++ % SIM_IN_FLIGHT_SLOTS];
+        if (slot->timed)
+        {
+            latency_hist_record(&s_latency, slot->complete_us - slot->input_us);
+        }
+        gamepad_transport_fake_complete(true);
+    }
+}
+
+static void report_sent(bool ok)
+{
+    send_pipeline_complete(&s_pipeline, ok);
+}
+
+static const gamepad_transport_callbacks_t s_transport_callbacks = {
+    .sent = report_sent,
+};
+
+// The device's calibration_map with the default calibration
+static void map_axes(const uint16_t raw[GAMEPAD_NUM_AXES], int16_t axes[GAMEPAD_NUM_AXES])
+{
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        axes[i] = axis_lut_apply(s_axis_lut[i], raw[i]);
+    }
+    stick_radial_deadzone(&axes[0], &axes[1], CONFIG_GAMEPAD_STICK_DEADZONE);
+    stick_radial_deadzone(&axes[2], &axes[3], CONFIG_GAMEPAD_STICK_DEADZONE);
+}
+
+static void sample(uint32_t now_us)
+{
+    uint32_t input_us = gamepad_sim_advance(now_us);
+    uint32_t first_edge_us;
+    input_sample_t sample;
+    gamepad_output_t output;
+
+    s_now_us = now_us;
+    actuator_service(&output);
+    complete_reports(now_us);
+    send_pipeline_flush(&s_pipeline, now_us);
+
+    input_pipeline_sample(&s_input, gamepad_hal_take_edges(&first_edge_us), now_us, &sample);
+    if (sleep_policy_update(&s_sleep, rate_governor_state(&s_input.governor) == RATE_GOVERNOR_IDLE,
+                            input_pipeline_busy(&s_input) || send_pipeline_busy(&s_pipeline), now_us) &&
+        sleep_policy_state(&s_sleep) == SLEEP_POLICY_AWAKE)
+    {
+        s_wake_us = now_us;
+    }
+
+    report_send_reason_t reason = input_pipeline_report(&s_input, &sample, now_us);
+    if (reason != REPORT_SEND_NONE)
+    {
+        uint8_t buffer[GAMEPAD_REPORT_SIZE];
+        uint16_t len = gamepad_report_pack(&sample.state, buffer);
+
+        s_report_input_us = input_us;
+        s_report_timed = reason == REPORT_SEND_BUTTONS || reason == REPORT_SEND_AXES;
+        send_pipeline_submit(&s_pipeline, GAMEPAD_REPORT_ID, buffer, len, now_us);
+        if (s_wake_us >= 0)
+        {
+            latency_hist_record(&s_wake_latency, (uint32_t)(now_us - s_wake_us));
+            s_wake_us = -1;
+        }
+    }
+}
+
+static double cpu_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void app_main(void)
+{
+    const char *flash_trace = getenv(SIM_FLASH_TRACE_ENV);
+    const char *trace = flash_trace ? flash_trace : getenv(SIM_TRACE_ENV);
+    size_t frames = flash_trace ? load_flash_trace(flash_trace) : trace ? load_trace(trace) : synthesize_trace();
+
+    if (frames == 0)
+    {
+        printf("no input frames\n");
+        return;
+    }
+    printf("replaying %zu frames from %s\n", frames, trace ? trace : "synthetic script");
+
+    axis_calibration_t cal;
+    axis_calibration_default(&cal);
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        axis_lut_build(s_axis_lut[i], &cal, SIM_CURVE);
+    }
+
+    config_block_t cfg;
+    config_block_defaults(&cfg);
+    input_pipeline_init(&s_input, map_axes);
+    input_pipeline_configure(&s_input, &cfg, 0);
+
+    send_pipeline_init(&s_pipeline, CONFIG_GAMEPAD_REPORTS_IN_FLIGHT, CONFIG_GAMEPAD_SEND_STALL_TIMEOUT_MS,
+                       gamepad_transport_send_report, NULL);
+    latency_hist_reset(&s_latency);
+    latency_hist_reset(&s_wake_latency);
+    const sleep_policy_config_t sleep_config = {.settle_ms = SIM_SETTLE_MS};
+    sleep_policy_init(&s_sleep, &sleep_config, 0);
+
+    gamepad_sim_load(s_frames, frames);
+    gamepad_transport_start(&s_transport_callbacks);
+    gamepad_transport_fake_set_recorder(record_report, NULL);
+    gamepad_transport_fake_connect();
+    gamepad_hal_input_init();
+    actuator_init(NULL);
+    input_pipeline_start(&s_input);
+
+    // Wake on the sample clock or on a completion, like the device task
+    uint32_t end_us = gamepad_sim_end_us();
+    uint32_t next_sample_us = 0;
+    uint32_t samples = 0;
+    double cpu_start = cpu_seconds();
+
+    for (uint32_t now_us = 0; now_us <= end_us;)
+    {
+        sample(now_us);
+        samples++;
+        if (now_us >= next_sample_us)
+        {
+            next_sample_us = now_us + rate_governor_sample_us(&s_input.governor);
+        }
+
+        now_us = next_sample_us;
+        if (s_in_flight_tail != s_in_flight_head &&
+            s_in_flight[s_in_flight_tail % SIM_IN_FLIGHT_SLOTS].complete_us < now_us)
+        {
+            now_us = s_in_flight[s_in_flight_tail % SIM_IN_FLIGHT_SLOTS].complete_us;
+        }
+    }
+
+    double cpu = cpu_seconds() - cpu_start;
+    gamepad_output_t output;
+    actuator_off(); // As on disconnect
+    actuator_service(&output);
+    send_pipeline_stats_t stats;
+    latency_summary_t latency;
+    send_pipeline_get_stats(&s_pipeline, &stats);
+    latency_hist_summary(&s_latency, &latency);
+
+    printf("simulated %.3f s: %" PRIu32 " samples, %" PRIu32 " reports (%.1f/s), %" PRIu32 " coalesced\n",
+           end_us / 1e6, samples, s_reports, s_reports / (end_us / 1e6), stats.coalesced);
+    printf("cpu %.3f ms: %.0f ns/sample, %.0f ns/report, %.0f reports/s of cpu\n", cpu * 1e3,
+           cpu * 1e9 / samples, s_reports ? cpu * 1e9 / s_reports : 0.0, cpu > 0 ? s_reports / cpu : 0.0);
+    printf("input to completion p50/p99/max %" PRIu32 "/%" PRIu32 "/%" PRIu32 " us, n=%" PRIu32 "\n", latency.p50,
+           latency.p99, latency.max, latency.count);
+
+    latency_summary_t wake;
+    uint64_t doze_us = sleep_policy_doze_us(&s_sleep, end_us);
+    latency_hist_summary(&s_wake_latency, &wake);
+    printf("dozing %.3f s (%.0f%%) in %" PRIu32 " dozes, wake to report p50/max %" PRIu32 "/%" PRIu32 " us\n",
+           doze_us / 1e6, end_us ? doze_us * 100.0 / end_us : 0.0, s_sleep.dozes, wake.p50, wake.max);
+}
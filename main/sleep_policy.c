@@ -0,0 +1,53 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "sleep_policy.h"
+
+void sleep_policy_init(sleep_policy_t *policy, const sleep_policy_config_t *config, int64_t now_us)
+{
+    policy->config = *config;
+    policy->state = SLEEP_POLICY_AWAKE;
+    policy->last_busy_us = now_us;
+    policy->doze_start_us = now_us;
+    policy->doze_us = 0;
+    policy->dozes = 0;
+}
+
+bool sleep_policy_update(sleep_policy_t *policy, bool idle, bool busy, int64_t now_us)
+{
+    if (policy->state == SLEEP_POLICY_DOZE)
+    {
+        // Work left over from a doze sample (a keepalive in flight) completes on its own
+        if (idle)
+        {
+            return false;
+        }
+        policy->doze_us += now_us - policy->doze_start_us;
+        policy->last_busy_us = now_us;
+        policy->state = SLEEP_POLICY_AWAKE;
+        return true;
+    }
+
+    if (!idle || busy)
+    {
+        policy->last_busy_us = now_us;
+        return false;
+    }
+    if (now_us - policy->last_busy_us < (int64_t)policy->config.settle_ms * 1000)
+    {
+        return false;
+    }
+    policy->doze_start_us = now_us;
+    policy->dozes++;
+    policy->state = SLEEP_POLICY_DOZE;
+    return true;
+}
+
+uint64_t sleep_policy_doze_us(const sleep_policy_t *policy, int64_t now_us)
+{
+    if (policy->state == SLEEP_POLICY_DOZE)
+    {
+        return policy->doze_us + (now_us - policy->doze_start_us);
+    }
+    return policy->doze_us;
+}
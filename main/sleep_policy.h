@@ -0,0 +1,46 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum
+{
+    SLEEP_POLICY_AWAKE = 0, // Sampling from the sample clock, the chip stays awake
+    SLEEP_POLICY_DOZE,      // Sampling from the tick, the chip may light-sleep in between
+} sleep_policy_state_t;
+
+typedef struct
+{
+    uint32_t settle_ms; // Time idle with nothing in flight before dozing
+} sleep_policy_config_t;
+
+// Decides when the input task may let the chip sleep between samples. It dozes only
+// once the rate governor is idle and nothing has been busy for settle_ms; it wakes
+// as soon as the governor goes active again.
+typedef struct
+{
+    sleep_policy_config_t config;
+    sleep_policy_state_t state;
+    int64_t last_busy_us;  // Last sample that was active or had work outstanding
+    int64_t doze_start_us;
+    uint64_t doze_us;      // Time spent dozing, not counting the current doze
+    uint32_t dozes;
+} sleep_policy_t;
+
+void sleep_policy_init(sleep_policy_t *policy, const sleep_policy_config_t *config, int64_t now_us);
+
+// Feed one sample. idle is the rate governor's state; busy is true while something still
+// needs the fast path (reports in flight, a release being debounced, a calibration).
+// Returns true when the state changed.
+bool sleep_policy_update(sleep_policy_t *policy, bool idle, bool busy, int64_t now_us);
+
+static inline sleep_policy_state_t sleep_policy_state(const sleep_policy_t *policy)
+{
+    return policy->state;
+}
+
+// Total time spent dozing, including the current doze
+uint64_t sleep_policy_doze_us(const sleep_policy_t *policy, int64_t now_us);
@@ -0,0 +1,33 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+// TRACE_EVENT(id, level, tag, format). The format takes up to four unsigned 16-bit arguments.
+#define TRACE_EVENT_LIST                                                                                          \
+    TRACE_EVENT(TRACE_EVT_GAP_MODE_CHG, ESP_LOG_INFO, "esp_bt_gap_cb", "ESP_BT_GAP_MODE_CHG_EVT mode:%u")        \
+    TRACE_EVENT(TRACE_EVT_GAP_EVENT, ESP_LOG_INFO, "esp_bt_gap_cb", "event: %u")                                \
+    TRACE_EVENT(TRACE_EVT_HIDD_SEND_REPORT, ESP_LOG_DEBUG, "esp_bt_hidd_cb",                                    \
+                "ESP_HIDD_SEND_REPORT_EVT id:0x%02x, type:%u")                                                   \
+    TRACE_EVENT(TRACE_EVT_HIDD_SEND_REPORT_FAILED, ESP_LOG_ERROR, "esp_bt_hidd_cb",                             \
+                "ESP_HIDD_SEND_REPORT_EVT id:0x%02x, type:%u, status:%u, reason:%u")                             \
+    TRACE_EVENT(TRACE_EVT_HIDD_REPORT_ERR, ESP_LOG_INFO, "esp_bt_hidd_cb", "ESP_HIDD_REPORT_ERR_EVT")            \
+    TRACE_EVENT(TRACE_EVT_HIDD_GET_REPORT, ESP_LOG_INFO, "esp_bt_hidd_cb",                                      \
+                "ESP_HIDD_GET_REPORT_EVT id:0x%02x, type:%u, size:%u")                                           \
+    TRACE_EVENT(TRACE_EVT_HIDD_SET_REPORT, ESP_LOG_INFO, "esp_bt_hidd_cb",                                      \
+                "ESP_HIDD_SET_REPORT_EVT id:0x%02x, type:%u, len:%u")                                            \
+    TRACE_EVENT(TRACE_EVT_HIDD_SET_PROTOCOL, ESP_LOG_INFO, "esp_bt_hidd_cb", "ESP_HIDD_SET_PROTOCOL_EVT mode:%u") \
+    TRACE_EVENT(TRACE_EVT_HIDD_INTR_DATA, ESP_LOG_INFO, "esp_bt_hidd_cb",                                       \
+                "ESP_HIDD_INTR_DATA_EVT id:0x%02x, len:%u")                                                      \
+    TRACE_EVENT(TRACE_EVT_BLE_GAP_EVENT, ESP_LOG_INFO, "transport_ble", "gap event: %u")                         \
+    TRACE_EVENT(TRACE_EVT_BLE_CONN_PARAMS, ESP_LOG_INFO, "transport_ble",                                       \
+                "connection parameters status:%u, interval:%u x 1.25 ms, latency:%u")                            \
+    TRACE_EVENT(TRACE_EVT_BLE_NOTIFY_FAILED, ESP_LOG_ERROR, "transport_ble", "notification handle:%u, status:0x%x")
+
+typedef enum
+{
+#define TRACE_EVENT(id, level, tag, format) id,
+    TRACE_EVENT_LIST
+#undef TRACE_EVENT
+        TRACE_EVT_COUNT,
+} trace_event_t;
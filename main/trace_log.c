@@ -0,0 +1,147 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "trace_log.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#if CONFIG_GAMEPAD_CONSOLE
+#include "esp_console.h"
+#endif
+
+#include "trace_ring.h"
+
+typedef struct
+{
+    esp_log_level_t level;
+    const char *tag;
+    const char *format;
+} trace_event_info_t;
+
+static const trace_event_info_t s_events[TRACE_EVT_COUNT] = {
+#define TRACE_EVENT(id, level, tag, format) [id] = {level, tag, format},
+    TRACE_EVENT_LIST
+#undef TRACE_EVENT
+};
+
+static const char s_level_letter[] = {'N', 'E', 'W', 'I', 'D', 'V'};
+
+// Log one event the way ESP_LOGx would, with the given millisecond timestamp
+static void emit(trace_event_t event, uint32_t timestamp_ms, const uint16_t args[4])
+{
+    const trace_event_info_t *info = &s_events[event];
+    char message[96];
+
+    snprintf(message, sizeof(message), info->format, args[0], args[1], args[2], args[3]);
+    esp_log_write(info->level, info->tag, "%c (%" PRIu32 ") %s: %s\n", s_level_letter[info->level], timestamp_ms,
+                  info->tag, message);
+}
+
+#if CONFIG_GAMEPAD_TRACE
+
+_Static_assert((CONFIG_GAMEPAD_TRACE_RING_SIZE & (CONFIG_GAMEPAD_TRACE_RING_SIZE - 1)) == 0,
+               "CONFIG_GAMEPAD_TRACE_RING_SIZE must be a power of two");
+
+static const char *TAG = "trace";
+
+static trace_slot_t s_slots[CONFIG_GAMEPAD_TRACE_RING_SIZE];
+static trace_ring_t s_ring = {.slots = s_slots, .mask = CONFIG_GAMEPAD_TRACE_RING_SIZE - 1};
+static SemaphoreHandle_t s_drain_mutex;
+static StaticSemaphore_t s_drain_mutex_buf;
+
+void trace_log(trace_event_t event, uint16_t arg0, uint16_t arg1, uint16_t arg2, uint16_t arg3)
+{
+    trace_record_t record = {
+        .timestamp_us = (uint32_t)esp_timer_get_time(),
+        .event = event,
+        .args = {arg0, arg1, arg2, arg3},
+    };
+    trace_ring_write(&s_ring, &record);
+}
+
+void trace_log_drain(void)
+{
+    trace_record_t record;
+
+    if (!s_drain_mutex)
+    {
+        return;
+    }
+
+    xSemaphoreTake(s_drain_mutex, portMAX_DELAY);
+    while (trace_ring_read(&s_ring, &record))
+    {
+        if (record.event < TRACE_EVT_COUNT)
+        {
+            emit(record.event, record.timestamp_us / 1000, record.args);
+        }
+    }
+    uint32_t lost = trace_ring_take_lost(&s_ring);
+    xSemaphoreGive(s_drain_mutex);
+
+    if (lost)
+    {
+        ESP_LOGW(TAG, "%" PRIu32 " trace records lost", lost);
+    }
+}
+
+#if CONFIG_GAMEPAD_TRACE_DRAIN_INTERVAL_MS > 0
+static void trace_drain_task(void *pvParameters)
+{
+    for (;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_GAMEPAD_TRACE_DRAIN_INTERVAL_MS));
+        trace_log_drain();
+    }
+}
+#endif
+
+#if CONFIG_GAMEPAD_CONSOLE
+static int cmd_trace(int argc, char **argv)
+{
+    trace_log_drain();
+    return 0;
+}
+#endif
+
+void trace_log_init(void)
+{
+    s_drain_mutex = xSemaphoreCreateMutexStatic(&s_drain_mutex_buf);
+
+#if CONFIG_GAMEPAD_TRACE_DRAIN_INTERVAL_MS > 0
+    xTaskCreate(trace_drain_task, "trace_drain", 3 * 1024, NULL, tskIDLE_PRIORITY + 1, NULL);
+#endif
+
+#if CONFIG_GAMEPAD_CONSOLE
+    const esp_console_cmd_t cmd = {
+        .command = "trace",
+        .help = "Print pending trace records",
+        .func = cmd_trace,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+#endif
+}
+
+#else
+
+void trace_log(trace_event_t event, uint16_t arg0, uint16_t arg1, uint16_t arg2, uint16_t arg3)
+{
+    const uint16_t args[4] = {arg0, arg1, arg2, arg3};
+    emit(event, esp_log_timestamp(), args);
+}
+
+void trace_log_init(void)
+{
+}
+
+void trace_log_drain(void)
+{
+}
+
+#endif
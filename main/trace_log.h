@@ -0,0 +1,25 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "trace_events.h"
+
+// Record an event from any task or ISR. With CONFIG_GAMEPAD_TRACE the event is
+// stored as a fixed-size binary record and formatted later by a low-priority
+// task; otherwise it is logged straight away.
+void trace_log(trace_event_t event, uint16_t arg0, uint16_t arg1, uint16_t arg2, uint16_t arg3);
+
+#define TRACE_LOG0(event) trace_log(event, 0, 0, 0, 0)
+#define TRACE_LOG1(event, a0) trace_log(event, a0, 0, 0, 0)
+#define TRACE_LOG2(event, a0, a1) trace_log(event, a0, a1, 0, 0)
+#define TRACE_LOG3(event, a0, a1, a2) trace_log(event, a0, a1, a2, 0)
+#define TRACE_LOG4(event, a0, a1, a2, a3) trace_log(event, a0, a1, a2, a3)
+
+// Start the drain task and register the "trace" console command
+void trace_log_init(void);
+
+// Format and log every pending record now
+void trace_log_drain(void);
@@ -0,0 +1,78 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "trace_ring.h"
+
+#include <string.h>
+
+void trace_ring_init(trace_ring_t *ring, trace_slot_t *slots, uint32_t size)
+{
+    memset(slots, 0, size * sizeof(*slots));
+    ring->slots = slots;
+    ring->mask = size - 1;
+    atomic_init(&ring->head, 0);
+    ring->tail = 0;
+    ring->lost = 0;
+}
+
+void trace_ring_write(trace_ring_t *ring, const trace_record_t *record)
+{
+    uint32_t idx = atomic_fetch_add_explicit(&ring->head, 1, memory_order_relaxed);
+    trace_slot_t *slot = &ring->slots[idx & ring->mask];
+
+    atomic_store_explicit(&slot->seq, (idx + 1) ^ TRACE_SLOT_BUSY, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release); // Mark busy before the record changes
+    slot->record = *record;
+    atomic_store_explicit(&slot->seq, idx + 1, memory_order_release);
+}
+
+bool trace_ring_read(trace_ring_t *ring, trace_record_t *record)
+{
+    uint32_t size = ring->mask + 1;
+
+    for (;;)
+    {
+        uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (ring->tail == head)
+        {
+            return false;
+        }
+        if (head - ring->tail > size)
+        {
+            ring->lost += head - ring->tail - size; // Overwritten before we got here
+            ring->tail = head - size;
+        }
+
+        trace_slot_t *slot = &ring->slots[ring->tail & ring->mask];
+        uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if ((int32_t)(seq - (ring->tail + 1)) < 0)
+        {
+            return false; // Writer hasn't finished this slot, try again later
+        }
+        if (seq != ring->tail + 1)
+        {
+            ring->lost++; // Already reused by a newer record
+            ring->tail++;
+            continue;
+        }
+
+        *record = slot->record;
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->seq, memory_order_relaxed) != seq)
+        {
+            ring->lost++; // Overwritten while we copied it
+            ring->tail++;
+            continue;
+        }
+
+        ring->tail++;
+        return true;
+    }
+}
+
+uint32_t trace_ring_take_lost(trace_ring_t *ring)
+{
+    uint32_t lost = ring->lost;
+    ring->lost = 0;
+    return lost;
+}
@@ -0,0 +1,48 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Flipping the top bit makes a slot being written look 2^31 records old to the reader,
+// whatever the index: no value is reserved, so the index can wrap
+#define TRACE_SLOT_BUSY 0x80000000U
+
+typedef struct
+{
+    uint32_t timestamp_us;
+    uint16_t event;
+    uint16_t args[4];
+} trace_record_t;
+
+typedef struct
+{
+    atomic_uint seq; // Write index + 1 once complete, with TRACE_SLOT_BUSY flipped while being written
+    trace_record_t record;
+} trace_slot_t;
+
+// Fixed-size ring of trace records. Any number of writers (tasks or ISRs) never
+// block or wait; when the ring is full the oldest records are overwritten. One
+// reader at a time drains it and is told how many records it missed.
+typedef struct
+{
+    trace_slot_t *slots;
+    uint32_t mask;
+    atomic_uint head;
+    uint32_t tail;
+    uint32_t lost;
+} trace_ring_t;
+
+// size must be a power of two
+void trace_ring_init(trace_ring_t *ring, trace_slot_t *slots, uint32_t size);
+
+void trace_ring_write(trace_ring_t *ring, const trace_record_t *record);
+
+// Take the oldest complete record, false when there is none (yet)
+bool trace_ring_read(trace_ring_t *ring, trace_record_t *record);
+
+// Records overwritten before they were read, since the last call
+uint32_t trace_ring_take_lost(trace_ring_t *ring);
@@ -0,0 +1,58 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "check.h"
+
+// Microbenchmarks for the host tests. A loop runs BENCH_ROUNDS times and the fastest
+// round counts, being the one least disturbed by the rest of the machine. Limits are
+// loose enough for a busy CI runner: they catch a hot path that became several times
+// slower, not a few percent. Benchmarks carry the "bench" ctest label.
+
+#define BENCH_ROUNDS 7
+
+static inline int64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Run body n times per round and store the best round's time per iteration in result, in ns.
+// The body sees the iteration number as bench_i.
+#define BENCH_NS_PER_OP(result, n, body)                                   \
+    do                                                                     \
+    {                                                                      \
+        double best_ = 1e30;                                               \
+        for (int round_ = 0; round_ < BENCH_ROUNDS; round_++)              \
+        {                                                                  \
+            int64_t start_ = bench_now_ns();                               \
+            for (uint32_t bench_i = 0; bench_i < (uint32_t)(n); bench_i++) \
+            {                                                              \
+                body;                                                      \
+            }                                                              \
+            double ns_ = (double)(bench_now_ns() - start_) / (n);          \
+            if (ns_ < best_)                                               \
+            {                                                              \
+                best_ = ns_;                                               \
+            }                                                              \
+        }                                                                  \
+        (result) = best_;                                                  \
+    } while (0)
+
+// Print a measurement without a limit, e.g. the baseline it is compared with
+#define BENCH_PRINT(name, ns) printf("  %-36s %10.1f ns\n", name, (double)(ns))
+
+// Print a measurement and fail when it is over limit_ns
+#define BENCH_CHECK_MAX(name, ns, limit_ns)                                                  \
+    do                                                                                       \
+    {                                                                                        \
+        printf("  %-36s %10.1f ns  (limit %.0f)\n", name, (double)(ns), (double)(limit_ns)); \
+        CHECK((ns) <= (limit_ns));                                                           \
+    } while (0)
@@ -0,0 +1,53 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// One debounce update of every button, as the input task runs it each sample: the
+// bit-parallel vertical counters against a loop with a counter per button. Built for
+// the GPIO buttons and a 64-input chain, where the loop is four times longer and the
+// vertical counters cost the same.
+#include <stdio.h>
+
+#include "bench.h"
+
+#include "button_debounce.h"
+#include "debounce_model.h"
+
+#define ITERATIONS 1000000
+#define PATTERNS 256 // Raw samples cycled through, precomputed so the loop only debounces
+
+#define UPDATE_LIMIT_NS 100 // Catches a slower algorithm, not a busy machine; MIN_SPEEDUP catches the rest
+#define MIN_SPEEDUP 2
+
+static gamepad_buttons_t s_raw[PATTERNS];
+static volatile gamepad_buttons_t s_sink;
+
+int main(void)
+{
+    button_debounce_t db;
+    debounce_model_t model;
+    double vertical_ns, loop_ns;
+    uint32_t seed = 0x9E3779B9;
+
+    // Mostly held buttons with some bounce, as during play
+    gamepad_buttons_t raw = 0;
+    for (int i = 0; i < PATTERNS; i++)
+    {
+        raw ^= (gamepad_buttons_t)1 << (test_rand(&seed) % GAMEPAD_NUM_BUTTONS);
+        s_raw[i] = raw;
+    }
+
+    button_debounce_init(&db, CONFIG_GAMEPAD_DEBOUNCE_RELEASE_SAMPLES);
+    debounce_model_init(&model, CONFIG_GAMEPAD_DEBOUNCE_RELEASE_SAMPLES);
+    BENCH_NS_PER_OP(vertical_ns, ITERATIONS, s_sink = button_debounce_update(&db, s_raw[bench_i % PATTERNS]));
+    BENCH_NS_PER_OP(loop_ns, ITERATIONS, s_sink = debounce_model_update(&model, s_raw[bench_i % PATTERNS]));
+
+    printf("  %d buttons\n", GAMEPAD_NUM_BUTTONS);
+    BENCH_CHECK_MAX("button_debounce_update", vertical_ns, UPDATE_LIMIT_NS);
+    BENCH_PRINT("per-button counters", loop_ns);
+    printf("  vertical counters are %.1fx cheaper\n", loop_ns / vertical_ns);
+    CHECK(vertical_ns * MIN_SPEEDUP <= loop_ns);
+
+    // Both saw the same samples and agree
+    CHECK_EQ(db.state, model.state);
+    TEST_EXIT();
+}
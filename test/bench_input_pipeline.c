@@ -0,0 +1,147 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// The input task's CPU cost per sample and per report: the shared input pipeline
+// (debounce, stick filter, calibration, governor, scheduler), report packing and the
+// send pipeline, against scripted input and the fake transport, as the linux
+// simulation runs them. The host is several times faster than the ESP32, so this
+// catches a regression in the code path, not the on-device budget; `latency` on the
+// pad measures that.
+#include <inttypes.h>
+
+#include "bench.h"
+
+#include "axis_calibration.h"
+#include "config_block.h"
+#include "gamepad_hal.h"
+#include "gamepad_report.h"
+#include "gamepad_sim.h"
+#include "gamepad_transport_fake.h"
+#include "input_pipeline.h"
+#include "send_pipeline.h"
+
+// One second of motion, then still for long enough that the governor goes idle for a second
+#define MOVING_US 1000000
+#define SCRIPT_US (MOVING_US + CONFIG_GAMEPAD_IDLE_TIMEOUT_MS * 1000 + 1000000)
+#define FRAME_US 1000
+#define FRAMES (SCRIPT_US / FRAME_US)
+
+// Per report is the whole run divided by the reports, as the simulation prints it
+#define SAMPLE_LIMIT_NS 1000
+#define REPORT_LIMIT_NS 10000
+
+static gamepad_sim_frame_t s_frames[FRAMES];
+static int16_t s_axis_lut[GAMEPAD_NUM_AXES][AXIS_LUT_SIZE];
+static input_pipeline_t s_input;
+static send_pipeline_t s_pipeline;
+static uint32_t s_samples;
+static uint32_t s_reports;
+
+// Sticks sweeping and a button tapped every 100 ms, then still
+static void synthesize_script(void)
+{
+    for (uint32_t i = 0; i < FRAMES; i++)
+    {
+        uint32_t t = i * FRAME_US;
+        bool still = t >= MOVING_US;
+        uint32_t phase = still ? 0 : i % 1000;
+        uint16_t sweep = phase < 500 ? phase * 8 : (1000 - phase) * 8;
+
+        s_frames[i].time_us = t;
+        s_frames[i].buttons = (!still && (t / 100000) % 2) ? (1U << GAMEPAD_BUTTON_A) : 0;
+        s_frames[i].axes[0] = sweep & AXIS_RAW_MAX;
+        s_frames[i].axes[1] = (AXIS_RAW_MAX - sweep) & AXIS_RAW_MAX;
+        s_frames[i].axes[2] = 2048;
+        s_frames[i].axes[3] = 2048;
+    }
+}
+
+static void map_axes(const uint16_t raw[GAMEPAD_NUM_AXES], int16_t axes[GAMEPAD_NUM_AXES])
+{
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        axes[i] = axis_lut_apply(s_axis_lut[i], raw[i]);
+    }
+    stick_radial_deadzone(&axes[0], &axes[1], CONFIG_GAMEPAD_STICK_DEADZONE);
+    stick_radial_deadzone(&axes[2], &axes[3], CONFIG_GAMEPAD_STICK_DEADZONE);
+}
+
+static void report_sent(bool ok)
+{
+    send_pipeline_complete(&s_pipeline, ok);
+}
+
+static const gamepad_transport_callbacks_t s_transport_callbacks = {
+    .sent = report_sent,
+};
+
+// One connection replaying the whole script; the host completes every report by the next sample
+static void run_script(void)
+{
+    config_block_t cfg;
+    uint32_t first_edge_us;
+    input_sample_t sample;
+
+    gamepad_sim_load(s_frames, FRAMES);
+    config_block_defaults(&cfg);
+    input_pipeline_configure(&s_input, &cfg, 0);
+    input_pipeline_start(&s_input);
+    send_pipeline_reset(&s_pipeline);
+
+    for (uint32_t now_us = 0; now_us < SCRIPT_US; now_us += rate_governor_sample_us(&s_input.governor))
+    {
+        gamepad_sim_advance(now_us);
+        while (gamepad_transport_fake_complete(true))
+        {
+        }
+        send_pipeline_flush(&s_pipeline, now_us);
+
+        input_pipeline_sample(&s_input, gamepad_hal_take_edges(&first_edge_us), now_us, &sample);
+        if (input_pipeline_report(&s_input, &sample, now_us) != REPORT_SEND_NONE)
+        {
+            uint8_t buffer[GAMEPAD_REPORT_SIZE];
+            uint16_t len = gamepad_report_pack(&sample.state, buffer);
+            send_pipeline_submit(&s_pipeline, GAMEPAD_REPORT_ID, buffer, len, now_us);
+            s_reports++;
+        }
+        s_samples++;
+    }
+}
+
+int main(void)
+{
+    axis_calibration_t cal;
+    double run_ns;
+
+    synthesize_script();
+    axis_calibration_default(&cal);
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        axis_lut_build(s_axis_lut[i], &cal, AXIS_CURVE_LINEAR);
+    }
+    input_pipeline_init(&s_input, map_axes);
+    send_pipeline_init(&s_pipeline, CONFIG_GAMEPAD_REPORTS_IN_FLIGHT, CONFIG_GAMEPAD_SEND_STALL_TIMEOUT_MS,
+                       gamepad_transport_send_report, NULL);
+    gamepad_transport_start(&s_transport_callbacks);
+    gamepad_transport_fake_connect();
+    gamepad_hal_input_init();
+
+    // Every run replays the same script, so the counts are the same each time
+    run_script();
+    uint32_t samples = s_samples, reports = s_reports;
+    printf("  %" PRIu32 " samples and %" PRIu32 " reports per run\n", samples, reports);
+    CHECK(reports > MOVING_US / CONFIG_GAMEPAD_ACTIVE_REPORT_INTERVAL_US / 2); // The moving part is reported
+    CHECK(samples < SCRIPT_US / CONFIG_GAMEPAD_ACTIVE_SAMPLE_PERIOD_US);       // and the still part slowed down
+
+    BENCH_NS_PER_OP(run_ns, 1, run_script());
+    CHECK_EQ(s_samples, (BENCH_ROUNDS + 1) * samples);
+
+    send_pipeline_stats_t stats;
+    send_pipeline_get_stats(&s_pipeline, &stats);
+    CHECK_EQ(stats.failed, 0);
+    CHECK_EQ(stats.stalls, 0);
+
+    BENCH_CHECK_MAX("input pipeline, per sample", run_ns / samples, SAMPLE_LIMIT_NS);
+    BENCH_CHECK_MAX("input pipeline, per report", run_ns / reports, REPORT_LIMIT_NS);
+    TEST_EXIT();
+}
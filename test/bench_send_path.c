@@ -0,0 +1,123 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// Per-report CPU cost of the send path that both Bluetooth backends share: packing,
+// publishing for GET_REPORT, the send pipeline and the transport callbacks, with the
+// fake transport in place of the stack and the host completing every report. A second
+// run keeps the link full so that most reports are coalesced while they wait.
+//
+// What the backends do differently happens inside Bluedroid (an L2CAP interrupt
+// channel write for Classic, a GATT notification for BLE), so the host can't compare
+// them. gamepad_transport_bt.c and gamepad_transport_ble.c only add a call into the
+// stack; the `latency` submit stage on the pad measures that, one build per backend.
+#include <inttypes.h>
+#include <string.h>
+
+#include "bench.h"
+
+#include "gamepad_report.h"
+#include "gamepad_transport_fake.h"
+#include "report_requests.h"
+#include "send_pipeline.h"
+
+#define REPORTS 20000
+#define FULL_LINK_COMPLETE_EVERY 4 // With the link full, one completion per this many reports
+
+#define REPORT_LIMIT_NS 1000
+#define STAGE_LIMIT_NS 500
+
+static report_scheduler_t s_sched;
+static report_requests_t s_requests;
+static send_pipeline_t s_pipeline;
+static gamepad_state_t s_states[64];
+
+static void sent(bool ok)
+{
+    send_pipeline_complete(&s_pipeline, ok);
+}
+
+static const gamepad_transport_callbacks_t s_callbacks = {
+    .sent = sent,
+};
+
+// send_gamepad_report in main.c, less the latency stamps
+static void send_report(const gamepad_state_t *state, int64_t now_us)
+{
+    uint8_t buffer[GAMEPAD_REPORT_SIZE];
+    uint16_t len = gamepad_report_pack(state, buffer);
+
+    report_requests_publish(&s_requests, buffer, len);
+    send_pipeline_submit(&s_pipeline, GAMEPAD_REPORT_ID, buffer, len, now_us);
+}
+
+static void make_states(void)
+{
+    uint32_t seed = 0x5e9d5e9du;
+
+    for (size_t i = 0; i < sizeof(s_states) / sizeof(s_states[0]); i++)
+    {
+        s_states[i].buttons = (gamepad_buttons_t)test_rand(&seed) & GAMEPAD_ALL_BUTTONS_MASK;
+        for (int a = 0; a < GAMEPAD_NUM_AXES; a++)
+        {
+            s_states[i].axes[a] = (int16_t)test_rand(&seed);
+        }
+    }
+}
+
+int main(void)
+{
+    report_scheduler_config_t config = {.axis_deadband = 256, .keepalive_ms = 0, .min_interval_us = 4000};
+    send_pipeline_stats_t stats;
+    double report_ns, full_ns, pack_ns, pipeline_ns;
+    uint8_t buffer[GAMEPAD_REPORT_SIZE];
+
+    make_states();
+    report_scheduler_init(&s_sched, &config);
+    report_requests_init(&s_requests, &s_sched);
+    send_pipeline_init(&s_pipeline, CONFIG_GAMEPAD_REPORTS_IN_FLIGHT, CONFIG_GAMEPAD_SEND_STALL_TIMEOUT_MS,
+                       gamepad_transport_send_report, NULL);
+    gamepad_transport_start(&s_callbacks);
+    gamepad_transport_fake_connect();
+
+    // Every report sent and completed before the next one
+    BENCH_NS_PER_OP(report_ns, REPORTS, {
+        send_report(&s_states[bench_i % 64], bench_i * 1000);
+        gamepad_transport_fake_complete(true);
+    });
+    send_pipeline_get_stats(&s_pipeline, &stats);
+    CHECK_EQ(stats.sent, BENCH_ROUNDS * REPORTS);
+    CHECK_EQ(stats.completed, stats.sent);
+    CHECK_EQ(stats.coalesced, 0);
+
+    // The link full most of the time: reports wait for a credit and replace each other
+    BENCH_NS_PER_OP(full_ns, REPORTS, {
+        send_report(&s_states[bench_i % 64], bench_i * 1000);
+        if (bench_i % FULL_LINK_COMPLETE_EVERY == 0)
+        {
+            gamepad_transport_fake_complete(true);
+            send_pipeline_flush(&s_pipeline, bench_i * 1000);
+        }
+    });
+    while (gamepad_transport_fake_complete(true))
+    {
+    }
+    send_pipeline_get_stats(&s_pipeline, &stats);
+    CHECK(stats.coalesced > BENCH_ROUNDS * REPORTS / 2);
+    CHECK_EQ(stats.dropped, 0);
+    CHECK_EQ(stats.stalls, 0);
+    CHECK_EQ(atomic_load(&s_pipeline.in_flight), 0);
+
+    // The two halves on their own
+    BENCH_NS_PER_OP(pack_ns, REPORTS, gamepad_report_pack(&s_states[bench_i % 64], buffer));
+    BENCH_NS_PER_OP(pipeline_ns, REPORTS, {
+        send_pipeline_submit(&s_pipeline, GAMEPAD_REPORT_ID, buffer, sizeof(buffer), bench_i * 1000);
+        gamepad_transport_fake_complete(true);
+    });
+
+    printf("  %d-byte report, %d in flight\n", GAMEPAD_REPORT_SIZE, CONFIG_GAMEPAD_REPORTS_IN_FLIGHT);
+    BENCH_CHECK_MAX("send path, per report", report_ns, REPORT_LIMIT_NS);
+    BENCH_CHECK_MAX("send path, link full, per report", full_ns, REPORT_LIMIT_NS);
+    BENCH_CHECK_MAX("pack", pack_ns, STAGE_LIMIT_NS);
+    BENCH_CHECK_MAX("send pipeline and fake transport", pipeline_ns, STAGE_LIMIT_NS);
+    TEST_EXIT();
+}
@@ -0,0 +1,77 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// What an event costs the task that records it: trace_log's deferred path (one binary
+// record into the ring, formatted later by the drain task) against logging it straight
+// away, which formats the message and the log line and writes them out as ESP_LOGx does.
+// Here the line goes to /dev/null; on the pad it goes to a 115200 baud UART, where the
+// immediate path is slower still.
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "bench.h"
+
+#include "esp_timer.h"
+#include "trace_ring.h"
+
+#define RING_SIZE 256
+#define ITERATIONS 200000
+
+// The deferred path must stay cheap in absolute terms, and well below formatting
+#define DEFERRED_LIMIT_NS 250
+#define MIN_SPEEDUP 4
+
+static trace_slot_t s_slots[RING_SIZE];
+static trace_ring_t s_ring;
+static FILE *s_null;
+
+// trace_log() with CONFIG_GAMEPAD_TRACE
+static void trace_deferred(uint16_t event, uint16_t arg0, uint16_t arg1, uint16_t arg2, uint16_t arg3)
+{
+    trace_record_t record = {
+        .timestamp_us = (uint32_t)esp_timer_get_time(),
+        .event = event,
+        .args = {arg0, arg1, arg2, arg3},
+    };
+    trace_ring_write(&s_ring, &record);
+}
+
+// trace_log() without it: emit() formatting into esp_log_write
+static void trace_immediate(uint16_t event, uint16_t arg0, uint16_t arg1, uint16_t arg2, uint16_t arg3)
+{
+    char message[96];
+
+    snprintf(message, sizeof(message), "ESP_HIDD_SEND_REPORT_EVT id:0x%02x, type:%u, status:%u, reason:%u", arg0,
+             arg1, arg2, arg3);
+    fprintf(s_null, "%c (%" PRIu32 ") %s: %s\n", 'E', (uint32_t)(esp_timer_get_time() / 1000), "esp_bt_hidd_cb",
+            message);
+}
+
+int main(void)
+{
+    double deferred_ns, immediate_ns;
+    trace_record_t record;
+
+    s_null = fopen("/dev/null", "w");
+    CHECK(s_null != NULL);
+    if (!s_null)
+    {
+        TEST_EXIT();
+    }
+    trace_ring_init(&s_ring, s_slots, RING_SIZE);
+
+    // The drain task falls behind at this rate; the ring just wraps, as on the pad
+    BENCH_NS_PER_OP(deferred_ns, ITERATIONS, trace_deferred(3, 1, (uint16_t)bench_i, 5, 19));
+    BENCH_NS_PER_OP(immediate_ns, ITERATIONS, trace_immediate(3, 1, (uint16_t)bench_i, 5, 19));
+    fclose(s_null);
+
+    BENCH_CHECK_MAX("trace_log, deferred to the ring", deferred_ns, DEFERRED_LIMIT_NS);
+    BENCH_PRINT("trace_log, formatted at once", immediate_ns);
+    printf("  deferred is %.1fx cheaper\n", immediate_ns / deferred_ns);
+    CHECK(deferred_ns * MIN_SPEEDUP <= immediate_ns);
+
+    // Still readable after all that
+    CHECK(trace_ring_read(&s_ring, &record));
+    CHECK_EQ(record.event, 3);
+    TEST_EXIT();
+}
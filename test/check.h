@@ -0,0 +1,63 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Minimal checks for the host tests. A failed check is printed and counted, the test
+// carries on, and TEST_EXIT() turns the count into the exit status ctest looks at.
+
+static atomic_int s_check_failures; // Checks may run on several threads
+
+#define CHECK(cond)                                                                  \
+    do                                                                               \
+    {                                                                                \
+        if (!(cond))                                                                 \
+        {                                                                            \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            s_check_failures++;                                                      \
+        }                                                                            \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                      \
+    do                                                                                                  \
+    {                                                                                                   \
+        long long _actual = (long long)(actual), _expected = (long long)(expected);                     \
+        if (_actual != _expected)                                                                       \
+        {                                                                                               \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, _actual, \
+                    _expected);                                                                         \
+            s_check_failures++;                                                                         \
+        }                                                                                               \
+    } while (0)
+
+#define RUN_TEST(fn)         \
+    do                       \
+    {                        \
+        printf("%s\n", #fn); \
+        fn();                \
+    } while (0)
+
+#define TEST_EXIT()                                                                  \
+    do                                                                               \
+    {                                                                                \
+        if (s_check_failures)                                                        \
+        {                                                                            \
+            fprintf(stderr, "%d check(s) failed\n", atomic_load(&s_check_failures)); \
+            return 1;                                                                \
+        }                                                                            \
+        return 0;                                                                    \
+    } while (0)
+
+// xorshift32: a repeatable pseudo-random sequence for randomised tests, seed must not be 0
+static inline uint32_t test_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
@@ -0,0 +1,58 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include "gamepad_inputs.h"
+
+// The debounce rule written out one button at a time, with a plain counter each: what
+// button_debounce.h computes bit-parallel. Used as the reference in the debounce test
+// and as the baseline in its benchmark.
+typedef struct
+{
+    gamepad_buttons_t state;
+    uint8_t released[GAMEPAD_NUM_BUTTONS]; // Consecutive released samples while pressed
+    unsigned release_samples;
+} debounce_model_t;
+
+static inline void debounce_model_init(debounce_model_t *m, unsigned release_samples)
+{
+    m->state = 0;
+    for (int i = 0; i < GAMEPAD_NUM_BUTTONS; i++)
+    {
+        m->released[i] = 0;
+    }
+    m->release_samples = release_samples;
+}
+
+static inline gamepad_buttons_t debounce_model_update(debounce_model_t *m, gamepad_buttons_t raw)
+{
+    for (int i = 0; i < GAMEPAD_NUM_BUTTONS; i++)
+    {
+        gamepad_buttons_t bit = (gamepad_buttons_t)1 << i;
+
+        if (raw & bit)
+        {
+            m->state |= bit; // Presses go straight through
+            m->released[i] = 0;
+        }
+        else if ((m->state & bit) && ++m->released[i] >= m->release_samples)
+        {
+            m->state &= ~bit;
+            m->released[i] = 0;
+        }
+    }
+    return m->state;
+}
+
+static inline bool debounce_model_busy(const debounce_model_t *m)
+{
+    for (int i = 0; i < GAMEPAD_NUM_BUTTONS; i++)
+    {
+        if (m->released[i])
+        {
+            return true;
+        }
+    }
+    return false;
+}
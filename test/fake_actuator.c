@@ -0,0 +1,54 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "fake_actuator.h"
+
+#include <string.h>
+
+#define FAKE_ACTUATOR_MAX_REPORT 32
+
+static bool s_accept = true;
+static unsigned s_submits;
+static uint8_t s_last[FAKE_ACTUATOR_MAX_REPORT];
+static uint16_t s_last_len;
+
+#if CONFIG_GAMEPAD_OUTPUT_REPORT
+
+void actuator_init(actuator_wake_cb_t wake)
+{
+}
+
+bool actuator_submit(const uint8_t *data, uint16_t len)
+{
+    s_submits++;
+    s_last_len = len < sizeof(s_last) ? len : sizeof(s_last);
+    memcpy(s_last, data, s_last_len);
+    return s_accept;
+}
+
+void actuator_off(void)
+{
+}
+
+bool actuator_service(gamepad_output_t *applied)
+{
+    return false;
+}
+
+#endif
+
+void fake_actuator_set_accept(bool accept)
+{
+    s_accept = accept;
+}
+
+unsigned fake_actuator_submits(void)
+{
+    return s_submits;
+}
+
+uint16_t fake_actuator_last(uint8_t *buf)
+{
+    memcpy(buf, s_last, s_last_len);
+    return s_last_len;
+}
@@ -0,0 +1,19 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "actuator.h"
+
+// actuator.h without the motors and LEDs: submitted output reports are counted and the
+// last one kept, and actuator_submit returns whatever the test asked for.
+
+void fake_actuator_set_accept(bool accept);
+
+unsigned fake_actuator_submits(void);
+
+// Copies the last submitted report into buf (at least 32 bytes), returns its length
+uint16_t fake_actuator_last(uint8_t *buf);
@@ -0,0 +1,75 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "fake_gpio_port.h"
+
+#include <stddef.h>
+
+#define FAKE_GPIO_PINS 40
+
+typedef struct
+{
+    bool input;
+    int index;
+    gpio_port_edge_cb_t edge_cb;
+} fake_pin_t;
+
+static fake_pin_t s_pins[FAKE_GPIO_PINS];
+static uint64_t s_levels = ~0ULL; // Pulled up
+static unsigned s_notifications;
+static bool s_wake_armed;
+
+void gpio_port_input(int pin, int index, gpio_port_edge_cb_t edge_cb)
+{
+    s_pins[pin].input = true;
+    s_pins[pin].index = index;
+    s_pins[pin].edge_cb = edge_cb;
+}
+
+void gpio_port_read(uint32_t *in0, uint32_t *in1)
+{
+    *in0 = (uint32_t)s_levels;
+    *in1 = (uint32_t)(s_levels >> 32) & 0xFF;
+}
+
+void gpio_port_wake_arm(void)
+{
+    s_wake_armed = true;
+}
+
+void gpio_port_wake_disarm(void)
+{
+    s_wake_armed = false;
+}
+
+void fake_gpio_set(int pin, bool level)
+{
+    bool old = (s_levels >> pin) & 1;
+
+    s_levels = level ? s_levels | (1ULL << pin) : s_levels & ~(1ULL << pin);
+    if (old != level && s_pins[pin].input && s_pins[pin].edge_cb)
+    {
+        s_pins[pin].edge_cb(s_pins[pin].index);
+        s_notifications++;
+    }
+}
+
+bool fake_gpio_is_input(int pin)
+{
+    return s_pins[pin].input;
+}
+
+bool fake_gpio_has_edge_cb(int pin)
+{
+    return s_pins[pin].edge_cb != NULL;
+}
+
+unsigned fake_gpio_notifications(void)
+{
+    return s_notifications;
+}
+
+bool fake_gpio_wake_armed(void)
+{
+    return s_wake_armed;
+}
@@ -0,0 +1,24 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+
+#include "gpio_port.h"
+
+// gpio_port.h over a scripted pin bank. Inputs are pulled up, so they read high until a
+// test pulls them low. Edge callbacks run synchronously, as if from the interrupt.
+
+// Drive pin to level; an edge on an input with a callback calls it
+void fake_gpio_set(int pin, bool level);
+
+// True when pin was configured as an input, and whether it has an edge callback
+bool fake_gpio_is_input(int pin);
+bool fake_gpio_has_edge_cb(int pin);
+
+// Number of times the edge callback woke the task
+unsigned fake_gpio_notifications(void);
+
+// True between gpio_port_wake_arm and gpio_port_wake_disarm
+bool fake_gpio_wake_armed(void);
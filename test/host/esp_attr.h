@@ -0,0 +1,8 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_attr.h: there is only one kind of memory
+#define IRAM_ATTR
+#define DRAM_ATTR
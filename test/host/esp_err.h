@@ -0,0 +1,37 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Host stand-in for ESP-IDF's esp_err.h, with the codes the project uses
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_TIMEOUT 0x107
+#define ESP_ERR_NVS_NOT_FOUND 0x1102
+#define ESP_ERR_NVS_INVALID_LENGTH 0x110c
+
+static inline const char *esp_err_to_name(esp_err_t code)
+{
+    return code == ESP_OK ? "ESP_OK" : "ESP_ERR";
+}
+
+#define ESP_ERROR_CHECK(x)                                                                         \
+    do                                                                                             \
+    {                                                                                              \
+        esp_err_t err_rc_ = (x);                                                                   \
+        if (err_rc_ != ESP_OK)                                                                     \
+        {                                                                                          \
+            fprintf(stderr, "%s:%d: ESP_ERROR_CHECK failed: 0x%x\n", __FILE__, __LINE__, err_rc_); \
+            abort();                                                                               \
+        }                                                                                          \
+    } while (0)
@@ -0,0 +1,40 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "esp_gap_bt_api.h"
+
+#include <string.h>
+
+#define FAKE_MAX_BONDS 16
+
+static esp_bd_addr_t s_bonds[FAKE_MAX_BONDS];
+static int s_bond_count;
+static bool s_fail;
+
+esp_err_t esp_bt_gap_get_bond_device_list(int *dev_num, esp_bd_addr_t *dev_list)
+{
+    if (s_fail)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (*dev_num > s_bond_count)
+    {
+        *dev_num = s_bond_count;
+    }
+    memcpy(dev_list, s_bonds, (size_t)*dev_num * ESP_BD_ADDR_LEN);
+    return ESP_OK;
+}
+
+void esp_bt_gap_fake_set_bonds(const esp_bd_addr_t *bonds, int count)
+{
+    s_bond_count = count < FAKE_MAX_BONDS ? count : FAKE_MAX_BONDS;
+    if (s_bond_count > 0)
+    {
+        memcpy(s_bonds, bonds, (size_t)s_bond_count * ESP_BD_ADDR_LEN);
+    }
+}
+
+void esp_bt_gap_fake_set_fail(bool fail)
+{
+    s_fail = fail;
+}
@@ -0,0 +1,20 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+
+#include "esp_bt_defs.h"
+#include "esp_err.h"
+
+// Host stand-in for ESP-IDF's esp_gap_bt_api.h: a bond list the test sets up
+
+// Fills up to *dev_num addresses and sets *dev_num to the number filled, as the stack does
+esp_err_t esp_bt_gap_get_bond_device_list(int *dev_num, esp_bd_addr_t *dev_list);
+
+// Replace the bonded devices (up to 16)
+void esp_bt_gap_fake_set_bonds(const esp_bd_addr_t *bonds, int count);
+
+// Make esp_bt_gap_get_bond_device_list fail, as before the stack is up
+void esp_bt_gap_fake_set_fail(bool fail);
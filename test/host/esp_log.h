@@ -0,0 +1,23 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdio.h>
+
+// Host stand-in for ESP-IDF's esp_log.h. Tests stay quiet: the format is still
+// checked against its arguments, but nothing is printed.
+#define ESP_LOG_SILENT_(tag, format, ...)             \
+    do                                                \
+    {                                                 \
+        if (0)                                        \
+        {                                             \
+            printf("%s " format, tag, ##__VA_ARGS__); \
+        }                                             \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) ESP_LOG_SILENT_(tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_LOG_SILENT_(tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_SILENT_(tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_LOG_SILENT_(tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ESP_LOG_SILENT_(tag, format, ##__VA_ARGS__)
@@ -0,0 +1,66 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "esp_pm.h"
+
+struct esp_pm_lock
+{
+    int count;
+};
+
+static struct esp_pm_lock s_lock;
+static bool s_light_sleep_enabled;
+static esp_pm_sleep_cbs_register_config_t s_cbs;
+
+esp_err_t esp_pm_configure(const void *config)
+{
+    s_light_sleep_enabled = ((const esp_pm_config_t *)config)->light_sleep_enable;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t lock_type, int arg, const char *name, esp_pm_lock_handle_t *out_handle)
+{
+    s_lock.count = 0;
+    *out_handle = &s_lock;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t handle)
+{
+    handle->count++;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t handle)
+{
+    if (handle->count == 0)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    handle->count--;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_light_sleep_register_cbs(const esp_pm_sleep_cbs_register_config_t *cbs_conf)
+{
+    s_cbs = *cbs_conf;
+    return ESP_OK;
+}
+
+int esp_pm_fake_lock_count(void)
+{
+    return s_lock.count;
+}
+
+bool esp_pm_fake_light_sleep(int64_t sleep_us)
+{
+    if (!s_light_sleep_enabled || s_lock.count != 0)
+    {
+        return false;
+    }
+    if (s_cbs.exit_cb)
+    {
+        s_cbs.exit_cb(sleep_us, s_cbs.exit_cb_user_arg);
+    }
+    return true;
+}
@@ -0,0 +1,12 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include "esp_err.h"
+
+// Host stand-in for ESP-IDF's esp_sleep.h: wake-up sources are the HAL's business
+static inline esp_err_t esp_sleep_enable_gpio_wakeup(void)
+{
+    return ESP_OK;
+}
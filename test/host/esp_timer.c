@@ -0,0 +1,18 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "esp_timer.h"
+
+#include <stdatomic.h>
+
+static _Atomic int64_t s_now_us;
+
+int64_t esp_timer_get_time(void)
+{
+    return atomic_load(&s_now_us);
+}
+
+void esp_timer_fake_set(int64_t now_us)
+{
+    atomic_store(&s_now_us, now_us);
+}
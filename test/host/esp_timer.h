@@ -0,0 +1,11 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+// Host stand-in for ESP-IDF's esp_timer.h. Time only moves when a test sets it.
+int64_t esp_timer_get_time(void);
+
+void esp_timer_fake_set(int64_t now_us);
@@ -0,0 +1,208 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "nvs.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define NVS_FAKE_ENTRIES 16
+#define NVS_FAKE_NAME_MAX 16
+#define NVS_FAKE_BLOB_MAX 512
+
+typedef struct
+{
+    bool used;
+    char ns[NVS_FAKE_NAME_MAX];
+    char key[NVS_FAKE_NAME_MAX];
+    size_t length;
+    uint8_t value[NVS_FAKE_BLOB_MAX];
+} nvs_fake_entry_t;
+
+// Handles index this table; 0 is never handed out
+#define NVS_FAKE_HANDLES 8
+
+typedef struct
+{
+    bool open;
+    bool writable;
+    char ns[NVS_FAKE_NAME_MAX];
+} nvs_fake_handle_t;
+
+static nvs_fake_entry_t s_entries[NVS_FAKE_ENTRIES];
+static nvs_fake_handle_t s_handles[NVS_FAKE_HANDLES];
+static unsigned s_writes;
+static unsigned s_commits;
+
+static nvs_fake_handle_t *handle_get(nvs_handle_t handle)
+{
+    if (handle == 0 || handle >= NVS_FAKE_HANDLES || !s_handles[handle].open)
+    {
+        return NULL;
+    }
+    return &s_handles[handle];
+}
+
+static nvs_fake_entry_t *entry_find(const char *ns, const char *key)
+{
+    for (int i = 0; i < NVS_FAKE_ENTRIES; i++)
+    {
+        if (s_entries[i].used && strcmp(s_entries[i].ns, ns) == 0 && strcmp(s_entries[i].key, key) == 0)
+        {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static bool namespace_exists(const char *ns)
+{
+    for (int i = 0; i < NVS_FAKE_ENTRIES; i++)
+    {
+        if (s_entries[i].used && strcmp(s_entries[i].ns, ns) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    if (strlen(name) >= NVS_FAKE_NAME_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Like the real thing, a namespace only exists once something was written to it
+    if (open_mode == NVS_READONLY && !namespace_exists(name))
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    for (nvs_handle_t handle = 1; handle < NVS_FAKE_HANDLES; handle++)
+    {
+        if (!s_handles[handle].open)
+        {
+            s_handles[handle].open = true;
+            s_handles[handle].writable = open_mode == NVS_READWRITE;
+            strcpy(s_handles[handle].ns, name);
+            *out_handle = handle;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    nvs_fake_handle_t *h = handle_get(handle);
+
+    if (h)
+    {
+        h->open = false;
+    }
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    nvs_fake_handle_t *h = handle_get(handle);
+    nvs_fake_entry_t *entry;
+
+    if (!h)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!(entry = entry_find(h->ns, key)))
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value == NULL)
+    {
+        *length = entry->length;
+        return ESP_OK;
+    }
+    if (*length < entry->length)
+    {
+        *length = entry->length;
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out_value, entry->value, entry->length);
+    *length = entry->length;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    nvs_fake_handle_t *h = handle_get(handle);
+    nvs_fake_entry_t *entry;
+
+    if (!h || !h->writable || strlen(key) >= NVS_FAKE_NAME_MAX || length > NVS_FAKE_BLOB_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!(entry = entry_find(h->ns, key)))
+    {
+        for (int i = 0; i < NVS_FAKE_ENTRIES && !entry; i++)
+        {
+            if (!s_entries[i].used)
+            {
+                entry = &s_entries[i];
+            }
+        }
+        if (!entry)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+        entry->used = true;
+        strcpy(entry->ns, h->ns);
+        strcpy(entry->key, key);
+    }
+    memcpy(entry->value, value, length);
+    entry->length = length;
+    s_writes++;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    nvs_fake_handle_t *h = handle_get(handle);
+    nvs_fake_entry_t *entry;
+
+    if (!h || !h->writable)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!(entry = entry_find(h->ns, key)))
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    entry->used = false;
+    s_writes++;
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    if (!handle_get(handle))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_commits++;
+    return ESP_OK;
+}
+
+void nvs_fake_erase_all(void)
+{
+    memset(s_entries, 0, sizeof(s_entries));
+    s_writes = 0;
+    s_commits = 0;
+}
+
+unsigned nvs_fake_writes(void)
+{
+    return s_writes;
+}
+
+unsigned nvs_fake_commits(void)
+{
+    return s_commits;
+}
@@ -0,0 +1,35 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Host stand-in for ESP-IDF's nvs.h: blobs kept in memory, lost when the test exits.
+// Writes are visible straight away; nvs_commit only counts.
+typedef uint32_t nvs_handle_t;
+
+typedef enum
+{
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle);
+void nvs_close(nvs_handle_t handle);
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length);
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length);
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key);
+esp_err_t nvs_commit(nvs_handle_t handle);
+
+// Forget every namespace and key, and the counters
+void nvs_fake_erase_all(void);
+
+// nvs_set_blob and nvs_erase_key calls since the last nvs_fake_erase_all
+unsigned nvs_fake_writes(void);
+
+// nvs_commit calls since the last nvs_fake_erase_all
+unsigned nvs_fake_commits(void);
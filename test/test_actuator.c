@@ -0,0 +1,188 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// Output reports from the host: gamepad_output_parse with and without the report ID in
+// front and at every other length, then actuator.c taking them through the mailbox to
+// the outputs gamepad_hal_sim.c records.
+#include <string.h>
+
+#include "check.h"
+
+#include "actuator.h"
+#include "gamepad_report.h"
+#include "gamepad_sim.h"
+
+static unsigned s_wakes;
+
+static void count_wake(void)
+{
+    s_wakes++;
+}
+
+static gamepad_output_t sentinel(void)
+{
+    return (gamepad_output_t){.rumble_strong = 0xa5, .rumble_weak = 0xa5, .player_leds = 0xa5, .received_us = 0xa5};
+}
+
+// Refused, and out left alone
+static void check_rejected(const uint8_t *data, uint16_t len)
+{
+    gamepad_output_t out = sentinel();
+
+    CHECK(!gamepad_output_parse(data, len, &out));
+    CHECK_EQ(out.rumble_strong, 0xa5);
+    CHECK_EQ(out.rumble_weak, 0xa5);
+    CHECK_EQ(out.player_leds, 0xa5);
+}
+
+static void test_parse_payload(void)
+{
+    const uint8_t report[GAMEPAD_OUTPUT_REPORT_SIZE] = {200, 17, 0x05};
+    gamepad_output_t out = sentinel();
+
+    CHECK(gamepad_output_parse(report, sizeof(report), &out));
+    CHECK_EQ(out.rumble_strong, 200);
+    CHECK_EQ(out.rumble_weak, 17);
+    CHECK_EQ(out.player_leds, 0x05);
+
+    // The padding bits after the LEDs are dropped
+    const uint8_t padded[GAMEPAD_OUTPUT_REPORT_SIZE] = {0, 255, 0xff};
+    CHECK(gamepad_output_parse(padded, sizeof(padded), &out));
+    CHECK_EQ(out.rumble_strong, 0);
+    CHECK_EQ(out.rumble_weak, 255);
+    CHECK_EQ(out.player_leds, (1U << GAMEPAD_PLAYER_LEDS) - 1);
+
+    // A payload that starts with the report ID's value is still a payload
+    const uint8_t like_id[GAMEPAD_OUTPUT_REPORT_SIZE] = {GAMEPAD_OUTPUT_REPORT_ID, 1, 2};
+    CHECK(gamepad_output_parse(like_id, sizeof(like_id), &out));
+    CHECK_EQ(out.rumble_strong, GAMEPAD_OUTPUT_REPORT_ID);
+    CHECK_EQ(out.rumble_weak, 1);
+    CHECK_EQ(out.player_leds, 2);
+}
+
+static void test_parse_report_id(void)
+{
+    const uint8_t report[GAMEPAD_OUTPUT_REPORT_SIZE + 1] = {GAMEPAD_OUTPUT_REPORT_ID, 90, 180, 0x18};
+    gamepad_output_t out = sentinel();
+
+    CHECK(gamepad_output_parse(report, sizeof(report), &out));
+    CHECK_EQ(out.rumble_strong, 90);
+    CHECK_EQ(out.rumble_weak, 180);
+    CHECK_EQ(out.player_leds, 0x08);
+
+    // One byte too many with any other first byte is not a report
+    uint8_t other[GAMEPAD_OUTPUT_REPORT_SIZE + 1];
+    for (int id = 0; id < 256; id++)
+    {
+        if (id == GAMEPAD_OUTPUT_REPORT_ID)
+        {
+            continue;
+        }
+        memcpy(other, report, sizeof(other));
+        other[0] = (uint8_t)id;
+        check_rejected(other, sizeof(other));
+    }
+}
+
+static void test_parse_lengths(void)
+{
+    uint8_t buf[16];
+
+    for (int fill = 0; fill < 2; fill++)
+    {
+        memset(buf, fill ? GAMEPAD_OUTPUT_REPORT_ID : 0x11, sizeof(buf));
+        for (uint16_t len = 0; len < sizeof(buf); len++)
+        {
+            bool payload = len == GAMEPAD_OUTPUT_REPORT_SIZE;
+            bool with_id = len == GAMEPAD_OUTPUT_REPORT_SIZE + 1 && buf[0] == GAMEPAD_OUTPUT_REPORT_ID;
+            if (payload || with_id)
+            {
+                gamepad_output_t out;
+                CHECK(gamepad_output_parse(buf, len, &out));
+            }
+            else
+            {
+                check_rejected(buf, len);
+            }
+        }
+    }
+}
+
+static void test_submit_and_apply(void)
+{
+    gamepad_output_t applied, last;
+
+    s_wakes = 0;
+    actuator_init(count_wake);
+    CHECK_EQ(gamepad_sim_output(&last), 0);
+    CHECK(!actuator_service(&applied));
+
+    const uint8_t report[GAMEPAD_OUTPUT_REPORT_SIZE] = {128, 64, 0x01};
+    CHECK(actuator_submit(report, sizeof(report)));
+    CHECK_EQ(s_wakes, 1);
+    CHECK(actuator_service(&applied));
+    CHECK_EQ(gamepad_sim_output(&last), 1);
+    CHECK_EQ(last.rumble_strong, 128);
+    CHECK_EQ(last.rumble_weak, 64);
+    CHECK_EQ(last.player_leds, 0x01);
+    CHECK_EQ(applied.rumble_strong, 128);
+
+    // Nothing new, nothing set again
+    CHECK(!actuator_service(&applied));
+    CHECK_EQ(gamepad_sim_output(&last), 1);
+
+    // A malformed report is refused without waking the actuator task
+    CHECK(!actuator_submit(report, 2));
+    CHECK_EQ(s_wakes, 1);
+    CHECK(!actuator_service(&applied));
+}
+
+static void test_newest_applied(void)
+{
+    gamepad_output_t applied, last;
+    uint8_t report[GAMEPAD_OUTPUT_REPORT_SIZE + 1] = {GAMEPAD_OUTPUT_REPORT_ID, 0, 0, 0};
+
+    s_wakes = 0;
+    actuator_init(count_wake);
+
+    // Commands that arrive faster than they are applied: only the newest reaches the motors
+    for (int i = 1; i <= 10; i++)
+    {
+        report[1] = (uint8_t)(i * 20);
+        report[3] = (uint8_t)(i & 0x0f);
+        CHECK(actuator_submit(report, sizeof(report)));
+    }
+    CHECK_EQ(s_wakes, 10);
+    CHECK(actuator_service(&applied));
+    CHECK(!actuator_service(&applied));
+    CHECK_EQ(gamepad_sim_output(&last), 1);
+    CHECK_EQ(last.rumble_strong, 200);
+    CHECK_EQ(last.player_leds, 10);
+
+    // Off stops everything, also after a command nobody applied yet
+    CHECK(actuator_submit(report, sizeof(report)));
+    actuator_off();
+    CHECK_EQ(s_wakes, 12);
+    CHECK(actuator_service(&applied));
+    CHECK_EQ(gamepad_sim_output(&last), 2);
+    CHECK_EQ(last.rumble_strong, 0);
+    CHECK_EQ(last.rumble_weak, 0);
+    CHECK_EQ(last.player_leds, 0);
+
+    // Without a wake callback the caller polls
+    actuator_init(NULL);
+    CHECK(actuator_submit(report, sizeof(report)));
+    CHECK(actuator_service(&applied));
+    CHECK_EQ(gamepad_sim_output(&last), 1);
+    CHECK_EQ(last.rumble_strong, 200);
+}
+
+int main(void)
+{
+    RUN_TEST(test_parse_payload);
+    RUN_TEST(test_parse_report_id);
+    RUN_TEST(test_parse_lengths);
+    RUN_TEST(test_submit_and_apply);
+    RUN_TEST(test_newest_applied);
+    TEST_EXIT();
+}
@@ -0,0 +1,165 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "check.h"
+
+#include "axis_decimator.h"
+
+static const uint8_t s_channels[GAMEPAD_NUM_AXES] = {7, 6, 3, 0};
+
+static axis_decimator_t s_dec;
+
+static void latest(uint16_t raw[GAMEPAD_NUM_AXES])
+{
+    axis_decimator_latest(&s_dec, raw);
+}
+
+static void put_result(uint8_t *frame, uint8_t channel, uint16_t value)
+{
+    uint16_t word = (uint16_t)(channel << 12) | (value & 0x0FFF);
+    frame[0] = word & 0xFF;
+    frame[1] = word >> 8;
+}
+
+static void test_mid_until_first_average(void)
+{
+    uint16_t raw[GAMEPAD_NUM_AXES];
+
+    axis_decimator_init(&s_dec, s_channels, 4);
+    latest(raw);
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        CHECK_EQ(raw[i], AXIS_DECIMATOR_RAW_MID);
+    }
+
+    // Three of four conversions: nothing published yet
+    for (int n = 0; n < 3; n++)
+    {
+        axis_decimator_push(&s_dec, 7, 100);
+    }
+    latest(raw);
+    CHECK_EQ(raw[0], AXIS_DECIMATOR_RAW_MID);
+    axis_decimator_push(&s_dec, 7, 104);
+    latest(raw);
+    CHECK_EQ(raw[0], 101); // (100 * 3 + 104) / 4, truncated
+    CHECK_EQ(raw[1], AXIS_DECIMATOR_RAW_MID);
+}
+
+static void test_one_output_per_oversample(void)
+{
+    uint16_t raw[GAMEPAD_NUM_AXES];
+
+    axis_decimator_init(&s_dec, s_channels, 8);
+
+    // Each window is averaged on its own, the previous one is held in between
+    for (int window = 0; window < 4; window++)
+    {
+        for (int n = 0; n < 8; n++)
+        {
+            axis_decimator_push(&s_dec, 6, window * 1000 + n); // Mean window * 1000 + 3.5
+            latest(raw);
+            CHECK_EQ(raw[1], n < 7 ? (window ? (window - 1) * 1000 + 3 : AXIS_DECIMATOR_RAW_MID) : window * 1000 + 3);
+        }
+    }
+}
+
+static void test_interleaved_channels(void)
+{
+    uint16_t raw[GAMEPAD_NUM_AXES];
+
+    // The DMA frame interleaves the channels in pattern order; axes follow channels[], not channel number
+    axis_decimator_init(&s_dec, s_channels, 2);
+    for (int n = 0; n < 2; n++)
+    {
+        axis_decimator_push(&s_dec, 0, 4000 + n * 2);
+        axis_decimator_push(&s_dec, 3, 3000);
+        axis_decimator_push(&s_dec, 6, 2000);
+        axis_decimator_push(&s_dec, 7, 1000);
+    }
+    latest(raw);
+    CHECK_EQ(raw[0], 1000);
+    CHECK_EQ(raw[1], 2000);
+    CHECK_EQ(raw[2], 3000);
+    CHECK_EQ(raw[3], 4001);
+}
+
+static void test_unused_channels_ignored(void)
+{
+    uint16_t raw[GAMEPAD_NUM_AXES];
+
+    axis_decimator_init(&s_dec, s_channels, 1);
+    axis_decimator_push(&s_dec, 1, 5);
+    axis_decimator_push(&s_dec, 15, 5);
+    axis_decimator_push(&s_dec, 16, 5);
+    axis_decimator_push(&s_dec, 255, 5);
+    latest(raw);
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        CHECK_EQ(raw[i], AXIS_DECIMATOR_RAW_MID);
+    }
+
+    // A channel out of the 4-bit range in the table is left unmapped
+    const uint8_t channels[GAMEPAD_NUM_AXES] = {7, 6, 3, 16};
+    axis_decimator_init(&s_dec, channels, 1);
+    axis_decimator_push(&s_dec, 0, 5);
+    latest(raw);
+    CHECK_EQ(raw[3], AXIS_DECIMATOR_RAW_MID);
+}
+
+static void test_push_frame(void)
+{
+    uint8_t frame[2 * 9];
+    uint16_t raw[GAMEPAD_NUM_AXES];
+
+    axis_decimator_init(&s_dec, s_channels, 2);
+    put_result(&frame[0], 7, 0x0FFF);
+    put_result(&frame[2], 6, 0x0123);
+    put_result(&frame[4], 7, 0x0FFD);
+    put_result(&frame[6], 6, 0x0125);
+    put_result(&frame[8], 5, 0x0FFF); // Not an axis
+    put_result(&frame[10], 3, 10);
+    put_result(&frame[12], 3, 20);
+    put_result(&frame[14], 0, 30);
+    put_result(&frame[16], 0, 40);
+    // A trailing odd byte is not a result
+    axis_decimator_push_frame(&s_dec, frame, sizeof(frame) - 1);
+    latest(raw);
+    CHECK_EQ(raw[0], 0x0FFE);
+    CHECK_EQ(raw[1], 0x0124);
+    CHECK_EQ(raw[2], 15);
+    CHECK_EQ(raw[3], AXIS_DECIMATOR_RAW_MID);
+    axis_decimator_push_frame(&s_dec, &frame[16], 2);
+    latest(raw);
+    CHECK_EQ(raw[3], 35);
+}
+
+static void test_oversample_limits(void)
+{
+    uint16_t raw[GAMEPAD_NUM_AXES];
+
+    // 0 behaves as 1: every conversion is published
+    axis_decimator_init(&s_dec, s_channels, 0);
+    axis_decimator_push(&s_dec, 7, 1234);
+    latest(raw);
+    CHECK_EQ(raw[0], 1234);
+
+    // The largest menuconfig oversample of full-scale readings doesn't overflow the sum
+    axis_decimator_init(&s_dec, s_channels, 256);
+    for (int n = 0; n < 256; n++)
+    {
+        axis_decimator_push(&s_dec, 7, 0x0FFF);
+    }
+    latest(raw);
+    CHECK_EQ(raw[0], 0x0FFF);
+}
+
+int main(void)
+{
+    RUN_TEST(test_mid_until_first_average);
+    RUN_TEST(test_one_output_per_oversample);
+    RUN_TEST(test_interleaved_channels);
+    RUN_TEST(test_unused_channels_ignored);
+    RUN_TEST(test_push_frame);
+    RUN_TEST(test_oversample_limits);
+    TEST_EXIT();
+}
@@ -0,0 +1,258 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// The adaptive stick filter against a floating-point One-Euro reference: it tracks the
+// reference on noisy and step signals, removes the jitter of a resting stick, and adds
+// no more step lag than the reference does. Residual jitter and lag are printed.
+#include <math.h>
+#include <stdlib.h>
+
+#include "check.h"
+
+#include "axis_filter.h"
+
+#define CENTER_RAW 2048
+#define STEP_RAW 3800
+#define SAMPLE_US 1000
+#define NOISE_SEED 0x0e1e0e1eu
+#define NOISE_LSB 8 // Uniform ADC noise of +-NOISE_LSB
+
+// The menuconfig defaults
+static const axis_filter_config_t s_config = {
+    .min_cutoff_mhz = CONFIG_GAMEPAD_STICK_FILTER_MIN_CUTOFF_MHZ,
+    .beta = CONFIG_GAMEPAD_STICK_FILTER_BETA,
+};
+
+typedef struct
+{
+    bool started;
+    double value;
+    double speed;
+} reference_t;
+
+static double reference_alpha(double cutoff_hz, double dt_s)
+{
+    double r = 2 * M_PI * cutoff_hz * dt_s;
+    return r / (1 + r);
+}
+
+// One-Euro with the speed taken against the previous output, smoothed at 1 Hz
+static double reference_apply(reference_t *ref, const axis_filter_config_t *config, double x, double dt_s)
+{
+    if (!ref->started)
+    {
+        ref->started = true;
+        ref->value = x;
+        return x;
+    }
+    ref->speed += ((x - ref->value) / dt_s - ref->speed) * reference_alpha(1.0, dt_s);
+    double cutoff_hz = (config->min_cutoff_mhz + config->beta * fabs(ref->speed) / 1000) / 1000;
+    if (cutoff_hz > 1000)
+    {
+        cutoff_hz = 1000;
+    }
+    ref->value += (x - ref->value) * reference_alpha(cutoff_hz, dt_s);
+    return ref->value;
+}
+
+static uint16_t noisy(uint32_t *seed, int value)
+{
+    return (uint16_t)(value + (int)(test_rand(seed) % (2 * NOISE_LSB + 1)) - NOISE_LSB);
+}
+
+// Filter one value on axis 0, the other axes held at the centre
+static uint16_t apply_one(axis_filter_t *filter, uint16_t x, uint32_t now_us)
+{
+    uint16_t raw[GAMEPAD_NUM_AXES];
+
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        raw[i] = CENTER_RAW;
+    }
+    raw[0] = x;
+    axis_filter_apply(filter, raw, now_us);
+    for (int i = 1; i < GAMEPAD_NUM_AXES; i++)
+    {
+        CHECK_EQ(raw[i], CENTER_RAW);
+    }
+    return raw[0];
+}
+
+static void test_first_sample_passes(void)
+{
+    axis_filter_t filter;
+    uint16_t raw[GAMEPAD_NUM_AXES] = {0, 1000, 3000, 4095};
+
+    axis_filter_init(&filter, &s_config);
+    axis_filter_apply(&filter, raw, 12345);
+    CHECK_EQ(raw[0], 0);
+    CHECK_EQ(raw[1], 1000);
+    CHECK_EQ(raw[2], 3000);
+    CHECK_EQ(raw[3], 4095);
+}
+
+// Noise around a slow sweep, then steps both ways, against the reference the whole time
+static void test_tracks_reference(void)
+{
+    axis_filter_t filter;
+    reference_t ref = {0};
+    uint32_t seed = NOISE_SEED;
+    int worst = 0;
+
+    axis_filter_init(&filter, &s_config);
+    for (int i = 0; i < 6000; i++)
+    {
+        int value = i < 2000 ? CENTER_RAW + i / 4 : i < 4000 ? STEP_RAW : 500;
+        uint16_t x = noisy(&seed, value);
+        int out = apply_one(&filter, x, (uint32_t)i * SAMPLE_US);
+        double expected = reference_apply(&ref, &s_config, x, SAMPLE_US / 1e6);
+        int error = (int)fabs(out - expected);
+        if (error > worst)
+        {
+            worst = error;
+        }
+    }
+    printf("  largest difference from the reference %d LSB\n", worst);
+    CHECK(worst <= 2);
+}
+
+// Peak-to-peak and RMS of the output around CENTER_RAW, after a second to settle
+static void measure_jitter(const axis_filter_config_t *config, int *filter_pp, double *filter_rms, int *raw_pp)
+{
+    axis_filter_t filter;
+    uint32_t seed = NOISE_SEED;
+    int lo = 65535, hi = 0, raw_lo = 65535, raw_hi = 0;
+    double sum_sq = 0;
+    int n = 0;
+
+    axis_filter_init(&filter, config);
+    for (int i = 0; i < 5000; i++)
+    {
+        uint16_t x = noisy(&seed, CENTER_RAW);
+        int out = apply_one(&filter, x, (uint32_t)i * SAMPLE_US);
+        if (i < 1000)
+        {
+            continue;
+        }
+        lo = out < lo ? out : lo;
+        hi = out > hi ? out : hi;
+        raw_lo = x < raw_lo ? x : raw_lo;
+        raw_hi = x > raw_hi ? x : raw_hi;
+        sum_sq += (double)(out - CENTER_RAW) * (out - CENTER_RAW);
+        n++;
+    }
+    *filter_pp = hi - lo;
+    *filter_rms = sqrt(sum_sq / n);
+    *raw_pp = raw_hi - raw_lo;
+}
+
+static void test_resting_jitter(void)
+{
+    int pp, raw_pp;
+    double rms;
+
+    measure_jitter(&s_config, &pp, &rms, &raw_pp);
+    printf("  resting stick: raw %d LSB peak-to-peak, filtered %d LSB, %.2f LSB RMS\n", raw_pp, pp, rms);
+    CHECK_EQ(raw_pp, 2 * NOISE_LSB);
+    CHECK(pp <= 2);
+    CHECK(rms < 1.0);
+
+    // A higher cutoff at rest lets more through
+    axis_filter_config_t loose = s_config;
+    int loose_pp;
+    loose.min_cutoff_mhz *= 20;
+    measure_jitter(&loose, &loose_pp, &rms, &raw_pp);
+    CHECK(loose_pp > pp);
+}
+
+// Samples until the output is within tolerance of a clean step from CENTER_RAW to target
+static int step_lag_samples(const axis_filter_config_t *config, int target, int tolerance, bool reference)
+{
+    axis_filter_t filter;
+    reference_t ref = {0};
+
+    axis_filter_init(&filter, config);
+    for (int i = 0; i < 1000; i++)
+    {
+        apply_one(&filter, CENTER_RAW, (uint32_t)i * SAMPLE_US);
+        reference_apply(&ref, config, CENTER_RAW, SAMPLE_US / 1e6);
+    }
+    for (int i = 1000; i < 3000; i++)
+    {
+        double out = reference ? reference_apply(&ref, config, target, SAMPLE_US / 1e6)
+                               : apply_one(&filter, (uint16_t)target, (uint32_t)i * SAMPLE_US);
+        if (fabs(out - target) <= tolerance)
+        {
+            return i - 1000 + 1;
+        }
+    }
+    return -1;
+}
+
+static void test_step_lag(void)
+{
+    int tolerance = (STEP_RAW - CENTER_RAW) / 10; // Within 10% of the step
+    int lag = step_lag_samples(&s_config, STEP_RAW, tolerance, false);
+    int ref_lag = step_lag_samples(&s_config, STEP_RAW, tolerance, true);
+    int down_lag = step_lag_samples(&s_config, 500, (CENTER_RAW - 500) / 10, false);
+
+    printf("  90%% of a %d LSB step after %d ms (reference %d ms), down %d ms\n", STEP_RAW - CENTER_RAW,
+           lag * SAMPLE_US / 1000, ref_lag * SAMPLE_US / 1000, down_lag * SAMPLE_US / 1000);
+    CHECK(lag > 0 && lag <= ref_lag + 1);
+    CHECK(down_lag > 0 && down_lag <= ref_lag + 1);
+    CHECK(lag * SAMPLE_US <= 10000); // A fast flick is reported within 10 ms
+
+    // Without the speed term the same step lags far behind: that is what beta buys
+    axis_filter_config_t fixed = s_config;
+    fixed.beta = 0;
+    int fixed_lag = step_lag_samples(&fixed, STEP_RAW, tolerance, false);
+    int fixed_ref_lag = step_lag_samples(&fixed, STEP_RAW, tolerance, true);
+    CHECK(fixed_lag > 10 * lag);
+    CHECK(abs(fixed_lag - fixed_ref_lag) <= 1);
+}
+
+static void test_timing(void)
+{
+    axis_filter_t filter;
+    axis_filter_t slow;
+
+    // No time passed: the last output again, and the next sample filters as usual
+    axis_filter_init(&filter, &s_config);
+    apply_one(&filter, CENTER_RAW, 0);
+    uint16_t out = apply_one(&filter, STEP_RAW, 1000);
+    CHECK(out > CENTER_RAW && out < STEP_RAW);
+    CHECK_EQ(apply_one(&filter, 0, 1000), out);
+    CHECK(apply_one(&filter, STEP_RAW, 2000) > out);
+
+    // A long gap counts as one second: most of the way there in one step, no overflow
+    axis_filter_init(&slow, &s_config);
+    apply_one(&slow, CENTER_RAW, 0);
+    out = apply_one(&slow, STEP_RAW, 50000000);
+    CHECK(out > STEP_RAW - (STEP_RAW - CENTER_RAW) / 10 && out <= STEP_RAW);
+
+    // The clock wrapping is a normal step forward
+    axis_filter_init(&slow, &s_config);
+    apply_one(&slow, CENTER_RAW, 0xffffffff - 499);
+    CHECK_EQ(apply_one(&slow, CENTER_RAW, 500), CENTER_RAW);
+
+    // A slower sample period covers the same time in fewer, bigger steps
+    reference_t ref = {0};
+    axis_filter_init(&slow, &s_config);
+    for (int i = 0; i <= 100; i++)
+    {
+        int x = i == 0 ? CENTER_RAW : STEP_RAW;
+        int got = apply_one(&slow, (uint16_t)x, (uint32_t)i * 8000);
+        double expected = reference_apply(&ref, &s_config, x, 8000 / 1e6);
+        CHECK(fabs(got - expected) <= 2);
+    }
+}
+
+int main(void)
+{
+    RUN_TEST(test_first_sample_passes);
+    RUN_TEST(test_tracks_reference);
+    RUN_TEST(test_resting_jitter);
+    RUN_TEST(test_step_lag);
+    RUN_TEST(test_timing);
+    TEST_EXIT();
+}
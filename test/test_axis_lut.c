@@ -0,0 +1,141 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// The integer calibration tables against the same mapping done in double precision,
+// for every raw reading.
+#include "check.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "axis_calibration.h"
+
+// Largest difference from the float model, in report units (of 32767). Scaling rounds to
+// within 0.5, which the curve multiplies by its slope at full scale (2 or 3); each
+// truncating division in the curve adds up to 1 more.
+#define LINEAR_MAX_ERROR 0.5
+#define QUADRATIC_MAX_ERROR 2.0
+#define CUBIC_MAX_ERROR 3.5
+
+static double model(int raw, const axis_calibration_t *cal, axis_curve_t curve)
+{
+    double n = raw >= cal->center ? (double)(raw - cal->center) / (cal->max - cal->center)
+                                  : (double)(raw - cal->center) / (cal->center - cal->min);
+
+    n = fmax(-1.0, fmin(1.0, n));
+    switch (curve)
+    {
+    case AXIS_CURVE_QUADRATIC:
+        n = n * fabs(n);
+        break;
+    case AXIS_CURVE_CUBIC:
+        n = n * n * n;
+        break;
+    default:
+        break;
+    }
+    return n * AXIS_OUT_MAX;
+}
+
+static double max_error(const axis_calibration_t *cal, axis_curve_t curve)
+{
+    static int16_t lut[AXIS_LUT_SIZE];
+    double worst = 0;
+
+    axis_lut_build(lut, cal, curve);
+    for (int raw = 0; raw <= AXIS_RAW_MAX; raw++)
+    {
+        double error = fabs(axis_lut_apply(lut, raw) - model(raw, cal, curve));
+        if (error > worst)
+        {
+            worst = error;
+        }
+        // Never past full scale, and never decreasing
+        CHECK(abs(lut[raw]) <= AXIS_OUT_MAX);
+        CHECK(raw == 0 || lut[raw] >= lut[raw - 1]);
+    }
+    return worst;
+}
+
+static void check_calibration(uint16_t min, uint16_t center, uint16_t max)
+{
+    axis_calibration_t cal = {.min = min, .center = center, .max = max};
+    double linear = max_error(&cal, AXIS_CURVE_LINEAR);
+    double quadratic = max_error(&cal, AXIS_CURVE_QUADRATIC);
+    double cubic = max_error(&cal, AXIS_CURVE_CUBIC);
+
+    printf("  %4u/%4u/%4u: max error %.3f linear, %.3f quadratic, %.3f cubic\n", min, center, max, linear,
+           quadratic, cubic);
+    CHECK(axis_calibration_valid(&cal));
+    CHECK(linear <= LINEAR_MAX_ERROR);
+    CHECK(quadratic <= QUADRATIC_MAX_ERROR);
+    CHECK(cubic <= CUBIC_MAX_ERROR);
+}
+
+static void test_default(void)
+{
+    axis_calibration_t cal;
+
+    axis_calibration_default(&cal);
+    check_calibration(cal.min, cal.center, cal.max);
+}
+
+static void test_off_center(void)
+{
+    check_calibration(300, 1900, 3800);
+    check_calibration(0, 3000, 4095);
+    check_calibration(1000, 1256, 1512); // Narrowest valid range: 256 counts per side
+    check_calibration(3583, 3839, 4095);
+}
+
+static void test_random_calibrations(void)
+{
+    uint32_t rng = 5;
+
+    for (int i = 0; i < 200; i++)
+    {
+        uint16_t center = 256 + test_rand(&rng) % (AXIS_RAW_MAX - 511);
+        uint16_t min = test_rand(&rng) % (center - 255);
+        uint16_t max = center + 256 + test_rand(&rng) % (AXIS_RAW_MAX - center - 255);
+        axis_calibration_t cal = {.min = min, .center = center, .max = max};
+
+        CHECK(max_error(&cal, AXIS_CURVE_LINEAR) <= LINEAR_MAX_ERROR);
+        CHECK(max_error(&cal, AXIS_CURVE_QUADRATIC) <= QUADRATIC_MAX_ERROR);
+        CHECK(max_error(&cal, AXIS_CURVE_CUBIC) <= CUBIC_MAX_ERROR);
+    }
+}
+
+static void test_deadzone_model(void)
+{
+    const int32_t radii[] = {0, 1, 1024, 8000, AXIS_OUT_MAX};
+
+    // Integer squares against hypot(), including full-scale diagonals where the sum of squares is largest
+    for (size_t r = 0; r < sizeof(radii) / sizeof(radii[0]); r++)
+    {
+        for (int32_t x = -AXIS_OUT_MAX; x <= AXIS_OUT_MAX; x += 257)
+        {
+            for (int32_t y = -AXIS_OUT_MAX; y <= AXIS_OUT_MAX; y += 263)
+            {
+                int16_t dx = x, dy = y;
+                bool inside = hypot(x, y) < radii[r];
+
+                stick_radial_deadzone(&dx, &dy, radii[r]);
+                CHECK_EQ(dx, inside ? 0 : x);
+                CHECK_EQ(dy, inside ? 0 : y);
+            }
+        }
+    }
+    int16_t x = AXIS_OUT_MAX, y = -AXIS_OUT_MAX;
+    stick_radial_deadzone(&x, &y, AXIS_OUT_MAX);
+    CHECK_EQ(x, AXIS_OUT_MAX);
+    CHECK_EQ(y, -AXIS_OUT_MAX);
+}
+
+int main(void)
+{
+    RUN_TEST(test_default);
+    RUN_TEST(test_off_center);
+    RUN_TEST(test_random_calibrations);
+    RUN_TEST(test_deadzone_model);
+    TEST_EXIT();
+}
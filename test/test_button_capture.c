@@ -0,0 +1,158 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// Direct-wired buttons over a scripted GPIO bank: a pin edge through the capture,
+// debouncer and scheduler into the packed report. Built once per capture mode.
+#include "check.h"
+
+#include "esp_timer.h"
+
+#include "button_capture.h"
+#include "button_debounce.h"
+#include "fake_gpio_port.h"
+#include "gamepad_report.h"
+#include "report_scheduler.h"
+
+#define RELEASE_SAMPLES 5
+
+static const int s_pins[GAMEPAD_NUM_BUTTONS] = {
+#define BUTTON_PIN(name, gpio) gpio,
+    GAMEPAD_BUTTON_LIST(BUTTON_PIN)
+#undef BUTTON_PIN
+};
+
+static button_debounce_t s_debounce;
+static report_scheduler_t s_sched;
+static gamepad_buttons_t s_buttons;
+
+static bool report_has_button(const uint8_t *report, int button)
+{
+    return report[GAMEPAD_REPORT_BUTTONS_OFFSET / 8 + button / 8] & (1U << (button % 8));
+}
+
+// One pass of the input task's button handling at now_us, returns the report reason
+static report_send_reason_t sample(int64_t now_us, uint32_t *first_edge_us, uint8_t *report)
+{
+    gamepad_state_t state = {0};
+
+    esp_timer_fake_set(now_us);
+    if (button_capture_take_edges(first_edge_us) || button_debounce_busy(&s_debounce))
+    {
+        s_buttons = button_debounce_update(&s_debounce, button_capture_read());
+    }
+    state.buttons = s_buttons;
+    report_send_reason_t reason = report_scheduler_update(&s_sched, &state, now_us);
+    gamepad_report_pack(&state, report);
+    return reason;
+}
+
+static void test_init(void)
+{
+    uint32_t first_edge_us;
+    uint8_t report[GAMEPAD_REPORT_SIZE];
+
+    esp_timer_fake_set(0);
+    button_capture_init();
+    for (int i = 0; i < GAMEPAD_NUM_BUTTONS; i++)
+    {
+        CHECK(fake_gpio_is_input(s_pins[i]));
+        CHECK_EQ(fake_gpio_has_edge_cb(s_pins[i]), CONFIG_GAMEPAD_BUTTON_CAPTURE_INTERRUPT);
+    }
+
+    report_scheduler_config_t config = {.axis_deadband = 256, .keepalive_ms = 1000, .min_interval_us = 4000};
+    report_scheduler_init(&s_sched, &config);
+    button_debounce_init(&s_debounce, RELEASE_SAMPLES);
+
+    // Every pin is read on the first pass; all pulled up, nothing pressed
+    CHECK_EQ(sample(0, &first_edge_us, report), REPORT_SEND_FIRST);
+    CHECK_EQ(s_buttons, 0);
+    CHECK_EQ(sample(1000, &first_edge_us, report), REPORT_SEND_NONE);
+}
+
+static void test_press_reaches_report(void)
+{
+    uint32_t first_edge_us;
+    uint8_t report[GAMEPAD_REPORT_SIZE];
+    unsigned notifications = fake_gpio_notifications();
+
+    esp_timer_fake_set(2000);
+    fake_gpio_set(s_pins[GAMEPAD_BUTTON_A], false);
+    esp_timer_fake_set(2100);
+    fake_gpio_set(s_pins[GAMEPAD_BUTTON_DPAD_UP], false);
+    CHECK_EQ(fake_gpio_notifications(), notifications + 2 * CONFIG_GAMEPAD_BUTTON_CAPTURE_INTERRUPT);
+
+    CHECK_EQ(sample(2250, &first_edge_us, report), REPORT_SEND_BUTTONS);
+#if CONFIG_GAMEPAD_BUTTON_CAPTURE_INTERRUPT
+    CHECK_EQ(first_edge_us, 2000); // Timed from the first of the two edges
+    CHECK_EQ(button_capture_take_edges(&first_edge_us), 0);
+    CHECK_EQ(first_edge_us, 2250); // Nothing pending: now
+#else
+    CHECK_EQ(first_edge_us, 2250); // Polling: the sample itself
+#endif
+    CHECK(report_has_button(report, GAMEPAD_BUTTON_A));
+    CHECK(report_has_button(report, GAMEPAD_BUTTON_DPAD_UP));
+    CHECK(!report_has_button(report, GAMEPAD_BUTTON_B));
+}
+
+static void test_release_after_stable_samples(void)
+{
+    uint32_t first_edge_us;
+    uint8_t report[GAMEPAD_REPORT_SIZE];
+    int64_t now_us = 10000;
+
+    esp_timer_fake_set(now_us);
+    fake_gpio_set(s_pins[GAMEPAD_BUTTON_A], true);
+
+    // The release is held back for RELEASE_SAMPLES reads; the debouncer keeps the task
+    // reading without further edges
+    for (int i = 1; i < RELEASE_SAMPLES; i++)
+    {
+        now_us += 1000;
+        CHECK_EQ(sample(now_us, &first_edge_us, report), REPORT_SEND_NONE);
+        CHECK(report_has_button(report, GAMEPAD_BUTTON_A));
+    }
+    now_us += 1000;
+    CHECK_EQ(sample(now_us, &first_edge_us, report), REPORT_SEND_BUTTONS);
+    CHECK(!report_has_button(report, GAMEPAD_BUTTON_A));
+    CHECK(report_has_button(report, GAMEPAD_BUTTON_DPAD_UP));
+}
+
+static void test_second_input_register(void)
+{
+    uint32_t first_edge_us;
+    uint8_t report[GAMEPAD_REPORT_SIZE];
+
+    // GPIO 32 and up come from the second input register
+    CHECK(s_pins[GAMEPAD_BUTTON_LEFT_JOYSTICK_BUTTON] >= 32);
+    esp_timer_fake_set(30000);
+    fake_gpio_set(s_pins[GAMEPAD_BUTTON_LEFT_JOYSTICK_BUTTON], false);
+    CHECK_EQ(sample(30500, &first_edge_us, report), REPORT_SEND_BUTTONS);
+    CHECK(report_has_button(report, GAMEPAD_BUTTON_LEFT_JOYSTICK_BUTTON));
+#if CONFIG_GAMEPAD_BUTTON_CAPTURE_INTERRUPT
+    CHECK_EQ(first_edge_us, 30000);
+#endif
+}
+
+static void test_other_pins_ignored(void)
+{
+    uint32_t first_edge_us;
+    uint8_t report[GAMEPAD_REPORT_SIZE];
+    unsigned notifications = fake_gpio_notifications();
+
+    // GPIO 0 is not a button: no wake-up and nothing in the report
+    CHECK(!fake_gpio_is_input(0));
+    fake_gpio_set(0, false);
+    CHECK_EQ(fake_gpio_notifications(), notifications);
+    CHECK_EQ(sample(40000, &first_edge_us, report), REPORT_SEND_NONE);
+    fake_gpio_set(0, true);
+}
+
+int main(void)
+{
+    RUN_TEST(test_init);
+    RUN_TEST(test_press_reaches_report);
+    RUN_TEST(test_release_after_stable_samples);
+    RUN_TEST(test_second_input_register);
+    RUN_TEST(test_other_pins_ignored);
+    TEST_EXIT();
+}
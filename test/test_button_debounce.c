@@ -0,0 +1,132 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// The bit-parallel debouncer against a per-button counter model (debounce_model.h):
+// fixed press, release and chatter sequences, then random chatter on every button for
+// each supported release count. Built for the GPIO buttons and a 64-input chain.
+#include "check.h"
+
+#include "button_debounce.h"
+#include "debounce_model.h"
+
+#define A ((gamepad_buttons_t)1 << 0)
+#define B ((gamepad_buttons_t)1 << 1)
+#define LAST ((gamepad_buttons_t)1 << (GAMEPAD_NUM_BUTTONS - 1))
+#define RANDOM_SAMPLES 20000
+
+static void test_press_immediate(void)
+{
+    button_debounce_t db;
+
+    button_debounce_init(&db, 5);
+    CHECK_EQ(button_debounce_update(&db, 0), 0);
+    CHECK(!button_debounce_busy(&db));
+
+    // A press, on any button up to the last one, shows on the very first sample
+    CHECK_EQ(button_debounce_update(&db, A | LAST), A | LAST);
+    CHECK(!button_debounce_busy(&db));
+    CHECK_EQ(button_debounce_update(&db, A | B | LAST), A | B | LAST);
+}
+
+static void test_release_after_stable_samples(void)
+{
+    for (unsigned n = 1; n <= BUTTON_DEBOUNCE_MAX_SAMPLES; n++)
+    {
+        button_debounce_t db;
+
+        button_debounce_init(&db, n);
+        button_debounce_update(&db, A | LAST);
+        for (unsigned i = 1; i < n; i++)
+        {
+            CHECK_EQ(button_debounce_update(&db, A), A | LAST);
+            CHECK(button_debounce_busy(&db)); // Keeps the task sampling without edges
+        }
+        CHECK_EQ(button_debounce_update(&db, A), A); // Released on sample n
+        CHECK(!button_debounce_busy(&db));
+    }
+
+    // Counts outside 1..7 are clamped
+    button_debounce_t db;
+    button_debounce_init(&db, 0);
+    button_debounce_update(&db, A);
+    CHECK_EQ(button_debounce_update(&db, 0), 0);
+    button_debounce_init(&db, 100);
+    button_debounce_update(&db, A);
+    for (int i = 1; i < BUTTON_DEBOUNCE_MAX_SAMPLES; i++)
+    {
+        CHECK_EQ(button_debounce_update(&db, 0), A);
+    }
+    CHECK_EQ(button_debounce_update(&db, 0), 0);
+}
+
+static void test_chatter(void)
+{
+    button_debounce_t db;
+
+    button_debounce_init(&db, 5);
+    button_debounce_update(&db, A);
+
+    // A release that bounces back restarts the count: no extra transitions
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK_EQ(button_debounce_update(&db, 0), A);
+    }
+    CHECK_EQ(button_debounce_update(&db, A), A);
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK_EQ(button_debounce_update(&db, 0), A);
+    }
+    CHECK_EQ(button_debounce_update(&db, 0), 0);
+
+    // Buttons count independently: B chattering doesn't hold back A's release
+    button_debounce_update(&db, A | B);
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK_EQ(button_debounce_update(&db, i % 2 ? B : 0), A | B);
+    }
+    CHECK_EQ(button_debounce_update(&db, 0), B);
+}
+
+static void test_random_against_model(void)
+{
+    uint32_t seed = 0x2545F491;
+
+    for (unsigned n = 1; n <= BUTTON_DEBOUNCE_MAX_SAMPLES; n++)
+    {
+        button_debounce_t db;
+        debounce_model_t model;
+        int mismatches = 0;
+
+        button_debounce_init(&db, n);
+        debounce_model_init(&model, n);
+        gamepad_buttons_t raw = 0;
+        for (int i = 0; i < RANDOM_SAMPLES; i++)
+        {
+            // Each button flips with probability 1/4: long holds, short bounces and everything between
+            gamepad_buttons_t flips = 0;
+            for (int b = 0; b < GAMEPAD_NUM_BUTTONS; b++)
+            {
+                if ((test_rand(&seed) & 3) == 0)
+                {
+                    flips |= (gamepad_buttons_t)1 << b;
+                }
+            }
+            raw ^= flips;
+            if (button_debounce_update(&db, raw) != debounce_model_update(&model, raw) ||
+                button_debounce_busy(&db) != debounce_model_busy(&model))
+            {
+                mismatches++;
+            }
+        }
+        CHECK_EQ(mismatches, 0);
+    }
+}
+
+int main(void)
+{
+    RUN_TEST(test_press_immediate);
+    RUN_TEST(test_release_after_stable_samples);
+    RUN_TEST(test_chatter);
+    RUN_TEST(test_random_against_model);
+    TEST_EXIT();
+}
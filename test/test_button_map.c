@@ -0,0 +1,134 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "check.h"
+
+#include <string.h>
+
+#include "button_map.h"
+#include "gamepad_inputs.h"
+
+#define ROUNDS 100000
+
+static const int s_pins[GAMEPAD_NUM_NAMED_BUTTONS] = {
+#define BUTTON_PIN(name, gpio) gpio,
+    GAMEPAD_BUTTON_LIST(BUTTON_PIN)
+#undef BUTTON_PIN
+};
+
+static button_map_t s_map;
+
+// The straightforward version the tables replace: one register bit per button
+static uint16_t naive_remap(const int *pins, int count, uint32_t in0, uint32_t in1)
+{
+    uint16_t pressed = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        uint32_t level = pins[i] < 32 ? (in0 >> pins[i]) & 1 : (in1 >> (pins[i] - 32)) & 1;
+        if (!level)
+        {
+            pressed |= 1U << i;
+        }
+    }
+    return pressed;
+}
+
+static void build(const int *pins, int count)
+{
+    button_map_init(&s_map);
+    for (int i = 0; i < count; i++)
+    {
+        button_map_set(&s_map, i, pins[i]);
+    }
+}
+
+static void check_random(const int *pins, int count, uint32_t seed)
+{
+    uint32_t rng = seed;
+
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        uint32_t in0 = test_rand(&rng);
+        uint32_t in1 = test_rand(&rng) & 0xFF; // GPIO 32-39
+        if (button_map_apply(&s_map, in0, in1) != naive_remap(pins, count, in0, in1))
+        {
+            CHECK_EQ(button_map_apply(&s_map, in0, in1), naive_remap(pins, count, in0, in1));
+            return;
+        }
+    }
+}
+
+static void test_pin_table(void)
+{
+    build(s_pins, GAMEPAD_NUM_NAMED_BUTTONS);
+    CHECK_EQ(s_map.all_mask, (1U << GAMEPAD_NUM_NAMED_BUTTONS) - 1);
+    CHECK_EQ(button_map_apply(&s_map, 0xFFFFFFFF, 0xFF), 0); // All pulled up
+    CHECK_EQ(button_map_apply(&s_map, 0, 0), s_map.all_mask);
+    check_random(s_pins, GAMEPAD_NUM_NAMED_BUTTONS, 1);
+}
+
+static void test_single_pins(void)
+{
+    // Every pin the map covers, alone, in every button position
+    for (int pin = 0; pin < BUTTON_MAP_NUM_PINS; pin++)
+    {
+        for (int index = 0; index < BUTTON_MAP_MAX_BUTTONS; index += 5)
+        {
+            int pins[BUTTON_MAP_MAX_BUTTONS];
+            for (int i = 0; i < BUTTON_MAP_MAX_BUTTONS; i++)
+            {
+                pins[i] = (pin + 1 + i) % BUTTON_MAP_NUM_PINS;
+            }
+            pins[index] = pin;
+            build(pins, BUTTON_MAP_MAX_BUTTONS);
+            check_random(pins, BUTTON_MAP_MAX_BUTTONS, pin * 16 + index + 1);
+        }
+    }
+}
+
+static void test_random_tables(void)
+{
+    uint32_t rng = 12345;
+
+    // Random distinct pins for a random number of buttons
+    for (int table = 0; table < 64; table++)
+    {
+        int pins[BUTTON_MAP_MAX_BUTTONS];
+        int count = 1 + test_rand(&rng) % BUTTON_MAP_MAX_BUTTONS;
+        uint64_t used = 0;
+
+        for (int i = 0; i < count; i++)
+        {
+            do
+            {
+                pins[i] = test_rand(&rng) % BUTTON_MAP_NUM_PINS;
+            } while (used & (1ULL << pins[i]));
+            used |= 1ULL << pins[i];
+        }
+        build(pins, count);
+        CHECK_EQ(s_map.all_mask, (1U << count) - 1);
+        check_random(pins, count, table + 1);
+    }
+}
+
+static void test_out_of_range_ignored(void)
+{
+    build(s_pins, GAMEPAD_NUM_NAMED_BUTTONS);
+    button_map_t before = s_map;
+
+    button_map_set(&s_map, -1, 5);
+    button_map_set(&s_map, BUTTON_MAP_MAX_BUTTONS, 5);
+    button_map_set(&s_map, 0, -1);
+    button_map_set(&s_map, 0, BUTTON_MAP_NUM_PINS);
+    CHECK(memcmp(&before, &s_map, sizeof(s_map)) == 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_pin_table);
+    RUN_TEST(test_single_pins);
+    RUN_TEST(test_random_tables);
+    RUN_TEST(test_out_of_range_ignored);
+    TEST_EXIT();
+}
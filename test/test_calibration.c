@@ -0,0 +1,267 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// Stick calibration as the input task sees it: calibration_map with the default and a
+// captured calibration, the radial deadzone, and the calibration blob stored in NVS
+// (written by a capture, read back by calibration_init, rejected when it doesn't fit).
+#include "check.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "nvs.h"
+
+#include "axis_calibration.h"
+#include "calibration.h"
+
+#define COMBO_MASK ((1U << GAMEPAD_BUTTON_START) | (1U << GAMEPAD_BUTTON_MODE))
+#define CENTER_RAW 2048
+#define DEADZONE CONFIG_GAMEPAD_STICK_DEADZONE
+#define CAPTURED_CENTER_RAW 2000
+
+// The stored layout, as calibration.c writes it
+typedef struct
+{
+    uint8_t version;
+    axis_calibration_t axes[GAMEPAD_NUM_AXES];
+} stored_blob_t;
+
+static void set_raw(uint16_t raw[GAMEPAD_NUM_AXES], uint16_t value)
+{
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        raw[i] = value;
+    }
+}
+
+static void store_blob(const void *blob, size_t len)
+{
+    nvs_handle_t handle;
+
+    CHECK_EQ(nvs_open("gamepad", NVS_READWRITE, &handle), ESP_OK);
+    CHECK_EQ(nvs_set_blob(handle, "axis_cal", blob, len), ESP_OK);
+    nvs_close(handle);
+}
+
+static bool load_blob(stored_blob_t *blob)
+{
+    nvs_handle_t handle;
+    size_t len = sizeof(*blob);
+    esp_err_t ret;
+
+    if (nvs_open("gamepad", NVS_READONLY, &handle) != ESP_OK)
+    {
+        return false;
+    }
+    ret = nvs_get_blob(handle, "axis_cal", blob, &len);
+    nvs_close(handle);
+    return ret == ESP_OK && len == sizeof(*blob);
+}
+
+static uint16_t s_rest_raw = CENTER_RAW; // Every axis at rest under the calibration in use
+
+// Map one axis with every other axis at rest
+static int16_t map_one(int axis, uint16_t value)
+{
+    uint16_t raw[GAMEPAD_NUM_AXES];
+    int16_t axes[GAMEPAD_NUM_AXES];
+
+    set_raw(raw, s_rest_raw);
+    raw[axis] = value;
+    calibration_map(raw, axes);
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        if (i != axis)
+        {
+            CHECK_EQ(axes[i], 0);
+        }
+    }
+    return axes[axis];
+}
+
+static void test_defaults(void)
+{
+    nvs_fake_erase_all();
+    calibration_init(COMBO_MASK);
+
+    // Full 12-bit range, centred at mid-scale, on every axis
+    for (int axis = 0; axis < GAMEPAD_NUM_AXES; axis++)
+    {
+        CHECK_EQ(map_one(axis, 0), -AXIS_OUT_MAX);
+        CHECK_EQ(map_one(axis, AXIS_RAW_MAX), AXIS_OUT_MAX);
+        CHECK_EQ(map_one(axis, CENTER_RAW), 0);
+    }
+    CHECK_EQ(nvs_fake_writes(), 0); // Nothing stored until a capture
+}
+
+static void test_radial_deadzone(void)
+{
+    uint16_t raw[GAMEPAD_NUM_AXES];
+    int16_t axes[GAMEPAD_NUM_AXES];
+
+    nvs_fake_erase_all();
+    calibration_init(COMBO_MASK);
+
+    // One default raw count is 16 report units; 60 counts is inside the deadzone on one axis
+    set_raw(raw, CENTER_RAW);
+    raw[0] = CENTER_RAW + 60;
+    calibration_map(raw, axes);
+    CHECK_EQ(axes[0], 0);
+    raw[0] = CENTER_RAW + 70;
+    calibration_map(raw, axes);
+    CHECK(axes[0] > DEADZONE);
+
+    // The zone is a circle: each axis alone would be inside it, together they are not
+    set_raw(raw, CENTER_RAW);
+    raw[0] = CENTER_RAW + 50;
+    raw[1] = CENTER_RAW - 50;
+    calibration_map(raw, axes);
+    CHECK(axes[0] > 0 && axes[0] < DEADZONE);
+    CHECK(axes[1] < 0 && axes[1] > -DEADZONE);
+    raw[0] = CENTER_RAW + 40;
+    raw[1] = CENTER_RAW - 40;
+    calibration_map(raw, axes);
+    CHECK_EQ(axes[0], 0);
+    CHECK_EQ(axes[1], 0);
+
+    // Each stick has its own zone
+    raw[2] = CENTER_RAW + 1000;
+    calibration_map(raw, axes);
+    CHECK_EQ(axes[0], 0);
+    CHECK(axes[2] > 0);
+    CHECK_EQ(axes[3], 0);
+}
+
+// Press and hold the combo, rest the sticks, then sweep them to [lo, hi]. Returns the time after the capture.
+static int64_t run_capture(int64_t now_us, uint16_t center, uint16_t lo, uint16_t hi)
+{
+    uint16_t raw[GAMEPAD_NUM_AXES];
+
+    set_raw(raw, center);
+    CHECK(!calibration_poll(raw, 0, now_us - 10000)); // Combo released before
+    for (int64_t end = now_us + CONFIG_GAMEPAD_CALIBRATION_HOLD_MS * 1000; now_us < end; now_us += 10000)
+    {
+        CHECK(!calibration_poll(raw, COMBO_MASK, now_us));
+    }
+    CHECK(calibration_poll(raw, COMBO_MASK, now_us)); // Capture starts
+
+    // 1 s at rest, then 5 s of sweeps; reports are held back the whole time
+    for (int64_t end = now_us + 6000000; now_us < end; now_us += 10000)
+    {
+        if (now_us > end - 5000000)
+        {
+            set_raw(raw, (now_us / 10000) % 2 ? lo : hi);
+        }
+        CHECK(calibration_poll(raw, 0, now_us));
+    }
+    CHECK(!calibration_poll(raw, 0, now_us)); // Done
+    return now_us;
+}
+
+static void test_capture_saves_and_loads(void)
+{
+    stored_blob_t blob;
+
+    nvs_fake_erase_all();
+    calibration_init(COMBO_MASK);
+
+    // Releasing the combo early starts nothing
+    uint16_t raw[GAMEPAD_NUM_AXES];
+    set_raw(raw, CENTER_RAW);
+    CHECK(!calibration_poll(raw, COMBO_MASK, 0));
+    CHECK(!calibration_poll(raw, COMBO_MASK, CONFIG_GAMEPAD_CALIBRATION_HOLD_MS * 1000 - 1));
+    CHECK(!calibration_poll(raw, 1U << GAMEPAD_BUTTON_START, CONFIG_GAMEPAD_CALIBRATION_HOLD_MS * 1000));
+    CHECK(!calibration_poll(raw, COMBO_MASK, CONFIG_GAMEPAD_CALIBRATION_HOLD_MS * 1000 + 1));
+
+    run_capture(10000000, CAPTURED_CENTER_RAW, 500, 3500);
+    s_rest_raw = CAPTURED_CENTER_RAW;
+
+    // Used straight away and stored once
+    CHECK_EQ(map_one(0, CAPTURED_CENTER_RAW), 0);
+    CHECK_EQ(map_one(0, 500), -AXIS_OUT_MAX);
+    CHECK_EQ(map_one(3, 3500), AXIS_OUT_MAX);
+    CHECK_EQ(map_one(1, 0), -AXIS_OUT_MAX); // Clamped past the captured range
+    CHECK_EQ(nvs_fake_writes(), 1);
+    CHECK_EQ(nvs_fake_commits(), 1);
+    CHECK(load_blob(&blob));
+    CHECK_EQ(blob.version, 1);
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        CHECK_EQ(blob.axes[i].min, 500);
+        CHECK_EQ(blob.axes[i].center, CAPTURED_CENTER_RAW);
+        CHECK_EQ(blob.axes[i].max, 3500);
+    }
+
+    // The next boot decodes the same blob
+    calibration_init(COMBO_MASK);
+    CHECK_EQ(map_one(2, CAPTURED_CENTER_RAW), 0);
+    CHECK_EQ(map_one(2, 500), -AXIS_OUT_MAX);
+    CHECK_EQ(map_one(2, 3500), AXIS_OUT_MAX);
+    CHECK_EQ(map_one(2, AXIS_RAW_MAX), AXIS_OUT_MAX);
+    s_rest_raw = CENTER_RAW;
+}
+
+static void test_failed_capture_keeps_previous(void)
+{
+    nvs_fake_erase_all();
+    calibration_init(COMBO_MASK);
+
+    // Sticks barely moved: nothing changes and nothing is stored
+    run_capture(0, CENTER_RAW, CENTER_RAW - 100, CENTER_RAW + 100);
+    CHECK_EQ(nvs_fake_writes(), 0);
+    CHECK_EQ(map_one(0, 0), -AXIS_OUT_MAX);
+    CHECK_EQ(map_one(0, AXIS_RAW_MAX), AXIS_OUT_MAX);
+}
+
+static void test_bad_blobs_ignored(void)
+{
+    stored_blob_t blob = {.version = 1};
+
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        blob.axes[i] = (axis_calibration_t){.min = 1000, .center = CAPTURED_CENTER_RAW, .max = 3000};
+    }
+
+    // Sanity: the good blob is used
+    nvs_fake_erase_all();
+    store_blob(&blob, sizeof(blob));
+    calibration_init(COMBO_MASK);
+    s_rest_raw = CAPTURED_CENTER_RAW;
+    CHECK_EQ(map_one(0, 1000), -AXIS_OUT_MAX);
+    s_rest_raw = CENTER_RAW;
+
+    // Another version, a short blob and out-of-range values all fall back to the defaults
+    stored_blob_t bad = blob;
+    bad.version = 2;
+    store_blob(&bad, sizeof(bad));
+    calibration_init(COMBO_MASK);
+    CHECK(map_one(0, 1000) > -AXIS_OUT_MAX);
+    CHECK_EQ(map_one(0, 0), -AXIS_OUT_MAX);
+
+    store_blob(&blob, sizeof(blob) - 1);
+    calibration_init(COMBO_MASK);
+    CHECK_EQ(map_one(0, 0), -AXIS_OUT_MAX);
+
+    bad = blob;
+    bad.axes[3].max = AXIS_RAW_MAX + 1;
+    store_blob(&bad, sizeof(bad));
+    calibration_init(COMBO_MASK);
+    CHECK_EQ(map_one(0, 0), -AXIS_OUT_MAX);
+
+    bad = blob;
+    bad.axes[1].center = bad.axes[1].min + 10; // Too narrow below the centre
+    store_blob(&bad, sizeof(bad));
+    calibration_init(COMBO_MASK);
+    CHECK_EQ(map_one(0, 0), -AXIS_OUT_MAX);
+    CHECK_EQ(map_one(0, CENTER_RAW), 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_defaults);
+    RUN_TEST(test_radial_deadzone);
+    RUN_TEST(test_capture_saves_and_loads);
+    RUN_TEST(test_failed_capture_keeps_previous);
+    RUN_TEST(test_bad_blobs_ignored);
+    TEST_EXIT();
+}
@@ -0,0 +1,275 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// The settings feature report: encode/parse round trip, every field at and past its
+// limits, and a seeded random loop that checks config_block_parse against a reference
+// decoder written from the layout in config_block.h and the menuconfig ranges.
+#include <string.h>
+
+#include "check.h"
+
+#include "config_block.h"
+
+#define FUZZ_SEED 0x5eed1234u
+#define FUZZ_ROUNDS 200000
+
+// The menuconfig ranges, repeated here so a drifting limit in config_block.c shows up
+typedef struct
+{
+    int offset;
+    int size;
+    uint32_t min;
+    uint32_t max;
+} field_range_t;
+
+static const field_range_t s_fields[] = {
+    {4, 2, 0, 32767},       // axis deadband
+    {6, 2, 0, 60000},       // keepalive
+    {8, 4, 250, 100000},    // sample period
+    {12, 4, 1000, 100000},  // report interval
+    {16, 4, 100, 600000},   // idle timeout
+};
+#define NUM_FIELDS (sizeof(s_fields) / sizeof(s_fields[0]))
+
+static uint32_t get_field(const uint8_t *buf, const field_range_t *f)
+{
+    uint32_t v = 0;
+
+    for (int i = f->size - 1; i >= 0; i--)
+    {
+        v = (v << 8) | buf[f->offset + i];
+    }
+    return v;
+}
+
+static void put_field(uint8_t *buf, const field_range_t *f, uint32_t v)
+{
+    for (int i = 0; i < f->size; i++)
+    {
+        buf[f->offset + i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+// What config_block_parse should say about buf
+static config_block_status_t reference_status(const uint8_t *buf, uint16_t len)
+{
+    if (len != CONFIG_BLOCK_SIZE)
+    {
+        return CONFIG_BLOCK_ERR_LENGTH;
+    }
+    if (buf[0] != CONFIG_BLOCK_VERSION)
+    {
+        return CONFIG_BLOCK_ERR_VERSION;
+    }
+    if ((buf[1] & ~(CONFIG_BLOCK_FLAG_FIXED_RATE | CONFIG_BLOCK_FLAG_SAVE)) || buf[3] != 0)
+    {
+        return CONFIG_BLOCK_ERR_RANGE;
+    }
+    for (size_t i = 0; i < NUM_FIELDS; i++)
+    {
+        uint32_t v = get_field(buf, &s_fields[i]);
+        if (v < s_fields[i].min || v > s_fields[i].max)
+        {
+            return CONFIG_BLOCK_ERR_RANGE;
+        }
+    }
+    return CONFIG_BLOCK_OK;
+}
+
+static void good_block(uint8_t *buf)
+{
+    config_block_t cfg;
+
+    config_block_defaults(&cfg);
+    CHECK_EQ(config_block_encode(&cfg, buf), CONFIG_BLOCK_SIZE);
+}
+
+// Parse buf and check the result, the decoded fields, and that a rejected block leaves cfg alone
+static void check_parse(const uint8_t *buf, uint16_t len)
+{
+    config_block_t cfg, sentinel;
+    config_block_status_t expected = reference_status(buf, len);
+    bool save = false;
+
+    memset(&sentinel, 0xa5, sizeof(sentinel));
+    cfg = sentinel;
+    CHECK_EQ(config_block_parse(buf, len, &cfg, &save), expected);
+    if (expected != CONFIG_BLOCK_OK)
+    {
+        CHECK(memcmp(&cfg, &sentinel, sizeof(cfg)) == 0);
+        return;
+    }
+    CHECK_EQ(cfg.fixed_rate, (buf[1] & CONFIG_BLOCK_FLAG_FIXED_RATE) != 0);
+    CHECK_EQ(save, (buf[1] & CONFIG_BLOCK_FLAG_SAVE) != 0);
+    CHECK_EQ(cfg.axis_bits, sentinel.axis_bits); // Read-only, never taken from the host
+    CHECK_EQ(cfg.axis_deadband, get_field(buf, &s_fields[0]));
+    CHECK_EQ(cfg.keepalive_ms, get_field(buf, &s_fields[1]));
+    CHECK_EQ(cfg.sample_us, get_field(buf, &s_fields[2]));
+    CHECK_EQ(cfg.report_us, get_field(buf, &s_fields[3]));
+    CHECK_EQ(cfg.idle_timeout_ms, get_field(buf, &s_fields[4]));
+
+    // Encoding gives the block back, less the save flag and with our axis width
+    uint8_t again[CONFIG_BLOCK_SIZE];
+    CHECK_EQ(config_block_encode(&cfg, again), CONFIG_BLOCK_SIZE);
+    CHECK_EQ(again[1], buf[1] & CONFIG_BLOCK_FLAG_FIXED_RATE);
+    CHECK_EQ(again[2], cfg.axis_bits);
+    CHECK(memcmp(again + 4, buf + 4, CONFIG_BLOCK_SIZE - 4) == 0);
+}
+
+static void test_round_trip(void)
+{
+    config_block_t cfg = {
+        .fixed_rate = true,
+        .axis_bits = 16,
+        .axis_deadband = 300,
+        .keepalive_ms = 2500,
+        .sample_us = 1000,
+        .report_us = 4000,
+        .idle_timeout_ms = 5000,
+    };
+    config_block_t out = {.axis_bits = 8};
+    uint8_t buf[CONFIG_BLOCK_SIZE];
+    bool save = true;
+
+    CHECK_EQ(config_block_encode(&cfg, buf), CONFIG_BLOCK_SIZE);
+    CHECK_EQ(buf[0], CONFIG_BLOCK_VERSION);
+    CHECK_EQ(buf[1], CONFIG_BLOCK_FLAG_FIXED_RATE);
+    CHECK_EQ(buf[2], 16);
+    CHECK_EQ(buf[8], 0xe8); // 1000 little-endian
+    CHECK_EQ(buf[9], 0x03);
+    CHECK_EQ(config_block_parse(buf, sizeof(buf), &out, &save), CONFIG_BLOCK_OK);
+    CHECK(!save);
+    CHECK(out.fixed_rate);
+    CHECK_EQ(out.axis_bits, 8);
+    CHECK_EQ(out.axis_deadband, 300);
+    CHECK_EQ(out.keepalive_ms, 2500);
+    CHECK_EQ(out.sample_us, 1000);
+    CHECK_EQ(out.report_us, 4000);
+    CHECK_EQ(out.idle_timeout_ms, 5000);
+
+    // The defaults are a valid block
+    good_block(buf);
+    CHECK_EQ(reference_status(buf, sizeof(buf)), CONFIG_BLOCK_OK);
+    check_parse(buf, sizeof(buf));
+}
+
+static void test_length_and_version(void)
+{
+    uint8_t buf[CONFIG_BLOCK_SIZE + 2];
+
+    good_block(buf);
+    for (uint16_t len = 0; len < sizeof(buf); len++)
+    {
+        check_parse(buf, len);
+    }
+    for (int version = 0; version < 256; version++)
+    {
+        buf[0] = (uint8_t)version;
+        check_parse(buf, CONFIG_BLOCK_SIZE);
+    }
+}
+
+static void test_flags_and_reserved(void)
+{
+    uint8_t buf[CONFIG_BLOCK_SIZE];
+
+    for (int flags = 0; flags < 256; flags++)
+    {
+        good_block(buf);
+        buf[1] = (uint8_t)flags;
+        check_parse(buf, sizeof(buf));
+    }
+    for (int reserved = 0; reserved < 256; reserved++)
+    {
+        good_block(buf);
+        buf[3] = (uint8_t)reserved;
+        check_parse(buf, sizeof(buf));
+    }
+
+    // Whatever axis width the host writes back is accepted and ignored
+    good_block(buf);
+    buf[2] = 0xff;
+    check_parse(buf, sizeof(buf));
+}
+
+static void test_field_limits(void)
+{
+    uint8_t buf[CONFIG_BLOCK_SIZE];
+
+    for (size_t i = 0; i < NUM_FIELDS; i++)
+    {
+        const field_range_t *f = &s_fields[i];
+        uint32_t top = f->size == 2 ? 0xffff : 0xffffffff;
+        uint32_t values[] = {0, 1, f->min - 1, f->min, f->min + 1, f->max - 1, f->max, f->max + 1, top};
+
+        for (size_t v = 0; v < sizeof(values) / sizeof(values[0]); v++)
+        {
+            if (values[v] > top)
+            {
+                continue;
+            }
+            good_block(buf);
+            put_field(buf, f, values[v]);
+            check_parse(buf, sizeof(buf));
+        }
+    }
+}
+
+// Random blocks near the valid space: a good block with a few bytes, a field or the length
+// changed, so most of them get past the length and version checks
+static void test_random_blocks(void)
+{
+    uint32_t seed = FUZZ_SEED;
+    unsigned accepted = 0;
+
+    for (int round = 0; round < FUZZ_ROUNDS; round++)
+    {
+        uint8_t buf[CONFIG_BLOCK_SIZE + 4];
+        uint16_t len = CONFIG_BLOCK_SIZE;
+
+        good_block(buf);
+        memset(buf + CONFIG_BLOCK_SIZE, 0, sizeof(buf) - CONFIG_BLOCK_SIZE);
+        switch (test_rand(&seed) % 4)
+        {
+        case 0: // A few random bytes
+            for (uint32_t n = test_rand(&seed) % 3 + 1; n > 0; n--)
+            {
+                buf[test_rand(&seed) % CONFIG_BLOCK_SIZE] = (uint8_t)test_rand(&seed);
+            }
+            break;
+        case 1: // One field anywhere in its range, or just past it
+        {
+            const field_range_t *f = &s_fields[test_rand(&seed) % NUM_FIELDS];
+            uint32_t span = f->max - f->min + 3;
+            put_field(buf, f, f->min - 1 + test_rand(&seed) % span);
+            break;
+        }
+        case 2: // Every field random
+            for (size_t i = 0; i < NUM_FIELDS; i++)
+            {
+                put_field(buf, &s_fields[i], test_rand(&seed) % (s_fields[i].max + 2));
+            }
+            buf[1] = (uint8_t)(test_rand(&seed) % 4);
+            break;
+        default: // Another length
+            len = (uint16_t)(test_rand(&seed) % sizeof(buf));
+            break;
+        }
+        check_parse(buf, len);
+        accepted += reference_status(buf, len) == CONFIG_BLOCK_OK;
+    }
+
+    // The loop reached both sides of every check
+    CHECK(accepted > FUZZ_ROUNDS / 10);
+    CHECK(accepted < FUZZ_ROUNDS * 9 / 10);
+}
+
+int main(void)
+{
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_length_and_version);
+    RUN_TEST(test_flags_and_reserved);
+    RUN_TEST(test_field_limits);
+    RUN_TEST(test_random_blocks);
+    TEST_EXIT();
+}
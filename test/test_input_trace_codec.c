@@ -0,0 +1,358 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// The input recorder's block format: random sessions written across many blocks and
+// decoded back, the varint and zigzag encodings as they appear in a block, the
+// Fletcher-16 check rejecting damaged blocks, malformed records, and the timeline
+// that joins sessions recorded across reboots.
+#include <string.h>
+
+#include "check.h"
+
+#include "axis_calibration.h"
+#include "input_trace_codec.h"
+
+#define ROUND_TRIP_SEED 0x1ace5eedu
+#define ROUND_TRIP_FRAMES 20000
+#define MAX_BLOCKS 256
+#define KEYFRAME_ALL (0x80 | ((0x02 << GAMEPAD_NUM_AXES) - 1))
+
+static uint8_t s_blocks[MAX_BLOCKS][INPUT_TRACE_BLOCK_SIZE];
+static input_trace_frame_t s_in[ROUND_TRIP_FRAMES];
+static input_trace_frame_t s_out[ROUND_TRIP_FRAMES];
+static int s_out_count;
+
+static void collect(void *ctx, const input_trace_frame_t *frame)
+{
+    if (s_out_count < ROUND_TRIP_FRAMES)
+    {
+        s_out[s_out_count] = *frame;
+    }
+    s_out_count++;
+}
+
+static bool same_frame(const input_trace_frame_t *a, const input_trace_frame_t *b)
+{
+    return a->time_us == b->time_us && a->buttons == b->buttons && memcmp(a->axes, b->axes, sizeof(a->axes)) == 0;
+}
+
+// Reference Fletcher-16 over the records, as the header describes it
+static uint16_t fletcher16(const uint8_t *data, size_t len)
+{
+    uint32_t a = 0, b = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        a = (a + data[i]) % 255;
+        b = (b + a) % 255;
+    }
+    return (uint16_t)((b << 8) | a);
+}
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// One block holding the given frames, finished
+static uint16_t write_block(uint8_t *block, uint32_t seq, const input_trace_frame_t *frames, int count)
+{
+    input_trace_writer_t w;
+
+    input_trace_block_begin(&w, block, seq);
+    for (int i = 0; i < count; i++)
+    {
+        CHECK(input_trace_block_append(&w, &frames[i]));
+    }
+    input_trace_block_finish(&w);
+    return w.used;
+}
+
+static void test_round_trip(void)
+{
+    uint32_t seed = ROUND_TRIP_SEED;
+    input_trace_frame_t frame = {0};
+    input_trace_writer_t w;
+    int blocks = 0;
+
+    // A random session: small stick moves, full-scale jumps and button flips. Every frame
+    // changes something; repeats are covered on their own below.
+    for (int i = 0; i < ROUND_TRIP_FRAMES; i++)
+    {
+        uint32_t r = test_rand(&seed);
+        input_trace_frame_t prev = frame;
+
+        frame.time_us += r % 4 == 0 ? test_rand(&seed) : 250 + r % 5000;
+        if (r & 0x10)
+        {
+            frame.buttons ^= (gamepad_buttons_t)1 << (test_rand(&seed) % GAMEPAD_NUM_BUTTONS);
+        }
+        for (int a = 0; a < GAMEPAD_NUM_AXES; a++)
+        {
+            uint32_t move = test_rand(&seed);
+            if (move % 8 == 0)
+            {
+                frame.axes[a] = move >> 8 & AXIS_RAW_MAX;
+            }
+            else if (move % 8 < 4)
+            {
+                frame.axes[a] = (uint16_t)((frame.axes[a] + (int)(move >> 16 & 0x3f) - 32) & AXIS_RAW_MAX);
+            }
+        }
+        if (frame.buttons == prev.buttons && memcmp(frame.axes, prev.axes, sizeof(frame.axes)) == 0)
+        {
+            frame.axes[0] = (frame.axes[0] + 1) & AXIS_RAW_MAX;
+        }
+        s_in[i] = frame;
+    }
+
+    input_trace_block_begin(&w, s_blocks[0], 0);
+    for (int i = 0; i < ROUND_TRIP_FRAMES; i++)
+    {
+        if (!input_trace_block_append(&w, &s_in[i]))
+        {
+            CHECK(!input_trace_block_empty(&w));
+            input_trace_block_finish(&w);
+            blocks++;
+            CHECK(blocks < MAX_BLOCKS);
+            input_trace_block_begin(&w, s_blocks[blocks], blocks);
+            CHECK(input_trace_block_append(&w, &s_in[i])); // Always fits a fresh block
+        }
+    }
+    input_trace_block_finish(&w);
+    blocks++;
+    CHECK(blocks > 10); // Crossed plenty of block boundaries
+
+    s_out_count = 0;
+    for (int b = 0; b < blocks; b++)
+    {
+        uint32_t seq;
+        CHECK(input_trace_block_check(s_blocks[b], &seq));
+        CHECK_EQ(seq, b);
+        CHECK(input_trace_block_decode(s_blocks[b], collect, NULL) > 0);
+    }
+
+    // Every frame comes back, in order
+    CHECK_EQ(s_out_count, ROUND_TRIP_FRAMES);
+    for (int i = 0; i < ROUND_TRIP_FRAMES && i < s_out_count; i++)
+    {
+        CHECK(same_frame(&s_out[i], &s_in[i]));
+    }
+}
+
+static void test_repeats_not_stored(void)
+{
+    input_trace_frame_t frames[3] = {{.time_us = 100}, {.time_us = 200}, {.time_us = 300, .buttons = 1}};
+    uint8_t block[INPUT_TRACE_BLOCK_SIZE];
+    input_trace_writer_t w;
+
+    input_trace_block_begin(&w, block, 0);
+    CHECK(input_trace_block_empty(&w));
+    CHECK(input_trace_block_append(&w, &frames[0]));
+    uint16_t used = w.used;
+    CHECK(input_trace_block_append(&w, &frames[1]));
+    CHECK_EQ(w.used, used);
+    CHECK(input_trace_block_append(&w, &frames[2]));
+    input_trace_block_finish(&w);
+
+    // The change is stored relative to the last stored frame, so its time is still right
+    s_out_count = 0;
+    CHECK_EQ(input_trace_block_decode(block, collect, NULL), 2);
+    CHECK(same_frame(&s_out[1], &frames[2]));
+}
+
+// The exact bytes of a keyframe and a delta record
+static void test_varint_and_zigzag(void)
+{
+    input_trace_frame_t frames[2] = {{.time_us = 300, .buttons = 0x81}, {.time_us = 300 + 0x3fff}};
+    uint8_t block[INPUT_TRACE_BLOCK_SIZE];
+
+    frames[0].axes[0] = 2048;
+    frames[0].axes[1] = 1;
+    frames[1].buttons = 0x80;
+    frames[1].axes[0] = 2047; // -1
+    frames[1].axes[1] = 2;    // +1
+    for (int a = 2; a < GAMEPAD_NUM_AXES; a++)
+    {
+        frames[1].axes[a] = frames[0].axes[a];
+    }
+    frames[1].axes[GAMEPAD_NUM_AXES - 1] = 4095; // +4095 from 0
+
+    uint16_t used = write_block(block, 7, frames, 2);
+    const uint8_t *p = block + INPUT_TRACE_HEADER_SIZE;
+
+    // Keyframe: every field absolute, 300 = 0xAC 0x02, 2048 = 0x80 0x10
+    CHECK_EQ(*p++, KEYFRAME_ALL);
+    CHECK_EQ(*p++, 0xAC);
+    CHECK_EQ(*p++, 0x02);
+    CHECK_EQ(*p++, 0x81);
+    CHECK_EQ(*p++, 0x01);
+    CHECK_EQ(*p++, 0x80);
+    CHECK_EQ(*p++, 0x10);
+    CHECK_EQ(*p++, 0x01);
+    for (int a = 2; a < GAMEPAD_NUM_AXES; a++)
+    {
+        CHECK_EQ(*p++, 0x00);
+    }
+
+    // Delta: buttons, axis 0, axis 1 and the last axis changed; 0x3fff is the longest
+    // two-byte varint, -1 zigzags to 1, +1 to 2, +4095 to 8190 = 0xFE 0x3F
+    CHECK_EQ(*p++, 0x01 | 0x02 | 0x04 | (0x02 << (GAMEPAD_NUM_AXES - 1)));
+    CHECK_EQ(*p++, 0xFF);
+    CHECK_EQ(*p++, 0x7F);
+    CHECK_EQ(*p++, 0x01); // Button XOR
+    CHECK_EQ(*p++, 0x01);
+    CHECK_EQ(*p++, 0x02);
+    CHECK_EQ(*p++, 0xFE);
+    CHECK_EQ(*p++, 0x3F);
+    CHECK_EQ(p - block, used);
+
+    // The header, and the unused tail left as erased flash
+    CHECK_EQ(get_le16(block + 8), used);
+    CHECK_EQ(get_le16(block + 10), fletcher16(block + INPUT_TRACE_HEADER_SIZE, used - INPUT_TRACE_HEADER_SIZE));
+    for (int i = used; i < INPUT_TRACE_BLOCK_SIZE; i++)
+    {
+        CHECK_EQ(block[i], 0xFF);
+    }
+
+    s_out_count = 0;
+    CHECK_EQ(input_trace_block_decode(block, collect, NULL), 2);
+    CHECK(same_frame(&s_out[0], &frames[0]));
+    CHECK(same_frame(&s_out[1], &frames[1]));
+
+    // A wrap of the 32-bit clock is a small step forward
+    frames[0].time_us = 0xfffffff0;
+    frames[1].time_us = 0x10;
+    write_block(block, 8, frames, 2);
+    s_out_count = 0;
+    CHECK_EQ(input_trace_block_decode(block, collect, NULL), 2);
+    CHECK_EQ(s_out[1].time_us, 0x10);
+}
+
+static void test_checksum_rejects_damage(void)
+{
+    input_trace_frame_t frames[40];
+    uint8_t block[INPUT_TRACE_BLOCK_SIZE];
+    uint32_t seq;
+
+    for (int i = 0; i < 40; i++)
+    {
+        frames[i] = (input_trace_frame_t){.time_us = 1000 * i, .buttons = i & 3};
+        for (int a = 0; a < GAMEPAD_NUM_AXES; a++)
+        {
+            frames[i].axes[a] = (uint16_t)(2048 + i * (a + 1) * 7);
+        }
+    }
+    uint16_t used = write_block(block, 3, frames, 40);
+    CHECK(input_trace_block_check(block, &seq));
+    CHECK_EQ(seq, 3);
+
+    // Any single flipped bit in the records is caught
+    for (int i = INPUT_TRACE_HEADER_SIZE; i < used; i++)
+    {
+        for (int bit = 0; bit < 8; bit++)
+        {
+            block[i] ^= 1 << bit;
+            CHECK(!input_trace_block_check(block, &seq));
+            block[i] ^= 1 << bit;
+        }
+    }
+
+    // So are two swapped records bytes, a wrong checksum and a bad header
+    uint8_t tmp = block[20];
+    block[20] = block[21];
+    block[21] = tmp;
+    CHECK(block[20] == block[21] || !input_trace_block_check(block, &seq));
+    block[21] = block[20];
+    block[20] = tmp;
+    CHECK(input_trace_block_check(block, &seq));
+
+    block[10] ^= 1;
+    CHECK(!input_trace_block_check(block, &seq));
+    block[10] ^= 1;
+    block[0] ^= 1;
+    CHECK(!input_trace_block_check(block, &seq));
+    CHECK(!input_trace_header_check(block, &seq));
+    block[0] ^= 1;
+
+    // A used length past the block or inside the header
+    block[8] = 0x01;
+    block[9] = 0x04; // 1025
+    CHECK(!input_trace_header_check(block, &seq));
+    block[8] = INPUT_TRACE_HEADER_SIZE - 1;
+    block[9] = 0;
+    CHECK(!input_trace_header_check(block, &seq));
+
+    // Erased flash is not a block
+    memset(block, 0xFF, sizeof(block));
+    CHECK(!input_trace_header_check(block, &seq));
+}
+
+// Hand-built records the decoder must refuse
+static void test_malformed_records(void)
+{
+    input_trace_frame_t frame = {.time_us = 5};
+    uint8_t block[INPUT_TRACE_BLOCK_SIZE];
+    uint16_t used = write_block(block, 0, &frame, 1);
+
+    struct
+    {
+        const char *what;
+        uint8_t bytes[16];
+        int len;
+    } bad[] = {
+        {"second keyframe", {KEYFRAME_ALL, 0, 0, 0}, 4},
+        {"unused flag bit", {0x02 << GAMEPAD_NUM_AXES, 0}, 2},
+        {"varint past the end", {0x02, 0x01, 0x80}, 3},
+        {"varint over 64 bits", {0x01, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01}, 12},
+        {"time over 32 bits", {0x01, 0x80, 0x80, 0x80, 0x80, 0x10, 0x01}, 7},
+        {"axis below zero", {0x02, 0x00, 0x01}, 3},
+#if GAMEPAD_NUM_BUTTONS <= 56
+        {"button out of range", {0x01, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01}, 11}, // Bit 56
+#endif
+    };
+
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        uint8_t copy[INPUT_TRACE_BLOCK_SIZE];
+        memcpy(copy, block, sizeof(copy));
+        memcpy(copy + used, bad[i].bytes, bad[i].len);
+        copy[8] = (uint8_t)(used + bad[i].len);
+        copy[9] = (uint8_t)((used + bad[i].len) >> 8);
+
+        // The frames before the bad record are still delivered
+        s_out_count = 0;
+        if (input_trace_block_decode(copy, collect, NULL) != -1 || s_out_count != 1)
+        {
+            fprintf(stderr, "%s: not rejected\n", bad[i].what);
+            s_check_failures++;
+        }
+    }
+
+    // The first record must be a keyframe
+    block[INPUT_TRACE_HEADER_SIZE] = 0x01;
+    CHECK_EQ(input_trace_block_decode(block, collect, NULL), -1);
+}
+
+static void test_timeline(void)
+{
+    input_trace_timeline_t timeline = {0};
+
+    CHECK_EQ(input_trace_timeline_map(&timeline, 5000), 5000);
+    CHECK_EQ(input_trace_timeline_map(&timeline, 9000), 9000);
+
+    // A reboot restarts the clock; the next session carries on from the last frame
+    CHECK_EQ(input_trace_timeline_map(&timeline, 100), 9000);
+    CHECK_EQ(input_trace_timeline_map(&timeline, 600), 9500);
+}
+
+int main(void)
+{
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_repeats_not_stored);
+    RUN_TEST(test_varint_and_zigzag);
+    RUN_TEST(test_checksum_rejects_damage);
+    RUN_TEST(test_malformed_records);
+    RUN_TEST(test_timeline);
+    TEST_EXIT();
+}
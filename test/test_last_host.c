@@ -0,0 +1,167 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// The last connected host in NVS and the choice of host to page at boot, against the
+// in-memory NVS and a scripted bond list. Built with and without fast reconnect.
+#include "check.h"
+
+#include <string.h>
+
+#include "sdkconfig.h"
+
+#include "esp_gap_bt_api.h"
+#include "nvs.h"
+
+#include "last_host.h"
+
+static const esp_bd_addr_t s_host = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+static const esp_bd_addr_t s_other = {0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5};
+static const esp_bd_addr_t s_plugged = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+
+static void reset(void)
+{
+    nvs_fake_erase_all();
+    esp_bt_gap_fake_set_bonds(NULL, 0);
+    esp_bt_gap_fake_set_fail(false);
+}
+
+static void bond(const esp_bd_addr_t a, const esp_bd_addr_t b)
+{
+    esp_bd_addr_t bonds[2];
+    int count = 0;
+
+    if (a)
+    {
+        memcpy(bonds[count++], a, ESP_BD_ADDR_LEN);
+    }
+    if (b)
+    {
+        memcpy(bonds[count++], b, ESP_BD_ADDR_LEN);
+    }
+    esp_bt_gap_fake_set_bonds(bonds, count);
+}
+
+static void test_nothing_stored(void)
+{
+    esp_bd_addr_t host;
+
+    reset();
+    bond(s_host, NULL);
+    CHECK(!last_host_get(host));
+    CHECK(!last_host_boot_target(false, s_plugged, host));
+}
+
+static void test_set_and_get(void)
+{
+    esp_bd_addr_t host;
+
+    reset();
+    bond(s_other, s_host);
+    last_host_set(s_host);
+    CHECK_EQ(nvs_fake_writes(), 1);
+    CHECK_EQ(nvs_fake_commits(), 1);
+    memset(host, 0, sizeof(host));
+    CHECK(last_host_get(host));
+    CHECK(memcmp(host, s_host, ESP_BD_ADDR_LEN) == 0);
+
+    // Reconnecting to the same host doesn't touch flash; a new one replaces it
+    last_host_set(s_host);
+    CHECK_EQ(nvs_fake_writes(), 1);
+    last_host_set(s_other);
+    CHECK_EQ(nvs_fake_writes(), 2);
+    CHECK_EQ(nvs_fake_commits(), 2);
+    CHECK(last_host_get(host));
+    CHECK(memcmp(host, s_other, ESP_BD_ADDR_LEN) == 0);
+}
+
+static void test_unbonded_host_ignored(void)
+{
+    esp_bd_addr_t host;
+
+    reset();
+    last_host_set(s_host);
+
+    // The host removed the pairing, or the bond list isn't available: don't page it
+    bond(s_other, NULL);
+    CHECK(!last_host_get(host));
+    bond(NULL, NULL);
+    CHECK(!last_host_get(host));
+    bond(s_host, NULL);
+    esp_bt_gap_fake_set_fail(true);
+    CHECK(!last_host_get(host));
+    esp_bt_gap_fake_set_fail(false);
+    CHECK(last_host_get(host));
+}
+
+static void test_clear(void)
+{
+    esp_bd_addr_t host;
+
+    reset();
+    bond(s_host, NULL);
+    last_host_set(s_host);
+    last_host_clear();
+    CHECK(!last_host_get(host));
+    CHECK_EQ(nvs_fake_commits(), 2);
+
+    // Clearing with nothing stored is harmless, and the host is stored again on the next connect
+    last_host_clear();
+    last_host_set(s_host);
+    CHECK(last_host_get(host));
+}
+
+static void test_bad_blob_ignored(void)
+{
+    esp_bd_addr_t host;
+    nvs_handle_t handle;
+    static const uint8_t shorter[ESP_BD_ADDR_LEN - 1] = {0x11, 0x22, 0x33, 0x44, 0x55};
+
+    reset();
+    bond(s_host, NULL);
+    CHECK_EQ(nvs_open("gamepad", NVS_READWRITE, &handle), ESP_OK);
+    CHECK_EQ(nvs_set_blob(handle, "last_host", shorter, sizeof(shorter)), ESP_OK);
+    nvs_close(handle);
+    CHECK(!last_host_get(host));
+
+    // Overwritten with a whole address on the next connect
+    last_host_set(s_host);
+    CHECK(last_host_get(host));
+}
+
+static void test_boot_target(void)
+{
+    esp_bd_addr_t host;
+
+    reset();
+    bond(s_host, s_plugged);
+    last_host_set(s_host);
+
+    // A virtual cable the stack already knows always wins
+    CHECK(last_host_boot_target(true, s_plugged, host));
+    CHECK(memcmp(host, s_plugged, ESP_BD_ADDR_LEN) == 0);
+
+    // Otherwise the stored host, only with fast reconnect and only while bonded
+    memset(host, 0, sizeof(host));
+    CHECK_EQ(last_host_boot_target(false, s_plugged, host), CONFIG_GAMEPAD_FAST_RECONNECT);
+#if CONFIG_GAMEPAD_FAST_RECONNECT
+    CHECK(memcmp(host, s_host, ESP_BD_ADDR_LEN) == 0);
+#endif
+    bond(s_plugged, NULL);
+    CHECK(!last_host_boot_target(false, s_plugged, host));
+
+    // After an unplug there is nothing to page
+    bond(s_host, s_plugged);
+    last_host_clear();
+    CHECK(!last_host_boot_target(false, s_plugged, host));
+}
+
+int main(void)
+{
+    RUN_TEST(test_nothing_stored);
+    RUN_TEST(test_set_and_get);
+    RUN_TEST(test_unbonded_host_ignored);
+    RUN_TEST(test_clear);
+    RUN_TEST(test_bad_blob_ignored);
+    RUN_TEST(test_boot_target);
+    TEST_EXIT();
+}
@@ -0,0 +1,148 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "check.h"
+
+#include "latency_hist.h"
+
+static latency_hist_t s_hist;
+
+static uint32_t bucket_lower(uint32_t bucket)
+{
+    return bucket == 0 ? 0 : latency_hist_bucket_upper(bucket - 1) + 1;
+}
+
+static void test_small_values_exact(void)
+{
+    for (uint32_t v = 0; v < LATENCY_HIST_SUB_BUCKETS; v++)
+    {
+        CHECK_EQ(latency_hist_bucket(v), v);
+        CHECK_EQ(latency_hist_bucket_upper(v), v);
+    }
+    // The linear part continues without a gap: 4..7 are one per bucket too
+    for (uint32_t v = LATENCY_HIST_SUB_BUCKETS; v < 2 * LATENCY_HIST_SUB_BUCKETS; v++)
+    {
+        CHECK_EQ(latency_hist_bucket_upper(latency_hist_bucket(v)), v);
+    }
+}
+
+static void test_buckets_tile_the_range(void)
+{
+    // Consecutive buckets share no values and leave none out, and each is at most
+    // 25% as wide as its lower bound
+    uint32_t last = LATENCY_HIST_NUM_BUCKETS - 1;
+    for (uint32_t b = 0; b < last; b++)
+    {
+        uint32_t lower = bucket_lower(b);
+        uint32_t upper = latency_hist_bucket_upper(b);
+        CHECK(upper >= lower);
+        CHECK_EQ(latency_hist_bucket(lower), b);
+        CHECK_EQ(latency_hist_bucket(upper), b);
+        CHECK_EQ(latency_hist_bucket(upper + 1), b + 1);
+        if (lower >= LATENCY_HIST_SUB_BUCKETS)
+        {
+            CHECK((upper - lower + 1) * 4 <= lower);
+        }
+    }
+    CHECK_EQ(latency_hist_bucket_upper(last), (1U << LATENCY_HIST_MAX_BITS) - 1);
+}
+
+static void test_placement_random(void)
+{
+    uint32_t seed = 1;
+
+    // Every value lands in the bucket whose bounds contain it
+    for (int i = 0; i < 100000; i++)
+    {
+        uint32_t v = test_rand(&seed) >> (test_rand(&seed) % 32);
+        uint32_t b = latency_hist_bucket(v);
+        CHECK(b < LATENCY_HIST_NUM_BUCKETS);
+        if (v < (1U << LATENCY_HIST_MAX_BITS))
+        {
+            CHECK(bucket_lower(b) <= v && v <= latency_hist_bucket_upper(b));
+        }
+    }
+}
+
+static void test_saturation(void)
+{
+    uint32_t last = LATENCY_HIST_NUM_BUCKETS - 1;
+
+    // Anything from 2^24 us up shares the top bucket; max still holds the real value
+    CHECK_EQ(latency_hist_bucket(1U << LATENCY_HIST_MAX_BITS), last);
+    CHECK_EQ(latency_hist_bucket(UINT32_MAX), last);
+    latency_hist_reset(&s_hist);
+    latency_hist_record(&s_hist, 100);
+    latency_hist_record(&s_hist, UINT32_MAX);
+    CHECK_EQ(s_hist.buckets[last], 1);
+    CHECK_EQ(s_hist.max, UINT32_MAX);
+    CHECK_EQ(latency_hist_percentile(&s_hist, 1000), latency_hist_bucket_upper(last));
+
+    // Counters don't wrap into a bucket below
+    latency_hist_reset(&s_hist);
+    for (int i = 0; i < 1000; i++)
+    {
+        latency_hist_record(&s_hist, (1U << 30) + i);
+    }
+    CHECK_EQ(s_hist.buckets[last], 1000);
+    CHECK_EQ(s_hist.count, 1000);
+}
+
+static void test_percentiles(void)
+{
+    latency_summary_t summary;
+
+    // Empty
+    latency_hist_reset(&s_hist);
+    CHECK_EQ(latency_hist_percentile(&s_hist, 500), 0);
+    latency_hist_summary(&s_hist, &summary);
+    CHECK_EQ(summary.count, 0);
+    CHECK_EQ(summary.p50, 0);
+    CHECK_EQ(summary.max, 0);
+
+    // One sample: every percentile is that sample, clamped to the max rather than the bucket's top
+    latency_hist_record(&s_hist, 1234);
+    CHECK_EQ(latency_hist_percentile(&s_hist, 0), 1234);
+    CHECK_EQ(latency_hist_percentile(&s_hist, 500), 1234);
+    CHECK_EQ(latency_hist_percentile(&s_hist, 1000), 1234);
+
+    // 1..1000 us: the percentile is the top of the bucket holding that rank, so it is
+    // never below the exact value and at most 25% above it
+    latency_hist_reset(&s_hist);
+    for (uint32_t v = 1000; v >= 1; v--)
+    {
+        latency_hist_record(&s_hist, v);
+    }
+    for (uint32_t pm = 10; pm <= 1000; pm += 10)
+    {
+        uint32_t exact = pm; // rank pm of 1000
+        uint32_t p = latency_hist_percentile(&s_hist, pm);
+        CHECK(p >= exact);
+        CHECK(p <= exact + exact / 4);
+    }
+    latency_hist_summary(&s_hist, &summary);
+    CHECK_EQ(summary.count, 1000);
+    CHECK_EQ(summary.max, 1000);
+    CHECK_EQ(summary.p50, latency_hist_bucket_upper(latency_hist_bucket(500)));
+    CHECK_EQ(summary.p99, 1000); // 990 sits in the top bucket, clamped to max
+
+    // A tail: 99 fast samples and one slow one
+    latency_hist_reset(&s_hist);
+    for (int i = 0; i < 99; i++)
+    {
+        latency_hist_record(&s_hist, 800);
+    }
+    latency_hist_record(&s_hist, 50000);
+    CHECK_EQ(latency_hist_percentile(&s_hist, 990), latency_hist_bucket_upper(latency_hist_bucket(800)));
+    CHECK_EQ(latency_hist_percentile(&s_hist, 991), 50000);
+}
+
+int main(void)
+{
+    RUN_TEST(test_small_values_exact);
+    RUN_TEST(test_buckets_tile_the_range);
+    RUN_TEST(test_placement_random);
+    RUN_TEST(test_saturation);
+    RUN_TEST(test_percentiles);
+    TEST_EXIT();
+}
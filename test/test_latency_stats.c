@@ -0,0 +1,248 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// Pairing of send completions with the reports handed to the stack, with the send
+// pipeline and a send callback wired up as in main.c, and clears from the gamepad task
+// racing the completion callback.
+#include "check.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "latency_stats.h"
+#include "send_pipeline.h"
+
+#define STALL_TIMEOUT_MS 500
+#define RACE_NS 300000000ULL
+#define CLEAR_EVERY 4
+
+static send_pipeline_t s_pipe;
+static uint32_t s_sample_us;
+static unsigned s_transport_in_flight;
+
+static int send_report(void *ctx, uint8_t report_id, const uint8_t *data, uint16_t len)
+{
+    if (send_pipeline_take_stall(&s_pipe))
+    {
+        latency_stats_clear_in_flight();
+    }
+    s_transport_in_flight++;
+    latency_stats_sent(s_sample_us, s_sample_us + 100);
+    return 0;
+}
+
+static void submit(uint32_t sample_us)
+{
+    uint8_t report[4] = {0};
+
+    s_sample_us = sample_us;
+    send_pipeline_submit(&s_pipe, 1, report, sizeof(report), sample_us);
+}
+
+// transport_sent in main.c: the credit goes back before the latency record is popped
+static void complete(uint32_t now_us, uint32_t resubmit_sample_us)
+{
+    s_transport_in_flight--;
+    send_pipeline_complete(&s_pipe, true);
+    if (resubmit_sample_us)
+    {
+        submit(resubmit_sample_us); // The input task gets in between
+    }
+    latency_stats_completed(now_us);
+}
+
+static void setup(unsigned max_in_flight)
+{
+    latency_stats_init();
+    latency_stats_clear_in_flight();
+    send_pipeline_init(&s_pipe, max_in_flight, STALL_TIMEOUT_MS, send_report, NULL);
+    s_transport_in_flight = 0;
+}
+
+static void test_full_pipeline(void)
+{
+    latency_summary_t total, done;
+    unsigned n = CONFIG_GAMEPAD_REPORTS_IN_FLIGHT;
+
+    setup(n);
+    for (unsigned i = 1; i <= n; i++)
+    {
+        submit(i * 1000);
+    }
+    CHECK_EQ(s_transport_in_flight, n);
+
+    // Every completion frees a credit that is reused before its record is taken, so one
+    // more report than the pipeline's limit is briefly on record
+    uint32_t next_us = (n + 1) * 1000;
+    for (unsigned i = 1; i <= 3 * n; i++)
+    {
+        complete(i * 1000 + 500, next_us);
+        next_us += 1000;
+    }
+    for (unsigned k = n; k >= 1; k--)
+    {
+        complete(next_us - k * 1000 + 500, 0);
+    }
+    CHECK_EQ(s_transport_in_flight, 0);
+
+    // Each report paired with its own timestamps: sent 100 us and completed 500 us after
+    // sampling. A report paired with its neighbour's would be 1000 us off.
+    latency_stats_get(LATENCY_STAGE_TOTAL, &total);
+    latency_stats_get(LATENCY_STAGE_COMPLETE, &done);
+    CHECK_EQ(total.count, 4 * n);
+    CHECK_EQ(done.count, 4 * n);
+    CHECK_EQ(total.max, 500);
+    CHECK_EQ(total.p50, 500); // Every sample is 500, the bucket top is clamped to the max
+    CHECK_EQ(done.max, 400);
+}
+
+static void test_stall_forgets_lost_reports(void)
+{
+    latency_summary_t total;
+
+    setup(2);
+    submit(1000);
+    submit(2000);
+    CHECK_EQ(s_transport_in_flight, 2);
+
+    // The link dropped their completions; once the stall timeout is over the pipeline sends
+    // again, and the next completion belongs to the new report
+    s_transport_in_flight = 0;
+    uint32_t late_us = 2000 + STALL_TIMEOUT_MS * 1000;
+    submit(late_us);
+    CHECK_EQ(s_transport_in_flight, 1);
+    complete(late_us + 700, 0);
+
+    latency_stats_get(LATENCY_STAGE_TOTAL, &total);
+    CHECK_EQ(total.count, 1);
+    CHECK_EQ(total.max, 700);
+
+    // Reported once
+    CHECK(!send_pipeline_take_stall(&s_pipe));
+}
+
+static void test_ring_overflow_skips(void)
+{
+    latency_summary_t total;
+
+    // Completions that never come don't block the sender; once the ring is full further
+    // reports are simply not timed
+    latency_stats_init();
+    latency_stats_clear_in_flight();
+    for (int i = 0; i < 100; i++)
+    {
+        latency_stats_sent(i, i);
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        latency_stats_completed(1000);
+    }
+    latency_stats_get(LATENCY_STAGE_TOTAL, &total);
+    CHECK(total.count > CONFIG_GAMEPAD_REPORTS_IN_FLIGHT);
+    CHECK(total.count < 100);
+    CHECK_EQ(total.max, 1000); // The oldest ones are kept
+}
+
+static void test_clear_keeps_room(void)
+{
+    latency_summary_t total;
+    unsigned n = CONFIG_GAMEPAD_REPORTS_IN_FLIGHT + 1;
+
+    // The forgotten reports stay on record until the next completion; a full set of new
+    // ones still fits next to them and is timed
+    latency_stats_init();
+    latency_stats_clear_in_flight();
+    for (unsigned i = 0; i < n; i++)
+    {
+        latency_stats_sent(i, i);
+    }
+    latency_stats_clear_in_flight();
+    for (unsigned i = 0; i < n; i++)
+    {
+        latency_stats_sent(10000 + i, 10000 + i);
+    }
+    for (unsigned i = 0; i < n; i++)
+    {
+        latency_stats_completed(10000 + i + 300);
+    }
+    latency_stats_completed(20000); // Nothing left
+    latency_stats_get(LATENCY_STAGE_TOTAL, &total);
+    CHECK_EQ(total.count, n);
+    CHECK_EQ(total.max, 300);
+}
+
+static atomic_bool s_race_done;
+static atomic_uint s_cleared_round; // Every report of this round and before was forgotten
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// The gamepad task: rounds of reports, every CLEAR_EVERY rounds forgetting those still on record
+static void *clearing_sender(void *arg)
+{
+    uint64_t end_ns = now_ns() + RACE_NS;
+    unsigned round = 0;
+
+    do
+    {
+        round++;
+        for (int i = 0; i < CONFIG_GAMEPAD_REPORTS_IN_FLIGHT; i++)
+        {
+            // Stamped with -round, so a completion stamped -(cleared + 1) times a report
+            // of a later round as round - cleared - 1, and one forgotten as negative
+            latency_stats_sent(-round, -round);
+        }
+        if (round % CLEAR_EVERY == 0)
+        {
+            latency_stats_clear_in_flight();
+            atomic_store(&s_cleared_round, round);
+        }
+        sched_yield(); // Let the completions in between rounds as well as mid-round
+    } while (now_ns() < end_ns);
+    atomic_store(&s_race_done, true);
+    return NULL;
+}
+
+static void test_clear_races_completion(void)
+{
+    pthread_t sender;
+    latency_summary_t done;
+    unsigned completions = 0;
+
+    latency_stats_init();
+    latency_stats_clear_in_flight();
+    atomic_store(&s_race_done, false);
+    atomic_store(&s_cleared_round, 0);
+    pthread_create(&sender, NULL, clearing_sender, NULL);
+    while (!atomic_load(&s_race_done))
+    {
+        // A report forgotten before this completion started must not be paired with it
+        unsigned cleared = atomic_load(&s_cleared_round);
+        latency_stats_completed(-(cleared + 1));
+        if (++completions % 4 == 0)
+        {
+            sched_yield();
+        }
+    }
+    pthread_join(sender, NULL);
+
+    latency_stats_get(LATENCY_STAGE_COMPLETE, &done);
+    printf("  %u completions, %u paired, %u rounds\n", completions, done.count, atomic_load(&s_cleared_round));
+    CHECK(done.count > 0);
+    CHECK(done.max < 0x80000000u);
+}
+
+int main(void)
+{
+    RUN_TEST(test_full_pipeline);
+    RUN_TEST(test_stall_forgets_lost_reports);
+    RUN_TEST(test_ring_overflow_skips);
+    RUN_TEST(test_clear_keeps_room);
+    RUN_TEST(test_clear_races_completion);
+    TEST_EXIT();
+}
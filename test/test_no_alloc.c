@@ -0,0 +1,272 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// No heap allocation after boot: the shared input pipeline, report packing, the send
+// pipeline and the host's GET_REPORT/SET_REPORT requests run through many connect and
+// disconnect cycles of the fake transport while every malloc, calloc, realloc and free
+// made by the code under test is counted (the link wraps them, see CMakeLists.txt).
+#include <stdlib.h>
+#include <string.h>
+
+#include "check.h"
+
+#include "axis_calibration.h"
+#include "config_block.h"
+#include "fake_actuator.h"
+#include "gamepad_hal.h"
+#include "gamepad_report.h"
+#include "gamepad_sim.h"
+#include "gamepad_transport_fake.h"
+#include "input_pipeline.h"
+#include "nvs.h"
+#include "report_requests.h"
+#include "runtime_config.h"
+#include "send_pipeline.h"
+
+#define CYCLES 50
+#define FRAME_US 1000
+#define FRAMES 2000 // Two seconds per connection: one moving, one still
+#define CONNECTION_US (FRAMES * FRAME_US)
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+// volatile: the compiler assumes malloc and free leave globals alone
+static volatile bool s_armed;
+static volatile unsigned s_allocs;
+static volatile unsigned s_frees;
+
+void *__wrap_malloc(size_t size)
+{
+    s_allocs += s_armed;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    s_allocs += s_armed;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    s_allocs += s_armed;
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr)
+{
+    s_frees += s_armed && ptr;
+    __real_free(ptr);
+}
+
+static gamepad_sim_frame_t s_frames[FRAMES];
+static int16_t s_axis_lut[AXIS_LUT_SIZE];
+static input_pipeline_t s_input;
+static send_pipeline_t s_pipeline;
+static report_requests_t s_requests;
+static bool s_connected;
+static unsigned s_connections;
+static unsigned s_reports;
+
+static void synthesize_script(void)
+{
+    for (uint32_t i = 0; i < FRAMES; i++)
+    {
+        bool still = i >= FRAMES / 2;
+        uint16_t sweep = still ? 2048 : (i * 8) & AXIS_RAW_MAX;
+
+        s_frames[i].time_us = i * FRAME_US;
+        s_frames[i].buttons = (!still && (i / 100) % 2) ? (1U << GAMEPAD_BUTTON_A) : 0;
+        s_frames[i].axes[0] = sweep;
+        s_frames[i].axes[1] = AXIS_RAW_MAX - sweep;
+        s_frames[i].axes[2] = 2048;
+        s_frames[i].axes[3] = 2048;
+    }
+}
+
+static void map_axes(const uint16_t raw[GAMEPAD_NUM_AXES], int16_t axes[GAMEPAD_NUM_AXES])
+{
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        axes[i] = axis_lut_apply(s_axis_lut, raw[i]);
+    }
+    stick_radial_deadzone(&axes[0], &axes[1], CONFIG_GAMEPAD_STICK_DEADZONE);
+    stick_radial_deadzone(&axes[2], &axes[3], CONFIG_GAMEPAD_STICK_DEADZONE);
+}
+
+// The transport callbacks, as main.c wires them
+static void connected(void)
+{
+    uint8_t empty_report[GAMEPAD_REPORT_SIZE] = {0};
+
+    report_requests_publish(&s_requests, empty_report, sizeof(empty_report));
+    send_pipeline_reset(&s_pipeline);
+    s_connected = true;
+    s_connections++;
+}
+
+static void disconnected(void)
+{
+    s_connected = false;
+    actuator_off();
+}
+
+static void sent(bool ok)
+{
+    send_pipeline_complete(&s_pipeline, ok);
+}
+
+static uint16_t get_report(gamepad_report_type_t type, uint8_t report_id, uint8_t *buf, uint16_t size)
+{
+    return report_requests_get(&s_requests, type, report_id, buf, size);
+}
+
+static gamepad_set_report_status_t set_report(gamepad_report_type_t type, uint8_t report_id, const uint8_t *data,
+                                              uint16_t len)
+{
+    return report_requests_set(&s_requests, type, report_id, data, len);
+}
+
+static void set_protocol(bool boot)
+{
+    report_requests_set_protocol(&s_requests, boot);
+}
+
+static const gamepad_transport_callbacks_t s_callbacks = {
+    .connected = connected,
+    .disconnected = disconnected,
+    .sent = sent,
+    .get_report = get_report,
+    .set_report = set_report,
+    .set_protocol = set_protocol,
+};
+
+// What the host does on every connection besides reading reports
+static void host_requests(void)
+{
+    uint8_t buf[GAMEPAD_TRANSPORT_MAX_REPORT];
+    uint8_t output[3] = {0x80, 0x40, 0x01};
+
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_INPUT, GAMEPAD_REPORT_ID, buf, sizeof(buf)),
+             GAMEPAD_REPORT_SIZE);
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, buf,
+                                               sizeof(buf)),
+             CONFIG_BLOCK_SIZE);
+    buf[1] |= CONFIG_BLOCK_FLAG_SAVE;
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, buf,
+                                               CONFIG_BLOCK_SIZE),
+             GAMEPAD_SET_REPORT_OK);
+#if CONFIG_GAMEPAD_OUTPUT_REPORT
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_OUTPUT, GAMEPAD_OUTPUT_REPORT_ID, output,
+                                               sizeof(output)),
+             GAMEPAD_SET_REPORT_OK);
+#endif
+    gamepad_transport_fake_set_protocol(false);
+}
+
+// One connection: the input task's loop over the script, the host completing every report
+static void run_connection(void)
+{
+    config_block_t cfg;
+    uint32_t first_edge_us;
+    input_sample_t sample;
+    uint32_t generation;
+
+    gamepad_sim_load(s_frames, FRAMES);
+    gamepad_transport_fake_connect();
+    CHECK(s_connected);
+
+    input_pipeline_start(&s_input);
+    runtime_config_get(&cfg);
+    generation = runtime_config_generation();
+    input_pipeline_configure(&s_input, &cfg, 0);
+
+    for (uint32_t now_us = 0; now_us < CONNECTION_US; now_us += rate_governor_sample_us(&s_input.governor))
+    {
+        if (now_us >= CONNECTION_US / 4 && now_us < CONNECTION_US / 4 + FRAME_US)
+        {
+            host_requests();
+        }
+        if (runtime_config_generation() != generation)
+        {
+            generation = runtime_config_generation();
+            runtime_config_get(&cfg);
+            input_pipeline_configure(&s_input, &cfg, now_us);
+        }
+
+        gamepad_sim_advance(now_us);
+        while (gamepad_transport_fake_complete(true))
+        {
+        }
+        send_pipeline_flush(&s_pipeline, now_us);
+
+        input_pipeline_sample(&s_input, gamepad_hal_take_edges(&first_edge_us), now_us, &sample);
+        if (input_pipeline_report(&s_input, &sample, now_us) != REPORT_SEND_NONE)
+        {
+            uint8_t buffer[GAMEPAD_REPORT_SIZE];
+            uint16_t len = gamepad_report_pack(&sample.state, buffer);
+            report_requests_publish(&s_requests, buffer, len);
+            send_pipeline_submit(&s_pipeline, GAMEPAD_REPORT_ID, buffer, len, now_us);
+            s_reports++;
+        }
+    }
+
+    gamepad_transport_fake_disconnect();
+    CHECK(!s_connected);
+}
+
+static void test_counter_sees_allocations(void)
+{
+    // The wrap is in place: an allocation made here is counted
+    void *volatile block;
+
+    s_allocs = s_frees = 0;
+    s_armed = true;
+    block = malloc(16);
+    free(block);
+    s_armed = false;
+    CHECK_EQ(s_allocs, 1);
+    CHECK_EQ(s_frees, 1);
+}
+
+static void test_reconnects_allocate_nothing(void)
+{
+    axis_calibration_t cal;
+
+    // Boot: everything that may allocate happens here, before the counter is armed
+    synthesize_script();
+    axis_calibration_default(&cal);
+    axis_lut_build(s_axis_lut, &cal, AXIS_CURVE_LINEAR);
+    nvs_fake_erase_all();
+    fake_actuator_set_accept(true);
+    runtime_config_init();
+    input_pipeline_init(&s_input, map_axes);
+    report_requests_init(&s_requests, &s_input.scheduler);
+    send_pipeline_init(&s_pipeline, CONFIG_GAMEPAD_REPORTS_IN_FLIGHT, CONFIG_GAMEPAD_SEND_STALL_TIMEOUT_MS,
+                       gamepad_transport_send_report, NULL);
+    gamepad_transport_start(&s_callbacks);
+    gamepad_hal_input_init();
+
+    s_allocs = s_frees = 0;
+    s_armed = true;
+    for (int i = 0; i < CYCLES; i++)
+    {
+        run_connection();
+    }
+    s_armed = false;
+
+    CHECK_EQ(s_connections, CYCLES);
+    CHECK(s_reports > CYCLES * 10); // The cycles did real work
+    CHECK_EQ(s_allocs, 0);
+    CHECK_EQ(s_frees, 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_counter_sees_allocations);
+    RUN_TEST(test_reconnects_allocate_nothing);
+    TEST_EXIT();
+}
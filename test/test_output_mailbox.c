@@ -0,0 +1,191 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// The output command mailbox: the newest command wins, take counts the ones it replaced,
+// and one writer putting numbered commands as fast as it can against one reader never
+// shows the reader a torn or older command, nor loses count of a single put.
+#include "check.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "output_mailbox.h"
+
+#define RUN_NS 500000000ULL // Long enough for the scheduler to preempt the reader mid-copy on a single core
+#define RANDOM_SEED 0x0a7e57u
+
+static output_mailbox_t s_mailbox;
+static atomic_bool s_done;
+static uint32_t s_puts;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Command n: every field derived from the number, carried in received_us
+static gamepad_output_t make_cmd(uint32_t n)
+{
+    return (gamepad_output_t){
+        .rumble_strong = (uint8_t)n,
+        .rumble_weak = (uint8_t)(n * 7 + 1),
+        .player_leds = (uint8_t)((n >> 8) & 0x0f),
+        .received_us = n,
+    };
+}
+
+static bool cmd_whole(const gamepad_output_t *cmd)
+{
+    gamepad_output_t expected = make_cmd(cmd->received_us);
+
+    return cmd->rumble_strong == expected.rumble_strong && cmd->rumble_weak == expected.rumble_weak &&
+           cmd->player_leds == expected.player_leds;
+}
+
+static void test_latest_wins(void)
+{
+    gamepad_output_t cmd, out = make_cmd(0);
+    unsigned seen = 0;
+
+    output_mailbox_init(&s_mailbox);
+
+    // Nothing published: out is left alone
+    CHECK_EQ(output_mailbox_take(&s_mailbox, &out, &seen), 0);
+    CHECK_EQ(out.received_us, 0);
+
+    cmd = make_cmd(1);
+    output_mailbox_put(&s_mailbox, &cmd);
+    CHECK_EQ(output_mailbox_take(&s_mailbox, &out, &seen), 1);
+    CHECK_EQ(out.received_us, 1);
+    CHECK(cmd_whole(&out));
+    CHECK_EQ(output_mailbox_take(&s_mailbox, &out, &seen), 0);
+
+    // Several puts before a take: only the newest arrives, and the count says how many there were
+    for (uint32_t n = 2; n <= 6; n++)
+    {
+        cmd = make_cmd(n);
+        output_mailbox_put(&s_mailbox, &cmd);
+    }
+    CHECK_EQ(output_mailbox_take(&s_mailbox, &out, &seen), 5);
+    CHECK_EQ(out.received_us, 6);
+    CHECK(cmd_whole(&out));
+    CHECK_EQ(output_mailbox_take(&s_mailbox, &out, &seen), 0);
+    CHECK_EQ(out.received_us, 6);
+
+    // A command equal to the last one still counts as new
+    output_mailbox_put(&s_mailbox, &cmd);
+    CHECK_EQ(output_mailbox_take(&s_mailbox, &out, &seen), 1);
+    CHECK_EQ(out.received_us, 6);
+}
+
+static void test_replaced_count(void)
+{
+    uint32_t seed = RANDOM_SEED;
+    unsigned seen = 0, taken = 0, replaced = 0;
+    uint32_t n = 0;
+
+    // Random runs of puts between takes: every put is either taken or counted as replaced
+    output_mailbox_init(&s_mailbox);
+    for (int round = 0; round < 10000; round++)
+    {
+        uint32_t puts = test_rand(&seed) % 5;
+        gamepad_output_t out;
+
+        for (uint32_t i = 0; i < puts; i++)
+        {
+            gamepad_output_t cmd = make_cmd(++n);
+            output_mailbox_put(&s_mailbox, &cmd);
+        }
+        unsigned published = output_mailbox_take(&s_mailbox, &out, &seen);
+        CHECK_EQ(published, puts);
+        if (published)
+        {
+            CHECK_EQ(out.received_us, n);
+            taken++;
+            replaced += published - 1;
+        }
+    }
+    CHECK_EQ(taken + replaced, n);
+}
+
+static void *writer(void *arg)
+{
+    uint64_t end_ns = now_ns() + RUN_NS;
+    uint32_t n = 0;
+
+    do
+    {
+        for (int i = 0; i < 1000; i++)
+        {
+            gamepad_output_t cmd = make_cmd(++n);
+            output_mailbox_put(&s_mailbox, &cmd);
+        }
+        sched_yield(); // Let the reader in between batches as well as mid-batch
+    } while (now_ns() < end_ns);
+    s_puts = n;
+    atomic_store(&s_done, true);
+    return NULL;
+}
+
+// Takes until the writer is done and then once more; returns the commands counted
+static unsigned read_all(unsigned *takes)
+{
+    unsigned seen = 0, counted = 0;
+    uint32_t last = 0;
+    bool done;
+
+    do
+    {
+        gamepad_output_t out;
+
+        done = atomic_load(&s_done);
+        unsigned published = output_mailbox_take(&s_mailbox, &out, &seen);
+        if (published == 0)
+        {
+            continue;
+        }
+        if (!cmd_whole(&out))
+        {
+            CHECK(!"torn command");
+            break;
+        }
+        // Exactly the commands put since the last take, the newest of them copied
+        if (out.received_us != last + published)
+        {
+            CHECK_EQ(out.received_us, last + published);
+            break;
+        }
+        last = out.received_us;
+        counted += published;
+        (*takes)++;
+    } while (!done);
+    return counted;
+}
+
+static void test_concurrent_put_take(void)
+{
+    pthread_t writer_thread;
+    unsigned takes = 0;
+
+    output_mailbox_init(&s_mailbox);
+    atomic_store(&s_done, false);
+    pthread_create(&writer_thread, NULL, writer, NULL);
+    unsigned counted = read_all(&takes);
+    pthread_join(writer_thread, NULL);
+
+    printf("  %u commands put, %u taken, %u replaced\n", s_puts, takes, counted - takes);
+    CHECK_EQ(counted, s_puts);
+    CHECK(takes > 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_latest_wins);
+    RUN_TEST(test_replaced_count);
+    RUN_TEST(test_concurrent_put_take);
+    TEST_EXIT();
+}
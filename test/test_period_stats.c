@@ -0,0 +1,92 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "check.h"
+
+#include "period_stats.h"
+
+static period_stats_t s_stats;
+
+// A wake for every tick, each late_us after its ideal time
+static void run(uint32_t *now_us, uint32_t *ticks, uint32_t period_us, int wakes, uint32_t late_us)
+{
+    for (int i = 0; i < wakes; i++)
+    {
+        *now_us += period_us;
+        (*ticks)++;
+        CHECK(period_stats_record(&s_stats, *now_us + late_us, *ticks));
+    }
+}
+
+static void test_grid(void)
+{
+    period_summary_t summary;
+    uint32_t now_us = 5000, ticks = 0;
+
+    period_stats_reset(&s_stats, 1000, ticks);
+    CHECK(!period_stats_record(&s_stats, now_us, ticks)); // Not a clock wake
+    run(&now_us, &ticks, 1000, 101, 0);
+    period_stats_summary(&s_stats, &summary);
+    CHECK_EQ(summary.count, 100); // The first wake is the origin
+    CHECK_EQ(summary.missed, 0);
+    CHECK_EQ(summary.jitter_max, 0);
+    CHECK_EQ(summary.drift, 0);
+
+    // One wake 300 us late, then a tick without a wake
+    now_us += 1000;
+    ticks++;
+    CHECK(period_stats_record(&s_stats, now_us + 300, ticks));
+    now_us += 2000;
+    ticks += 2;
+    CHECK(period_stats_record(&s_stats, now_us, ticks));
+    period_stats_summary(&s_stats, &summary);
+    CHECK_EQ(summary.missed, 1);
+    CHECK_EQ(summary.jitter_max, 300);
+    CHECK_EQ(summary.jitter_min, -300);
+    CHECK_EQ(summary.drift, 0);
+    CHECK_EQ(summary.drift_max, 300);
+}
+
+static void test_rebase_keeps_counts(void)
+{
+    period_summary_t summary;
+    uint32_t now_us = 0, ticks = 0;
+
+    period_stats_reset(&s_stats, 1000, ticks);
+    run(&now_us, &ticks, 1000, 11, 0);
+    ticks++;
+    CHECK(period_stats_record(&s_stats, now_us + 2500, ticks)); // 1500 us late: jitter and drift
+    now_us += 2500;
+
+    // The governor switches to 20 ms: a new grid, but nothing is forgotten, and the change
+    // itself is not counted as jitter
+    period_stats_rebase(&s_stats, 20000, ticks);
+    run(&now_us, &ticks, 20000, 11, 40);
+    period_stats_summary(&s_stats, &summary);
+    CHECK_EQ(summary.period_us, 20000);
+    CHECK_EQ(summary.count, 11 + 10);
+    CHECK_EQ(summary.jitter_max, 1500);
+    CHECK_EQ(summary.drift, 0); // Measured from the new origin
+    CHECK_EQ(summary.drift_max, 1500);
+
+    // And back
+    period_stats_rebase(&s_stats, 1000, ticks);
+    run(&now_us, &ticks, 1000, 5, 0);
+    period_stats_summary(&s_stats, &summary);
+    CHECK_EQ(summary.period_us, 1000);
+    CHECK_EQ(summary.count, 11 + 10 + 4);
+
+    // Only a reset clears them
+    period_stats_reset(&s_stats, 1000, ticks);
+    period_stats_summary(&s_stats, &summary);
+    CHECK_EQ(summary.count, 0);
+    CHECK_EQ(summary.jitter_max, 0);
+    CHECK_EQ(summary.drift_max, 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_grid);
+    RUN_TEST(test_rebase_keeps_counts);
+    TEST_EXIT();
+}
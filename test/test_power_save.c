@@ -0,0 +1,83 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// power_save.c built with light sleep on, against the host esp_pm: the awake lock is
+// held from init, dropped only while the input task dozes, and taken back when it
+// wakes or parks, whether or not the chip slept in between.
+#include "check.h"
+
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "power_save.h"
+
+#define SAMPLE_US 1000
+
+// Idle, quiet samples from start_us until the doze starts; returns its time
+static int64_t settle(int64_t start_us)
+{
+    for (int64_t now_us = start_us; now_us < start_us + 10 * CONFIG_GAMEPAD_LIGHT_SLEEP_SETTLE_MS * 1000;
+         now_us += SAMPLE_US)
+    {
+        if (power_save_update(true, false, now_us))
+        {
+            return now_us;
+        }
+    }
+    return -1;
+}
+
+static void test_awake_lock(void)
+{
+    power_save_init();
+    CHECK_EQ(esp_pm_fake_lock_count(), 1);
+    CHECK(!esp_pm_fake_light_sleep(1000));
+
+    power_save_start(0);
+    CHECK(!power_save_dozing());
+    int64_t doze_us = settle(0);
+    CHECK_EQ(doze_us, CONFIG_GAMEPAD_LIGHT_SLEEP_SETTLE_MS * 1000);
+    CHECK(power_save_dozing());
+    CHECK_EQ(esp_pm_fake_lock_count(), 0);
+
+    // Idle samples while dozing change nothing
+    CHECK(!power_save_update(true, false, doze_us + SAMPLE_US));
+    CHECK_EQ(esp_pm_fake_lock_count(), 0);
+
+    // The chip sleeps, then a press wakes the input task
+    esp_timer_fake_set(doze_us + 50000);
+    CHECK(esp_pm_fake_light_sleep(50000));
+    CHECK(power_save_update(false, false, doze_us + 50100));
+    CHECK(!power_save_dozing());
+    CHECK_EQ(esp_pm_fake_lock_count(), 1);
+    CHECK(!esp_pm_fake_light_sleep(1000));
+    power_save_reported(doze_us + 50300);
+
+    // Activity keeps it awake
+    CHECK(!power_save_update(false, true, doze_us + 51000));
+    CHECK_EQ(esp_pm_fake_lock_count(), 1);
+}
+
+static void test_stop(void)
+{
+    power_save_start(1000000);
+    int64_t doze_us = settle(1000000);
+    CHECK(doze_us > 0);
+    CHECK_EQ(esp_pm_fake_lock_count(), 0);
+
+    // Parking wakes a dozing input task; parking an awake one leaves the lock alone
+    power_save_stop(doze_us + SAMPLE_US);
+    CHECK(!power_save_dozing());
+    CHECK_EQ(esp_pm_fake_lock_count(), 1);
+    power_save_stop(doze_us + 2 * SAMPLE_US);
+    CHECK_EQ(esp_pm_fake_lock_count(), 1);
+
+    esp_timer_fake_set(doze_us + 3 * SAMPLE_US);
+    power_save_log();
+}
+
+int main(void)
+{
+    RUN_TEST(test_awake_lock);
+    RUN_TEST(test_stop);
+    TEST_EXIT();
+}
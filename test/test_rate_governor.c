@@ -0,0 +1,144 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "sdkconfig.h"
+
+#include "check.h"
+
+#include "rate_governor.h"
+
+#define TIMEOUT_MS 3000
+
+static rate_governor_t s_gov;
+
+static config_block_t settings(void)
+{
+    config_block_t cfg = {
+        .fixed_rate = false,
+        .axis_deadband = 256,
+        .keepalive_ms = 1000,
+        .sample_us = 1000,
+        .report_us = 4000,
+        .idle_timeout_ms = TIMEOUT_MS};
+    return cfg;
+}
+
+static void setup(const config_block_t *cfg)
+{
+    rate_governor_config_t config;
+
+    rate_governor_config_from_block(cfg, &config);
+    rate_governor_init(&s_gov, &config, 0);
+}
+
+static void test_active_to_idle(void)
+{
+    config_block_t cfg = settings();
+    int64_t timeout_us = (int64_t)TIMEOUT_MS * 1000;
+
+    setup(&cfg);
+    CHECK_EQ(rate_governor_state(&s_gov), RATE_GOVERNOR_ACTIVE);
+    CHECK_EQ(rate_governor_sample_us(&s_gov), 1000);
+    CHECK_EQ(rate_governor_report_us(&s_gov), 4000);
+    CHECK_EQ(rate_governor_keepalive_ms(&s_gov), 1000);
+
+    // Quiet samples: active until the timeout, then idle, reported as a change exactly once
+    for (int64_t now_us = 1000; now_us < timeout_us; now_us += 1000)
+    {
+        CHECK(!rate_governor_update(&s_gov, false, now_us));
+    }
+    CHECK_EQ(rate_governor_state(&s_gov), RATE_GOVERNOR_ACTIVE);
+    CHECK(rate_governor_update(&s_gov, false, timeout_us));
+    CHECK_EQ(rate_governor_state(&s_gov), RATE_GOVERNOR_IDLE);
+    CHECK(!rate_governor_update(&s_gov, false, timeout_us + 20000));
+    CHECK_EQ(rate_governor_sample_us(&s_gov), CONFIG_GAMEPAD_IDLE_SAMPLE_PERIOD_US);
+    CHECK_EQ(rate_governor_report_us(&s_gov), CONFIG_GAMEPAD_IDLE_SAMPLE_PERIOD_US);
+    CHECK_EQ(rate_governor_keepalive_ms(&s_gov), CONFIG_GAMEPAD_IDLE_KEEPALIVE_MS);
+
+    // One change wakes it straight away
+    int64_t wake_us = timeout_us + 50000;
+    CHECK(rate_governor_update(&s_gov, true, wake_us));
+    CHECK_EQ(rate_governor_state(&s_gov), RATE_GOVERNOR_ACTIVE);
+    CHECK_EQ(rate_governor_sample_us(&s_gov), 1000);
+    CHECK_EQ(s_gov.transitions, 2);
+}
+
+static void test_timeout_from_last_activity(void)
+{
+    config_block_t cfg = settings();
+    int64_t timeout_us = (int64_t)TIMEOUT_MS * 1000;
+
+    // Activity just before the timeout starts it over
+    setup(&cfg);
+    CHECK(!rate_governor_update(&s_gov, true, timeout_us - 1));
+    CHECK(!rate_governor_update(&s_gov, false, timeout_us));
+    CHECK(!rate_governor_update(&s_gov, false, 2 * timeout_us - 2));
+    CHECK(rate_governor_update(&s_gov, false, 2 * timeout_us - 1));
+    CHECK_EQ(s_gov.transitions, 1);
+
+    // Activity while active is no transition
+    CHECK(rate_governor_update(&s_gov, true, 3 * timeout_us));
+    CHECK(!rate_governor_update(&s_gov, true, 3 * timeout_us + 1000));
+    CHECK_EQ(s_gov.transitions, 2);
+}
+
+static void test_fixed_rate(void)
+{
+    config_block_t cfg = settings();
+    int64_t timeout_us = (int64_t)TIMEOUT_MS * 1000;
+
+    // The state still goes idle, but idle runs at the active rate
+    cfg.fixed_rate = true;
+    setup(&cfg);
+    CHECK(rate_governor_update(&s_gov, false, timeout_us));
+    CHECK_EQ(rate_governor_state(&s_gov), RATE_GOVERNOR_IDLE);
+    CHECK_EQ(rate_governor_sample_us(&s_gov), cfg.sample_us);
+    CHECK_EQ(rate_governor_report_us(&s_gov), cfg.report_us);
+    CHECK_EQ(rate_governor_keepalive_ms(&s_gov), cfg.keepalive_ms);
+}
+
+static void test_period_limits(void)
+{
+    config_block_t cfg = settings();
+    rate_governor_config_t config;
+
+    // The fastest settings a host may write: idle keeps the menuconfig idle rates
+    cfg.sample_us = 250;
+    cfg.report_us = 1000;
+    rate_governor_config_from_block(&cfg, &config);
+    CHECK_EQ(config.active_sample_us, 250);
+    CHECK_EQ(config.active_report_us, 1000);
+    CHECK_EQ(config.idle_sample_us, CONFIG_GAMEPAD_IDLE_SAMPLE_PERIOD_US);
+    CHECK_EQ(config.idle_report_us, CONFIG_GAMEPAD_IDLE_SAMPLE_PERIOD_US);
+    CHECK_EQ(config.idle_timeout_ms, TIMEOUT_MS);
+
+    // The slowest: going idle must not speed sampling or reports up
+    cfg.sample_us = 100000;
+    cfg.report_us = 100000;
+    rate_governor_config_from_block(&cfg, &config);
+    CHECK(CONFIG_GAMEPAD_IDLE_SAMPLE_PERIOD_US < 100000);
+    CHECK_EQ(config.idle_sample_us, 100000);
+    CHECK_EQ(config.idle_report_us, 100000);
+
+    // Every combination in between: idle is never faster than active
+    for (uint32_t sample_us = 250; sample_us <= 100000; sample_us += 4750)
+    {
+        for (uint32_t report_us = 1000; report_us <= 100000; report_us += 3300)
+        {
+            cfg.sample_us = sample_us;
+            cfg.report_us = report_us;
+            rate_governor_config_from_block(&cfg, &config);
+            CHECK(config.idle_sample_us >= config.active_sample_us);
+            CHECK(config.idle_report_us >= config.active_report_us);
+        }
+    }
+}
+
+int main(void)
+{
+    RUN_TEST(test_active_to_idle);
+    RUN_TEST(test_timeout_from_last_activity);
+    RUN_TEST(test_fixed_rate);
+    RUN_TEST(test_period_limits);
+    TEST_EXIT();
+}
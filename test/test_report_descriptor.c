@@ -0,0 +1,354 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// Walks the generated HID descriptor the way a host's parser does and checks every
+// report it declares against the code that fills or reads that report: input 1
+// against gamepad_report_pack, feature 2 against the settings block and output 3
+// against gamepad_output_parse. Built once per report format and button source.
+#include <string.h>
+
+#include "check.h"
+
+#include "config_block.h"
+#include "gamepad_report.h"
+
+#define MAX_FIELDS 16
+
+typedef enum
+{
+    FIELD_INPUT,
+    FIELD_OUTPUT,
+    FIELD_FEATURE,
+} field_type_t;
+
+// One Input/Output/Feature main item
+typedef struct
+{
+    field_type_t type;
+    uint8_t report_id;
+    unsigned offset; // Bit offset in the report, after the report ID byte
+    unsigned size;   // Report Size
+    unsigned count;  // Report Count
+    bool constant;
+    uint16_t usage_page;
+    uint16_t usage; // First local Usage or Usage Minimum
+    int32_t logical_min;
+    int32_t logical_max;
+} field_t;
+
+typedef struct
+{
+    field_t fields[MAX_FIELDS];
+    int num_fields;
+    unsigned bits[3][256]; // Running size of each report, by type and report ID
+    int depth;             // Open collections
+    bool error;
+} walk_t;
+
+static int32_t item_value(const uint8_t *data, unsigned len, bool is_signed)
+{
+    uint32_t v = 0;
+
+    for (unsigned i = 0; i < len; i++)
+    {
+        v |= (uint32_t)data[i] << (8 * i);
+    }
+    if (is_signed && len > 0 && len < 4 && (v & (1UL << (8 * len - 1))))
+    {
+        v |= ~0UL << (8 * len); // Sign-extend
+    }
+    return (int32_t)v;
+}
+
+// Short items only; a gamepad descriptor has no long items
+static void walk(walk_t *w, const uint8_t *desc, int len)
+{
+    uint16_t usage_page = 0, usage = 0;
+    unsigned report_size = 0, report_count = 0;
+    uint8_t report_id = 0;
+    int32_t logical_min = 0, logical_max = 0;
+    int pos = 0;
+
+    memset(w, 0, sizeof(*w));
+    while (pos < len)
+    {
+        uint8_t prefix = desc[pos];
+        unsigned data_len = (prefix & 0x03) == 3 ? 4 : prefix & 0x03;
+        const uint8_t *data = &desc[pos + 1];
+        uint8_t tag = prefix & 0xFC;
+
+        if (pos + 1 + (int)data_len > len)
+        {
+            w->error = true;
+            return;
+        }
+        int32_t value = item_value(data, data_len, false);
+        switch (tag)
+        {
+        case 0x04: // Usage Page
+            usage_page = (uint16_t)value;
+            break;
+        case 0x14: // Logical Minimum
+            logical_min = item_value(data, data_len, true);
+            break;
+        case 0x24: // Logical Maximum
+            logical_max = item_value(data, data_len, true);
+            break;
+        case 0x74: // Report Size
+            report_size = (unsigned)value;
+            break;
+        case 0x84: // Report ID
+            report_id = (uint8_t)value;
+            break;
+        case 0x94: // Report Count
+            report_count = (unsigned)value;
+            break;
+        case 0x08: // Usage
+        case 0x18: // Usage Minimum
+            if (!usage)
+            {
+                usage = (uint16_t)value;
+            }
+            break;
+        case 0x28: // Usage Maximum
+            break;
+        case 0xA0: // Collection
+            w->depth++;
+            usage = 0;
+            break;
+        case 0xC0: // End Collection
+            w->depth--;
+            break;
+        case 0x80: // Input
+        case 0x90: // Output
+        case 0xB0: // Feature
+        {
+            field_type_t type = tag == 0x80 ? FIELD_INPUT : tag == 0x90 ? FIELD_OUTPUT : FIELD_FEATURE;
+            if (w->num_fields == MAX_FIELDS)
+            {
+                w->error = true;
+                return;
+            }
+            field_t *f = &w->fields[w->num_fields++];
+            f->type = type;
+            f->report_id = report_id;
+            f->offset = w->bits[type][report_id];
+            f->size = report_size;
+            f->count = report_count;
+            f->constant = value & 0x01;
+            f->usage_page = usage_page;
+            f->usage = usage;
+            f->logical_min = logical_min;
+            f->logical_max = logical_max;
+            w->bits[type][report_id] += report_size * report_count;
+            usage = 0; // Local items end with the main item
+            break;
+        }
+        default:
+            w->error = true; // Nothing else is expected in this descriptor
+            return;
+        }
+        pos += 1 + data_len;
+    }
+}
+
+static const field_t *find_field(const walk_t *w, field_type_t type, uint8_t report_id, uint16_t usage_page,
+                                 uint16_t usage)
+{
+    for (int i = 0; i < w->num_fields; i++)
+    {
+        const field_t *f = &w->fields[i];
+        if (f->type == type && f->report_id == report_id && f->usage_page == usage_page && f->usage == usage &&
+            !f->constant)
+        {
+            return f;
+        }
+    }
+    return NULL;
+}
+
+// Field bits of a report, least significant bit first as HID lays them out
+static uint32_t get_bits(const uint8_t *buf, unsigned offset, unsigned size)
+{
+    uint32_t v = 0;
+
+    for (unsigned i = 0; i < size; i++)
+    {
+        v |= (uint32_t)((buf[(offset + i) / 8] >> ((offset + i) % 8)) & 1) << i;
+    }
+    return v;
+}
+
+static int32_t get_signed(const uint8_t *buf, unsigned offset, unsigned size)
+{
+    uint32_t v = get_bits(buf, offset, size);
+
+    if (size < 32 && (v & (1UL << (size - 1))))
+    {
+        v |= ~0UL << size;
+    }
+    return (int32_t)v;
+}
+
+static walk_t s_walk;
+
+static void test_well_formed(void)
+{
+    walk(&s_walk, gamepad_report_descriptor, gamepad_report_descriptor_len);
+    CHECK(!s_walk.error);
+    CHECK_EQ(s_walk.depth, 0);
+
+    // Every report is a whole number of bytes, and only the three known ones exist
+    for (int type = 0; type < 3; type++)
+    {
+        for (int id = 0; id < 256; id++)
+        {
+            CHECK_EQ(s_walk.bits[type][id] % 8, 0);
+        }
+    }
+    CHECK_EQ(s_walk.bits[FIELD_INPUT][0], 0); // Report IDs are always in use
+    for (int id = 0; id < 256; id++)
+    {
+        if (id != GAMEPAD_REPORT_ID)
+        {
+            CHECK_EQ(s_walk.bits[FIELD_INPUT][id], 0);
+        }
+        if (id != GAMEPAD_CONFIG_REPORT_ID)
+        {
+            CHECK_EQ(s_walk.bits[FIELD_FEATURE][id], 0);
+        }
+        if (id != GAMEPAD_OUTPUT_REPORT_ID)
+        {
+            CHECK_EQ(s_walk.bits[FIELD_OUTPUT][id], 0);
+        }
+    }
+}
+
+static void test_input_report(void)
+{
+    gamepad_state_t state = {0};
+    uint8_t report[GAMEPAD_REPORT_SIZE];
+
+    CHECK_EQ(s_walk.bits[FIELD_INPUT][GAMEPAD_REPORT_ID], GAMEPAD_REPORT_BITS);
+    CHECK_EQ(gamepad_report_pack(&state, report), s_walk.bits[FIELD_INPUT][GAMEPAD_REPORT_ID] / 8);
+
+    // Each axis sits where the descriptor says, signed and within its logical range
+    static const uint16_t usages[GAMEPAD_NUM_AXES] = {
+#define AXIS_USAGE(name, channel, usage, bits) usage,
+        GAMEPAD_AXIS_LIST(AXIS_USAGE)
+#undef AXIS_USAGE
+    };
+    static const int16_t values[] = {0, 1, -1, 12345, -12345, INT16_MAX, INT16_MIN};
+    for (int axis = 0; axis < GAMEPAD_NUM_AXES; axis++)
+    {
+        const field_t *f = find_field(&s_walk, FIELD_INPUT, GAMEPAD_REPORT_ID, 0x01, usages[axis]);
+        CHECK(f != NULL);
+        if (!f)
+        {
+            continue;
+        }
+        CHECK_EQ(f->count, 1);
+        CHECK_EQ(f->size, GAMEPAD_AXIS_BITS);
+        CHECK_EQ(f->logical_min, -(1 << (f->size - 1)));
+        CHECK_EQ(f->logical_max, (1 << (f->size - 1)) - 1);
+        for (unsigned v = 0; v < sizeof(values) / sizeof(values[0]); v++)
+        {
+            memset(&state, 0, sizeof(state));
+            state.axes[axis] = values[v];
+            state.buttons = GAMEPAD_ALL_BUTTONS_MASK; // Must not leak into the axis
+            gamepad_report_pack(&state, report);
+            int32_t got = get_signed(report, f->offset, f->size);
+            CHECK_EQ(got, values[v] >> (16 - f->size));
+            CHECK(got >= f->logical_min && got <= f->logical_max);
+            for (int other = 0; other < GAMEPAD_NUM_AXES; other++)
+            {
+                const field_t *o = find_field(&s_walk, FIELD_INPUT, GAMEPAD_REPORT_ID, 0x01, usages[other]);
+                if (o && other != axis)
+                {
+                    CHECK_EQ(get_bits(report, o->offset, o->size), 0);
+                }
+            }
+        }
+    }
+
+    // Button n + 1 is bit n of the button field, one bit per button
+    const field_t *buttons = find_field(&s_walk, FIELD_INPUT, GAMEPAD_REPORT_ID, 0x09, 1);
+    CHECK(buttons != NULL);
+    if (!buttons)
+    {
+        return;
+    }
+    CHECK_EQ(buttons->size, 1);
+    CHECK_EQ(buttons->count, GAMEPAD_NUM_BUTTONS);
+    CHECK_EQ(buttons->offset, GAMEPAD_REPORT_BUTTONS_OFFSET);
+    for (int b = 0; b < GAMEPAD_NUM_BUTTONS; b++)
+    {
+        memset(&state, 0, sizeof(state));
+        state.buttons = (gamepad_buttons_t)1 << b;
+        gamepad_report_pack(&state, report);
+        for (int other = 0; other < GAMEPAD_NUM_BUTTONS; other++)
+        {
+            CHECK_EQ(get_bits(report, buttons->offset + other, 1), other == b);
+        }
+    }
+}
+
+static void test_feature_report(void)
+{
+    config_block_t cfg, parsed;
+    uint8_t block[CONFIG_BLOCK_SIZE];
+    bool save;
+
+    config_block_defaults(&cfg);
+    CHECK_EQ(s_walk.bits[FIELD_FEATURE][GAMEPAD_CONFIG_REPORT_ID], CONFIG_BLOCK_SIZE * 8);
+    CHECK_EQ(config_block_encode(&cfg, block), s_walk.bits[FIELD_FEATURE][GAMEPAD_CONFIG_REPORT_ID] / 8);
+    CHECK_EQ(config_block_parse(block, s_walk.bits[FIELD_FEATURE][GAMEPAD_CONFIG_REPORT_ID] / 8, &parsed, &save),
+             CONFIG_BLOCK_OK);
+
+    // The block's read-only axis width matches the input report's axis fields
+    CHECK_EQ(block[2], GAMEPAD_AXIS_BITS);
+}
+
+static void test_output_report(void)
+{
+    unsigned bytes = s_walk.bits[FIELD_OUTPUT][GAMEPAD_OUTPUT_REPORT_ID] / 8;
+    uint8_t data[GAMEPAD_OUTPUT_REPORT_SIZE + 1] = {GAMEPAD_OUTPUT_REPORT_ID, 0x80, 0x40, 0xFF};
+    gamepad_output_t out;
+
+#if CONFIG_GAMEPAD_OUTPUT_REPORT
+    CHECK_EQ(bytes, GAMEPAD_OUTPUT_REPORT_SIZE);
+
+    // Motors are the first two bytes, the player LEDs the low bits of the third
+    const field_t *motors = find_field(&s_walk, FIELD_OUTPUT, GAMEPAD_OUTPUT_REPORT_ID, 0xFF00, 0x02);
+    const field_t *leds = find_field(&s_walk, FIELD_OUTPUT, GAMEPAD_OUTPUT_REPORT_ID, 0x08, 0x61);
+    CHECK(motors != NULL && leds != NULL);
+    if (motors && leds)
+    {
+        CHECK_EQ(motors->offset, 0);
+        CHECK_EQ(motors->size * motors->count, 16);
+        CHECK_EQ(leds->offset, 16);
+        CHECK_EQ(leds->size * leds->count, GAMEPAD_PLAYER_LEDS);
+    }
+
+    // The declared length is accepted with and without the report ID in front
+    CHECK(gamepad_output_parse(data + 1, bytes, &out));
+    CHECK(gamepad_output_parse(data, bytes + 1, &out));
+    CHECK_EQ(out.rumble_strong, 0x80);
+    CHECK_EQ(out.rumble_weak, 0x40);
+    CHECK_EQ(out.player_leds, (1U << GAMEPAD_PLAYER_LEDS) - 1);
+    CHECK(!gamepad_output_parse(data + 1, bytes - 1, &out));
+#else
+    CHECK_EQ(bytes, 0);
+    (void)data;
+    (void)out;
+#endif
+}
+
+int main(void)
+{
+    RUN_TEST(test_well_formed);
+    RUN_TEST(test_input_report);
+    RUN_TEST(test_feature_report);
+    RUN_TEST(test_output_report);
+    TEST_EXIT();
+}
@@ -0,0 +1,362 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// GET_REPORT and SET_REPORT as the host issues them, through the fake transport's
+// callbacks into report_requests and the runtime settings.
+#include <string.h>
+
+#include "check.h"
+
+#include "config_block.h"
+#include "fake_actuator.h"
+#include "gamepad_report.h"
+#include "gamepad_transport_fake.h"
+#include "nvs.h"
+#include "report_requests.h"
+#include "runtime_config.h"
+
+#define MIN_INTERVAL_US 4000
+
+static report_scheduler_t s_sched;
+static report_requests_t s_requests;
+
+static uint16_t get_report(gamepad_report_type_t type, uint8_t report_id, uint8_t *buf, uint16_t size)
+{
+    return report_requests_get(&s_requests, type, report_id, buf, size);
+}
+
+static gamepad_set_report_status_t set_report(gamepad_report_type_t type, uint8_t report_id, const uint8_t *data,
+                                              uint16_t len)
+{
+    return report_requests_set(&s_requests, type, report_id, data, len);
+}
+
+static void set_protocol(bool boot)
+{
+    report_requests_set_protocol(&s_requests, boot);
+}
+
+static const gamepad_transport_callbacks_t s_callbacks = {
+    .get_report = get_report,
+    .set_report = set_report,
+    .set_protocol = set_protocol,
+};
+
+static void setup(void)
+{
+    report_scheduler_config_t config = {.axis_deadband = 256, .keepalive_ms = 0, .min_interval_us = MIN_INTERVAL_US};
+
+    nvs_fake_erase_all();
+    runtime_config_init();
+    report_scheduler_init(&s_sched, &config);
+    report_requests_init(&s_requests, &s_sched);
+    gamepad_transport_start(&s_callbacks);
+    gamepad_transport_fake_connect();
+    fake_actuator_set_accept(true);
+}
+
+// A settings block as the host would write it, starting from what GET_REPORT returned
+static void read_block(uint8_t *block)
+{
+    uint8_t buf[GAMEPAD_TRANSPORT_MAX_REPORT];
+
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, buf,
+                                               sizeof(buf)),
+             CONFIG_BLOCK_SIZE);
+    memcpy(block, buf, CONFIG_BLOCK_SIZE);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static void test_get_input(void)
+{
+    gamepad_state_t state = {.buttons = 0x8001, .axes = {100, -200, 300, -400}};
+    uint8_t packed[GAMEPAD_REPORT_SIZE];
+    uint8_t buf[GAMEPAD_TRANSPORT_MAX_REPORT];
+
+    setup();
+    report_scheduler_update(&s_sched, &state, 0);
+
+    // Before the first report the host reads an all-zero one
+    memset(packed, 0, sizeof(packed));
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_INPUT, GAMEPAD_REPORT_ID, buf, sizeof(buf)),
+             GAMEPAD_REPORT_SIZE);
+    CHECK(memcmp(buf, packed, GAMEPAD_REPORT_SIZE) == 0);
+
+    // Then whatever the input task published last
+    report_requests_publish(&s_requests, packed, gamepad_report_pack(&state, packed));
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_INPUT, GAMEPAD_REPORT_ID, buf, sizeof(buf)),
+             GAMEPAD_REPORT_SIZE);
+    CHECK(memcmp(buf, packed, GAMEPAD_REPORT_SIZE) == 0);
+
+    // and a fresh interrupt report follows once the minimum interval allows it
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, MIN_INTERVAL_US - 1), REPORT_SEND_NONE);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, MIN_INTERVAL_US), REPORT_SEND_FORCED);
+}
+
+static void test_get_input_boot_protocol(void)
+{
+    gamepad_state_t state = {0};
+    uint8_t buf[GAMEPAD_TRANSPORT_MAX_REPORT];
+
+    setup();
+    report_scheduler_update(&s_sched, &state, 0);
+
+    // No boot protocol report for a gamepad, and nothing is forced
+    gamepad_transport_fake_set_protocol(true);
+    CHECK(report_requests_boot_protocol(&s_requests));
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_INPUT, GAMEPAD_REPORT_ID, buf, sizeof(buf)), 0);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, MIN_INTERVAL_US), REPORT_SEND_NONE);
+
+    gamepad_transport_fake_set_protocol(false);
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_INPUT, GAMEPAD_REPORT_ID, buf, sizeof(buf)),
+             GAMEPAD_REPORT_SIZE);
+}
+
+static void test_get_feature(void)
+{
+    uint8_t block[CONFIG_BLOCK_SIZE];
+    config_block_t cfg = {0};
+    bool save = true;
+
+    setup();
+    read_block(block);
+    CHECK_EQ(block[0], CONFIG_BLOCK_VERSION);
+    CHECK_EQ(block[2], GAMEPAD_AXIS_BITS);
+    CHECK_EQ(config_block_parse(block, sizeof(block), &cfg, &save), CONFIG_BLOCK_OK);
+    CHECK(!save);
+    CHECK(!cfg.fixed_rate);
+    CHECK_EQ(cfg.axis_deadband, CONFIG_GAMEPAD_AXIS_DEADBAND);
+    CHECK_EQ(cfg.keepalive_ms, CONFIG_GAMEPAD_KEEPALIVE_MS);
+    CHECK_EQ(cfg.sample_us, CONFIG_GAMEPAD_ACTIVE_SAMPLE_PERIOD_US);
+    CHECK_EQ(cfg.report_us, CONFIG_GAMEPAD_ACTIVE_REPORT_INTERVAL_US);
+    CHECK_EQ(cfg.idle_timeout_ms, CONFIG_GAMEPAD_IDLE_TIMEOUT_MS);
+
+    // Settings stay readable in boot protocol mode
+    uint8_t again[CONFIG_BLOCK_SIZE];
+    gamepad_transport_fake_set_protocol(true);
+    read_block(again);
+    CHECK(memcmp(block, again, sizeof(block)) == 0);
+}
+
+static void test_get_unknown(void)
+{
+    uint8_t buf[GAMEPAD_TRANSPORT_MAX_REPORT];
+
+    setup();
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_INPUT, GAMEPAD_CONFIG_REPORT_ID, buf,
+                                               sizeof(buf)),
+             0);
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_REPORT_ID, buf, sizeof(buf)),
+             0);
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_OUTPUT, GAMEPAD_OUTPUT_REPORT_ID, buf,
+                                               sizeof(buf)),
+             0);
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_INPUT, 0x7f, buf, sizeof(buf)), 0);
+}
+
+static void test_set_feature_ok(void)
+{
+    uint8_t block[CONFIG_BLOCK_SIZE];
+    uint8_t with_id[CONFIG_BLOCK_SIZE + 1];
+    config_block_t cfg;
+
+    setup();
+    read_block(block);
+    uint32_t generation = runtime_config_generation();
+
+    put_le32(block + 8, 2000); // sample_us
+    block[1] = CONFIG_BLOCK_FLAG_FIXED_RATE;
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, block,
+                                               sizeof(block)),
+             GAMEPAD_SET_REPORT_OK);
+    CHECK_EQ(runtime_config_generation(), generation + 1);
+    runtime_config_get(&cfg);
+    CHECK_EQ(cfg.sample_us, 2000);
+    CHECK(cfg.fixed_rate);
+
+    // Read back as written
+    uint8_t again[CONFIG_BLOCK_SIZE];
+    read_block(again);
+    CHECK(memcmp(block, again, sizeof(block)) == 0);
+
+    // Some hosts leave the report ID in front of the payload
+    put_le32(block + 8, 3000);
+    with_id[0] = GAMEPAD_CONFIG_REPORT_ID;
+    memcpy(with_id + 1, block, sizeof(block));
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, with_id,
+                                               sizeof(with_id)),
+             GAMEPAD_SET_REPORT_OK);
+    runtime_config_get(&cfg);
+    CHECK_EQ(cfg.sample_us, 3000);
+    CHECK_EQ(runtime_config_generation(), generation + 2);
+}
+
+static void test_set_feature_invalid(void)
+{
+    uint8_t good[CONFIG_BLOCK_SIZE];
+    uint8_t block[CONFIG_BLOCK_SIZE + 1];
+    uint8_t before[CONFIG_BLOCK_SIZE];
+    uint8_t after[CONFIG_BLOCK_SIZE];
+
+    setup();
+    read_block(good);
+    memcpy(before, good, sizeof(good));
+    uint32_t generation = runtime_config_generation();
+
+    // Short, long, and a leading byte that isn't the report ID
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, good,
+                                               CONFIG_BLOCK_SIZE - 1),
+             GAMEPAD_SET_REPORT_INVALID);
+    block[0] = 0x55;
+    memcpy(block + 1, good, sizeof(good));
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, block,
+                                               sizeof(block)),
+             GAMEPAD_SET_REPORT_INVALID);
+
+    // Another version
+    memcpy(block, good, sizeof(good));
+    block[0] = CONFIG_BLOCK_VERSION + 1;
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, block,
+                                               CONFIG_BLOCK_SIZE),
+             GAMEPAD_SET_REPORT_INVALID);
+
+    // Out of range: a sample period below the minimum, and a reserved flag
+    memcpy(block, good, sizeof(good));
+    put_le32(block + 8, 100);
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, block,
+                                               CONFIG_BLOCK_SIZE),
+             GAMEPAD_SET_REPORT_INVALID);
+    memcpy(block, good, sizeof(good));
+    block[1] = 0x80;
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, block,
+                                               CONFIG_BLOCK_SIZE),
+             GAMEPAD_SET_REPORT_INVALID);
+
+    // None of them changed anything
+    CHECK_EQ(runtime_config_generation(), generation);
+    read_block(after);
+    CHECK(memcmp(before, after, sizeof(after)) == 0);
+}
+
+static void test_set_feature_save(void)
+{
+    uint8_t block[CONFIG_BLOCK_SIZE];
+    config_block_t cfg;
+
+    setup();
+    read_block(block);
+
+    // Applied straight away, but the Bluetooth task doesn't touch the flash
+    put_le32(block + 12, 8000); // report_us
+    block[1] = CONFIG_BLOCK_FLAG_SAVE;
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, block,
+                                               sizeof(block)),
+             GAMEPAD_SET_REPORT_OK);
+    runtime_config_get(&cfg);
+    CHECK_EQ(cfg.report_us, 8000);
+    CHECK_EQ(nvs_fake_writes(), 0);
+
+    // A later write without the flag is what the input task stores, once
+    put_le32(block + 12, 9000);
+    block[1] = 0;
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, block,
+                                               sizeof(block)),
+             GAMEPAD_SET_REPORT_OK);
+    CHECK(runtime_config_save_if_requested());
+    CHECK_EQ(nvs_fake_writes(), 1);
+    CHECK_EQ(nvs_fake_commits(), 1);
+    CHECK(!runtime_config_save_if_requested());
+    CHECK_EQ(nvs_fake_writes(), 1);
+
+    // Loaded on the next boot; nothing to save until the host asks again
+    runtime_config_init();
+    runtime_config_get(&cfg);
+    CHECK_EQ(cfg.report_us, 9000);
+    CHECK(!runtime_config_save_if_requested());
+
+    // A rejected block asks for nothing
+    block[0] = CONFIG_BLOCK_VERSION + 1;
+    block[1] = CONFIG_BLOCK_FLAG_SAVE;
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, block,
+                                               sizeof(block)),
+             GAMEPAD_SET_REPORT_INVALID);
+    CHECK(!runtime_config_save_if_requested());
+}
+
+static void test_set_unknown(void)
+{
+    uint8_t block[CONFIG_BLOCK_SIZE];
+    uint8_t output[3] = {0x80, 0x40, 0x01};
+
+    setup();
+    read_block(block);
+    uint32_t generation = runtime_config_generation();
+
+    // A valid block under the wrong ID or type is not a settings write
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_REPORT_ID, block, sizeof(block)),
+             GAMEPAD_SET_REPORT_UNKNOWN_ID);
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_OUTPUT, GAMEPAD_CONFIG_REPORT_ID, block,
+                                               sizeof(block)),
+             GAMEPAD_SET_REPORT_UNKNOWN_ID);
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_INPUT, GAMEPAD_REPORT_ID, block, sizeof(block)),
+             GAMEPAD_SET_REPORT_UNKNOWN_ID);
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_FEATURE, 0x7f, block, sizeof(block)),
+             GAMEPAD_SET_REPORT_UNKNOWN_ID);
+    CHECK_EQ(runtime_config_generation(), generation);
+
+    // Output reports only under their own ID
+    unsigned submits = fake_actuator_submits();
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_OUTPUT, GAMEPAD_REPORT_ID, output, sizeof(output)),
+             GAMEPAD_SET_REPORT_UNKNOWN_ID);
+    CHECK_EQ(fake_actuator_submits(), submits);
+}
+
+static void test_set_output(void)
+{
+    uint8_t output[3] = {0x80, 0x40, 0x01};
+    uint8_t buf[32];
+
+    setup();
+    unsigned submits = fake_actuator_submits();
+#if CONFIG_GAMEPAD_OUTPUT_REPORT
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_OUTPUT, GAMEPAD_OUTPUT_REPORT_ID, output,
+                                               sizeof(output)),
+             GAMEPAD_SET_REPORT_OK);
+    CHECK_EQ(fake_actuator_submits(), submits + 1);
+    CHECK_EQ(fake_actuator_last(buf), sizeof(output));
+    CHECK(memcmp(buf, output, sizeof(output)) == 0);
+
+    // The actuator decides what is malformed
+    fake_actuator_set_accept(false);
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_OUTPUT, GAMEPAD_OUTPUT_REPORT_ID, output, 1),
+             GAMEPAD_SET_REPORT_INVALID);
+    CHECK_EQ(fake_actuator_submits(), submits + 2);
+#else
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_OUTPUT, GAMEPAD_OUTPUT_REPORT_ID, output,
+                                               sizeof(output)),
+             GAMEPAD_SET_REPORT_UNKNOWN_ID);
+    CHECK_EQ(fake_actuator_submits(), submits);
+    (void)buf;
+#endif
+}
+
+int main(void)
+{
+    RUN_TEST(test_get_input);
+    RUN_TEST(test_get_input_boot_protocol);
+    RUN_TEST(test_get_feature);
+    RUN_TEST(test_get_unknown);
+    RUN_TEST(test_set_feature_ok);
+    RUN_TEST(test_set_feature_invalid);
+    RUN_TEST(test_set_feature_save);
+    RUN_TEST(test_set_unknown);
+    RUN_TEST(test_set_output);
+    TEST_EXIT();
+}
@@ -0,0 +1,179 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "check.h"
+
+#include "report_scheduler.h"
+
+#define DEADBAND 256
+#define KEEPALIVE_MS 1000
+#define MIN_INTERVAL_US 4000
+
+static report_scheduler_t s_sched;
+
+static void setup(void)
+{
+    report_scheduler_config_t config = {
+        .axis_deadband = DEADBAND,
+        .keepalive_ms = KEEPALIVE_MS,
+        .min_interval_us = MIN_INTERVAL_US};
+    report_scheduler_init(&s_sched, &config);
+}
+
+static gamepad_state_t centred(void)
+{
+    gamepad_state_t state = {0};
+    return state;
+}
+
+static void test_first_report(void)
+{
+    gamepad_state_t state = centred();
+
+    setup();
+    CHECK(report_scheduler_has_change(&s_sched, &state));
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, 0), REPORT_SEND_FIRST);
+    CHECK(!report_scheduler_has_change(&s_sched, &state));
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, 10000), REPORT_SEND_NONE);
+
+    // Reset forgets the last report, e.g. on a new connection
+    report_scheduler_reset(&s_sched);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, 10001), REPORT_SEND_FIRST);
+}
+
+static void test_button_edge(void)
+{
+    gamepad_state_t state = centred();
+
+    setup();
+    report_scheduler_update(&s_sched, &state, 0);
+
+    // Button edges go out straight away, inside the minimum interval
+    state.buttons = 1;
+    CHECK(report_scheduler_has_change(&s_sched, &state));
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, 1), REPORT_SEND_BUTTONS);
+    state.buttons = 0;
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, 2), REPORT_SEND_BUTTONS);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, 3), REPORT_SEND_NONE);
+}
+
+static void test_axis_deadband(void)
+{
+    gamepad_state_t state = centred();
+    int64_t now_us = 0;
+
+    setup();
+    report_scheduler_update(&s_sched, &state, now_us);
+
+    // A move of exactly the deadband is noise, in either direction and on any axis
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        now_us += MIN_INTERVAL_US;
+        state.axes[i] = DEADBAND;
+        CHECK(!report_scheduler_has_change(&s_sched, &state));
+        CHECK_EQ(report_scheduler_update(&s_sched, &state, now_us), REPORT_SEND_NONE);
+        state.axes[i] = -DEADBAND;
+        CHECK_EQ(report_scheduler_update(&s_sched, &state, now_us), REPORT_SEND_NONE);
+        state.axes[i] = 0;
+    }
+
+    // One more is a move, measured from the last report and not from the previous sample
+    now_us += MIN_INTERVAL_US;
+    state.axes[3] = -DEADBAND - 1;
+    CHECK(report_scheduler_has_change(&s_sched, &state));
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, now_us), REPORT_SEND_AXES);
+    now_us += MIN_INTERVAL_US;
+    state.axes[3] = -1;
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, now_us), REPORT_SEND_NONE);
+    state.axes[3] = 0;
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, now_us), REPORT_SEND_AXES);
+}
+
+static void test_keepalive(void)
+{
+    gamepad_state_t state = centred();
+
+    setup();
+    report_scheduler_update(&s_sched, &state, 0);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, KEEPALIVE_MS * 1000 - 1), REPORT_SEND_NONE);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, KEEPALIVE_MS * 1000), REPORT_SEND_KEEPALIVE);
+    // The keepalive counts as a report, the next one is a full interval later
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, KEEPALIVE_MS * 1000 + 1), REPORT_SEND_NONE);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, 2 * KEEPALIVE_MS * 1000), REPORT_SEND_KEEPALIVE);
+
+    // 0 turns it off, set_rate changes it on the fly as the governor does when idle
+    report_scheduler_set_rate(&s_sched, MIN_INTERVAL_US, 0);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, 100 * KEEPALIVE_MS * 1000), REPORT_SEND_NONE);
+    report_scheduler_set_rate(&s_sched, MIN_INTERVAL_US, 10 * KEEPALIVE_MS);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, 101 * KEEPALIVE_MS * 1000), REPORT_SEND_KEEPALIVE);
+}
+
+static void test_forced(void)
+{
+    gamepad_state_t state = centred();
+
+    setup();
+    report_scheduler_update(&s_sched, &state, 0);
+    report_scheduler_force(&s_sched);
+
+    // A host request waits for the minimum interval like any other non-button report
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, MIN_INTERVAL_US - 1), REPORT_SEND_NONE);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, MIN_INTERVAL_US), REPORT_SEND_FORCED);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, 3 * MIN_INTERVAL_US), REPORT_SEND_NONE);
+
+    // Any other report answers it too
+    report_scheduler_force(&s_sched);
+    state.buttons = 1;
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, 4 * MIN_INTERVAL_US), REPORT_SEND_BUTTONS);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, 6 * MIN_INTERVAL_US), REPORT_SEND_NONE);
+}
+
+static void test_min_interval(void)
+{
+    gamepad_state_t state = centred();
+    int64_t now_us = 0;
+    int sent = 0;
+
+    setup();
+    report_scheduler_update(&s_sched, &state, 0);
+
+    // An axis moving every 1 ms for 100 ms is reported at most every MIN_INTERVAL_US
+    int64_t last_us = 0;
+    for (now_us = 1000; now_us <= 100000; now_us += 1000)
+    {
+        state.axes[0] += 2 * DEADBAND;
+        report_send_reason_t reason = report_scheduler_update(&s_sched, &state, now_us);
+        CHECK(reason == REPORT_SEND_NONE || reason == REPORT_SEND_AXES);
+        if (reason == REPORT_SEND_AXES)
+        {
+            CHECK(now_us - last_us >= MIN_INTERVAL_US);
+            last_us = now_us;
+            sent++;
+        }
+    }
+    CHECK_EQ(sent, 100000 / MIN_INTERVAL_US);
+
+    // A rate-limited move is still pending once the interval is over
+    now_us = last_us + 1;
+    state.axes[0] += 2 * DEADBAND;
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, now_us), REPORT_SEND_NONE);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, last_us + MIN_INTERVAL_US), REPORT_SEND_AXES);
+
+    // A slower rate from the governor applies from the next update
+    report_scheduler_set_rate(&s_sched, 5 * MIN_INTERVAL_US, KEEPALIVE_MS);
+    last_us += MIN_INTERVAL_US;
+    state.axes[0] += 2 * DEADBAND;
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, last_us + 4 * MIN_INTERVAL_US), REPORT_SEND_NONE);
+    CHECK_EQ(report_scheduler_update(&s_sched, &state, last_us + 5 * MIN_INTERVAL_US), REPORT_SEND_AXES);
+}
+
+int main(void)
+{
+    RUN_TEST(test_first_report);
+    RUN_TEST(test_button_edge);
+    RUN_TEST(test_axis_deadband);
+    RUN_TEST(test_keepalive);
+    RUN_TEST(test_forced);
+    RUN_TEST(test_min_interval);
+    TEST_EXIT();
+}
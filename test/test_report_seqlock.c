@@ -0,0 +1,163 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// One writer publishing numbered reports as fast as it can against several readers,
+// each checking that every report it copies is whole and that reports never go back.
+#include "check.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "report_seqlock.h"
+
+#define READERS 3
+#define RUN_NS 500000000ULL // Long enough for the scheduler to preempt readers mid-copy on a single core
+#define MIN_LEN 4
+
+static report_seqlock_t s_lock;
+static atomic_bool s_done;
+static uint32_t s_writes;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Report n: the number, then bytes derived from it, with a length that changes every write
+static uint16_t make_report(uint32_t n, uint8_t *buf)
+{
+    uint16_t len = MIN_LEN + n % (REPORT_SEQLOCK_CAPACITY - MIN_LEN + 1);
+
+    memcpy(buf, &n, sizeof(n));
+    for (uint16_t i = sizeof(n); i < len; i++)
+    {
+        buf[i] = (uint8_t)(n * 31 + i);
+    }
+    return len;
+}
+
+static bool report_whole(const uint8_t *buf, uint16_t len, uint32_t *n)
+{
+    uint8_t expected[REPORT_SEQLOCK_CAPACITY];
+
+    if (len < MIN_LEN)
+    {
+        return false;
+    }
+    memcpy(n, buf, sizeof(*n));
+    return make_report(*n, expected) == len && memcmp(buf, expected, len) == 0;
+}
+
+static void *writer(void *arg)
+{
+    uint8_t buf[REPORT_SEQLOCK_CAPACITY];
+    uint64_t end_ns = now_ns() + RUN_NS;
+    uint32_t n = 0;
+
+    do
+    {
+        for (int i = 0; i < 1000; i++)
+        {
+            n++;
+            report_seqlock_write(&s_lock, buf, make_report(n, buf));
+        }
+    } while (now_ns() < end_ns);
+    s_writes = n;
+    atomic_store(&s_done, true);
+    return NULL;
+}
+
+static void *reader(void *arg)
+{
+    unsigned *reads = arg;
+    uint8_t buf[REPORT_SEQLOCK_CAPACITY];
+    uint32_t last = 0;
+
+    while (!atomic_load(&s_done))
+    {
+        uint16_t len = report_seqlock_read(&s_lock, buf);
+        uint32_t n;
+
+        if (len == 0)
+        {
+            CHECK_EQ(last, 0); // Nothing published yet
+            continue;
+        }
+        if (!report_whole(buf, len, &n))
+        {
+            CHECK(!"torn report");
+            break;
+        }
+        if (n < last)
+        {
+            CHECK_EQ(n, last);
+            break;
+        }
+        last = n;
+        (*reads)++;
+    }
+    return NULL;
+}
+
+static void test_single_thread(void)
+{
+    uint8_t buf[REPORT_SEQLOCK_CAPACITY + 8];
+    uint8_t out[REPORT_SEQLOCK_CAPACITY];
+
+    report_seqlock_init(&s_lock);
+    CHECK_EQ(report_seqlock_read(&s_lock, out), 0);
+
+    for (uint32_t n = 1; n < 100; n++)
+    {
+        uint16_t len = make_report(n, buf);
+        uint32_t read_n;
+
+        report_seqlock_write(&s_lock, buf, len);
+        CHECK_EQ(report_seqlock_read(&s_lock, out), len);
+        CHECK(report_whole(out, len, &read_n));
+        CHECK_EQ(read_n, n);
+    }
+
+    // Longer than the buffer: cut to the capacity
+    memset(buf, 0xA5, sizeof(buf));
+    report_seqlock_write(&s_lock, buf, sizeof(buf));
+    CHECK_EQ(report_seqlock_read(&s_lock, out), REPORT_SEQLOCK_CAPACITY);
+    CHECK_EQ(out[REPORT_SEQLOCK_CAPACITY - 1], 0xA5);
+}
+
+static void test_concurrent_readers(void)
+{
+    pthread_t writer_thread, reader_threads[READERS];
+    unsigned reads[READERS] = {0};
+
+    report_seqlock_init(&s_lock);
+    atomic_store(&s_done, false);
+    for (int i = 0; i < READERS; i++)
+    {
+        pthread_create(&reader_threads[i], NULL, reader, &reads[i]);
+    }
+    pthread_create(&writer_thread, NULL, writer, NULL);
+    pthread_join(writer_thread, NULL);
+    for (int i = 0; i < READERS; i++)
+    {
+        pthread_join(reader_threads[i], NULL);
+        printf("  reader %d: %u whole reports\n", i, reads[i]);
+    }
+    printf("  %u reports written\n", s_writes);
+
+    // The last report stays published
+    uint8_t out[REPORT_SEQLOCK_CAPACITY];
+    uint32_t n;
+    CHECK(report_whole(out, report_seqlock_read(&s_lock, out), &n));
+    CHECK_EQ(n, s_writes);
+}
+
+int main(void)
+{
+    RUN_TEST(test_single_thread);
+    RUN_TEST(test_concurrent_readers);
+    TEST_EXIT();
+}
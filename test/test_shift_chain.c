@@ -0,0 +1,126 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// shift_chain_unpack for chains of 1 to 8 registers: register 0 arrives first and
+// input A is bit 0 of each byte, pressed inputs read low, and only the chain's own
+// buttons can be set in the mask. Built for a 64-input chain (see CMakeLists.txt).
+#include <string.h>
+
+#include "check.h"
+
+#include "shift_chain.h"
+
+#define MAX_REGISTERS 8
+#define RANDOM_SEED 0x165165u
+
+_Static_assert(sizeof(gamepad_buttons_t) * 8 >= MAX_REGISTERS * 8, "build with an 8-register chain");
+
+// Button 8k + n pressed when input n of register k reads low
+static gamepad_buttons_t reference_unpack(const uint8_t *rx, unsigned registers)
+{
+    gamepad_buttons_t mask = 0;
+
+    for (unsigned k = 0; k < registers; k++)
+    {
+        for (unsigned n = 0; n < 8; n++)
+        {
+            if (!(rx[k] & (1U << n)))
+            {
+                mask |= (gamepad_buttons_t)1 << (8 * k + n);
+            }
+        }
+    }
+    return mask;
+}
+
+static gamepad_buttons_t chain_mask(unsigned registers)
+{
+    return registers == sizeof(gamepad_buttons_t) ? (gamepad_buttons_t)-1
+                                                  : ((gamepad_buttons_t)1 << (registers * 8)) - 1;
+}
+
+static void test_nothing_and_everything(void)
+{
+    uint8_t rx[MAX_REGISTERS];
+
+    for (unsigned registers = 1; registers <= MAX_REGISTERS; registers++)
+    {
+        // Released inputs are pulled up
+        memset(rx, 0xFF, sizeof(rx));
+        CHECK_EQ(shift_chain_unpack(rx, registers), 0);
+
+        // Everything pressed sets exactly the chain's buttons, also when the bytes past
+        // the chain read low
+        memset(rx, 0x00, sizeof(rx));
+        CHECK(shift_chain_unpack(rx, registers) == chain_mask(registers));
+    }
+    CHECK(chain_mask(MAX_REGISTERS) == GAMEPAD_ALL_BUTTONS_MASK);
+}
+
+static void test_bit_order(void)
+{
+    uint8_t rx[MAX_REGISTERS];
+
+    for (unsigned registers = 1; registers <= MAX_REGISTERS; registers++)
+    {
+        for (unsigned k = 0; k < registers; k++)
+        {
+            for (unsigned n = 0; n < 8; n++)
+            {
+                memset(rx, 0xFF, sizeof(rx));
+                rx[k] = (uint8_t)~(1U << n); // Input n of register k pressed
+                CHECK(shift_chain_unpack(rx, registers) == (gamepad_buttons_t)1 << (8 * k + n));
+            }
+        }
+    }
+
+    // Register 0 is the first byte: input A of the first register is button 0, input H
+    // of the second is button 15
+    memset(rx, 0xFF, sizeof(rx));
+    rx[0] = 0xFE;
+    rx[1] = 0x7F;
+    CHECK(shift_chain_unpack(rx, 2) == ((gamepad_buttons_t)1 << 0 | (gamepad_buttons_t)1 << 15));
+}
+
+static void test_partial_chain(void)
+{
+    uint8_t rx[MAX_REGISTERS];
+
+    // Inputs of registers past the configured chain never show up
+    for (unsigned registers = 1; registers < MAX_REGISTERS; registers++)
+    {
+        memset(rx, 0xFF, sizeof(rx));
+        rx[registers] = 0x00;
+        CHECK_EQ(shift_chain_unpack(rx, registers), 0);
+        CHECK(shift_chain_unpack(rx, registers + 1) == (gamepad_buttons_t)0xFF << (8 * registers));
+    }
+}
+
+static void test_random_reads(void)
+{
+    uint32_t seed = RANDOM_SEED;
+    uint8_t rx[MAX_REGISTERS];
+
+    for (int round = 0; round < 10000; round++)
+    {
+        for (unsigned k = 0; k < MAX_REGISTERS; k++)
+        {
+            rx[k] = (uint8_t)test_rand(&seed);
+        }
+        for (unsigned registers = 1; registers <= MAX_REGISTERS; registers++)
+        {
+            gamepad_buttons_t mask = shift_chain_unpack(rx, registers);
+            CHECK(mask == reference_unpack(rx, registers));
+            CHECK((mask & ~chain_mask(registers)) == 0);
+        }
+    }
+}
+
+int main(void)
+{
+    RUN_TEST(test_nothing_and_everything);
+    RUN_TEST(test_bit_order);
+    RUN_TEST(test_partial_chain);
+    RUN_TEST(test_random_reads);
+    TEST_EXIT();
+}
@@ -0,0 +1,195 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// When the input task may doze: the settle time after going idle, activity and
+// outstanding work restarting it, the doze counters, and a button press waking a
+// dozing pad through the input pipeline on the next sample.
+#include "check.h"
+
+#include "axis_calibration.h"
+#include "config_block.h"
+#include "gamepad_hal.h"
+#include "gamepad_sim.h"
+#include "input_pipeline.h"
+#include "sleep_policy.h"
+
+#define SETTLE_MS 100
+#define SAMPLE_US 1000
+
+static const sleep_policy_config_t s_config = {.settle_ms = SETTLE_MS};
+static int16_t s_axis_lut[AXIS_LUT_SIZE];
+
+static void map_axes(const uint16_t raw[GAMEPAD_NUM_AXES], int16_t axes[GAMEPAD_NUM_AXES])
+{
+    for (int i = 0; i < GAMEPAD_NUM_AXES; i++)
+    {
+        axes[i] = axis_lut_apply(s_axis_lut, raw[i]);
+    }
+}
+
+// Feed idle, quiet samples every SAMPLE_US from start_us; returns the time of the one that started the doze
+static int64_t settle(sleep_policy_t *policy, int64_t start_us)
+{
+    for (int64_t now_us = start_us; now_us < start_us + 10 * SETTLE_MS * 1000; now_us += SAMPLE_US)
+    {
+        if (sleep_policy_update(policy, true, false, now_us))
+        {
+            return now_us;
+        }
+    }
+    return -1;
+}
+
+static void test_settle_time(void)
+{
+    sleep_policy_t policy;
+
+    // Dozes exactly settle_ms after the last busy sample, not before
+    sleep_policy_init(&policy, &s_config, 0);
+    CHECK_EQ(sleep_policy_state(&policy), SLEEP_POLICY_AWAKE);
+    CHECK_EQ(settle(&policy, 0), SETTLE_MS * 1000);
+    CHECK_EQ(sleep_policy_state(&policy), SLEEP_POLICY_DOZE);
+    CHECK_EQ(policy.dozes, 1);
+
+    // Without a settle time it dozes on the first idle, quiet sample
+    const sleep_policy_config_t none = {.settle_ms = 0};
+    sleep_policy_init(&policy, &none, 0);
+    CHECK(!sleep_policy_update(&policy, false, false, 0));
+    CHECK(sleep_policy_update(&policy, true, false, 1000));
+
+    // Never while the governor is active, however long
+    sleep_policy_init(&policy, &s_config, 0);
+    for (int64_t now_us = 0; now_us < 10 * SETTLE_MS * 1000; now_us += SAMPLE_US)
+    {
+        CHECK(!sleep_policy_update(&policy, false, false, now_us));
+    }
+    CHECK_EQ(policy.dozes, 0);
+}
+
+static void test_activity_resets_settle(void)
+{
+    sleep_policy_t policy;
+    int64_t now_us = 0;
+
+    sleep_policy_init(&policy, &s_config, 0);
+
+    // Work in flight halfway through the settle time restarts it
+    for (; now_us < SETTLE_MS * 500; now_us += SAMPLE_US)
+    {
+        CHECK(!sleep_policy_update(&policy, true, false, now_us));
+    }
+    CHECK(!sleep_policy_update(&policy, true, true, now_us));
+    int64_t busy_us = now_us;
+    CHECK_EQ(settle(&policy, now_us + SAMPLE_US), busy_us + SETTLE_MS * 1000);
+
+    // Activity wakes a doze straight away and the settle time starts over from there
+    now_us = busy_us + SETTLE_MS * 1000 + 30000;
+    CHECK(sleep_policy_update(&policy, false, false, now_us));
+    CHECK_EQ(sleep_policy_state(&policy), SLEEP_POLICY_AWAKE);
+    CHECK_EQ(settle(&policy, now_us + SAMPLE_US), now_us + SETTLE_MS * 1000);
+    CHECK_EQ(policy.dozes, 2);
+
+    // Work left over from a doze sample (a keepalive in flight) doesn't wake it
+    CHECK(!sleep_policy_update(&policy, true, true, now_us + 200000));
+    CHECK_EQ(sleep_policy_state(&policy), SLEEP_POLICY_DOZE);
+}
+
+static void test_doze_time(void)
+{
+    sleep_policy_t policy;
+
+    sleep_policy_init(&policy, &s_config, 1000000);
+    CHECK_EQ(sleep_policy_doze_us(&policy, 2000000), 0);
+    int64_t doze_us = settle(&policy, 1000000);
+    CHECK_EQ(doze_us, 1100000);
+
+    // Counted while dozing, kept after waking, summed over dozes
+    CHECK_EQ(sleep_policy_doze_us(&policy, doze_us + 40000), 40000);
+    CHECK(sleep_policy_update(&policy, false, false, doze_us + 50000));
+    CHECK_EQ(sleep_policy_doze_us(&policy, doze_us + 900000), 50000);
+    doze_us = settle(&policy, doze_us + 51000);
+    CHECK(sleep_policy_update(&policy, false, false, doze_us + 7000));
+    CHECK_EQ(sleep_policy_doze_us(&policy, doze_us + 8000), 57000);
+    CHECK_EQ(policy.dozes, 2);
+
+    // A new connection starts from zero
+    sleep_policy_init(&policy, &s_config, doze_us + 9000);
+    CHECK_EQ(sleep_policy_doze_us(&policy, doze_us + 9000), 0);
+    CHECK_EQ(policy.dozes, 0);
+}
+
+// The input task's loop: still sticks until the pad goes idle and dozes, then a button press
+static void test_button_wakes(void)
+{
+    static gamepad_sim_frame_t frames[2];
+    static input_pipeline_t input;
+    uint32_t press_us = CONFIG_GAMEPAD_IDLE_TIMEOUT_MS * 1000 + 2000000;
+    sleep_policy_t policy;
+    config_block_t cfg;
+    axis_calibration_t cal;
+    int64_t doze_us = -1, wake_us = -1, report_us = -1;
+
+    for (int i = 0; i < 2; i++)
+    {
+        frames[i].time_us = i ? press_us : 0;
+        frames[i].buttons = i ? 1U << GAMEPAD_BUTTON_A : 0;
+        for (int a = 0; a < GAMEPAD_NUM_AXES; a++)
+        {
+            frames[i].axes[a] = 2048;
+        }
+    }
+    axis_calibration_default(&cal);
+    axis_lut_build(s_axis_lut, &cal, AXIS_CURVE_LINEAR);
+
+    gamepad_sim_load(frames, 2);
+    gamepad_hal_input_init();
+    config_block_defaults(&cfg);
+    input_pipeline_init(&input, map_axes);
+    input_pipeline_configure(&input, &cfg, 0);
+    input_pipeline_start(&input);
+    sleep_policy_init(&policy, &s_config, 0);
+
+    for (uint32_t now_us = 0; now_us < press_us + 1000000; now_us += rate_governor_sample_us(&input.governor))
+    {
+        uint32_t first_edge_us;
+        input_sample_t sample;
+
+        gamepad_sim_advance(now_us);
+        input_pipeline_sample(&input, gamepad_hal_take_edges(&first_edge_us), now_us, &sample);
+        bool idle = rate_governor_state(&input.governor) == RATE_GOVERNOR_IDLE;
+        if (sleep_policy_update(&policy, idle, input_pipeline_busy(&input), now_us))
+        {
+            if (sleep_policy_state(&policy) == SLEEP_POLICY_DOZE)
+            {
+                CHECK(doze_us < 0);
+                doze_us = now_us;
+            }
+            else
+            {
+                wake_us = now_us;
+            }
+        }
+        if (input_pipeline_report(&input, &sample, now_us) == REPORT_SEND_BUTTONS && report_us < 0)
+        {
+            report_us = now_us;
+        }
+    }
+
+    // Dozed once idle and settled, woke on the first sample that saw the press, and
+    // reported it from that same sample
+    CHECK(doze_us >= CONFIG_GAMEPAD_IDLE_TIMEOUT_MS * 1000 + SETTLE_MS * 1000);
+    CHECK(doze_us < press_us);
+    CHECK(wake_us >= press_us);
+    CHECK(wake_us < press_us + CONFIG_GAMEPAD_IDLE_SAMPLE_PERIOD_US);
+    CHECK_EQ(report_us, wake_us);
+    CHECK_EQ(policy.dozes, 1);
+}
+
+int main(void)
+{
+    RUN_TEST(test_settle_time);
+    RUN_TEST(test_activity_resets_settle);
+    RUN_TEST(test_doze_time);
+    RUN_TEST(test_button_wakes);
+    TEST_EXIT();
+}
@@ -0,0 +1,197 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+
+#include "bench.h"
+
+#include "trace_ring.h"
+
+#define RING_SIZE 64
+#define WRITERS 4
+#define RUN_NS 500000000LL // Long enough for the scheduler to preempt a copy mid-record on a single core
+
+static trace_slot_t s_slots[RING_SIZE];
+static trace_ring_t s_ring;
+
+// A record that can tell whether it was torn: every field follows from writer and seq
+static trace_record_t make_record(uint16_t writer, uint32_t seq)
+{
+    trace_record_t record = {
+        .timestamp_us = ((uint32_t)writer << 24) | seq,
+        .event = writer,
+        .args = {(uint16_t)seq, (uint16_t)(seq >> 16), (uint16_t)(seq * 3), (uint16_t)(writer ^ seq)},
+    };
+    return record;
+}
+
+static bool record_intact(const trace_record_t *record)
+{
+    uint16_t writer = record->event;
+    uint32_t seq = record->timestamp_us & 0xffffff;
+    trace_record_t expected = make_record(writer, seq);
+
+    return writer < WRITERS && record->timestamp_us == expected.timestamp_us &&
+           record->args[0] == expected.args[0] && record->args[1] == expected.args[1] &&
+           record->args[2] == expected.args[2] && record->args[3] == expected.args[3];
+}
+
+static void test_in_order(void)
+{
+    trace_record_t record;
+
+    trace_ring_init(&s_ring, s_slots, RING_SIZE);
+    CHECK(!trace_ring_read(&s_ring, &record));
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        trace_record_t r = make_record(0, i);
+        trace_ring_write(&s_ring, &r);
+    }
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        CHECK(trace_ring_read(&s_ring, &record));
+        CHECK(record_intact(&record));
+        CHECK_EQ(record.timestamp_us, i);
+    }
+    CHECK(!trace_ring_read(&s_ring, &record));
+    CHECK_EQ(trace_ring_take_lost(&s_ring), 0);
+}
+
+static void test_wrap_keeps_newest(void)
+{
+    trace_record_t record;
+    uint32_t total = 3 * RING_SIZE + 5;
+
+    // A reader that fell behind gets the newest RING_SIZE records and a count of the rest
+    trace_ring_init(&s_ring, s_slots, RING_SIZE);
+    for (uint32_t i = 0; i < total; i++)
+    {
+        trace_record_t r = make_record(1, i);
+        trace_ring_write(&s_ring, &r);
+    }
+    for (uint32_t i = total - RING_SIZE; i < total; i++)
+    {
+        CHECK(trace_ring_read(&s_ring, &record));
+        CHECK_EQ(record.timestamp_us & 0xffffff, i);
+    }
+    CHECK(!trace_ring_read(&s_ring, &record));
+    CHECK_EQ(trace_ring_take_lost(&s_ring), total - RING_SIZE);
+    CHECK_EQ(trace_ring_take_lost(&s_ring), 0);
+
+    // The index keeps counting across the wrap of the 32-bit head
+    trace_ring_init(&s_ring, s_slots, RING_SIZE);
+    atomic_store(&s_ring.head, UINT32_MAX - 2);
+    s_ring.tail = UINT32_MAX - 2;
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        trace_record_t r = make_record(2, i);
+        trace_ring_write(&s_ring, &r);
+    }
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        CHECK(trace_ring_read(&s_ring, &record));
+        CHECK_EQ(record.timestamp_us & 0xffffff, i);
+    }
+    CHECK(!trace_ring_read(&s_ring, &record));
+    CHECK_EQ(trace_ring_take_lost(&s_ring), 0);
+}
+
+static atomic_int s_writers_done;
+static atomic_bool s_stop;
+static uint32_t s_written[WRITERS];
+
+static void *writer_thread(void *arg)
+{
+    uint16_t writer = (uint16_t)(uintptr_t)arg;
+    uint32_t seq;
+
+    for (seq = 0; !atomic_load_explicit(&s_stop, memory_order_relaxed) && seq < 0xffffff; seq++)
+    {
+        trace_record_t r = make_record(writer, seq);
+        trace_ring_write(&s_ring, &r);
+        if ((seq & 255) == 0)
+        {
+            sched_yield(); // Let the others in, also on a single CPU
+        }
+    }
+    s_written[writer] = seq;
+    atomic_fetch_add(&s_writers_done, 1);
+    return NULL;
+}
+
+// Writers overwrite slots while the reader copies them. With several cores that happens
+// constantly; on one it takes a preemption in the middle of a copy, and the accounting
+// and ordering checks carry most of the weight.
+static void test_multi_writer_wrap(void)
+{
+    pthread_t threads[WRITERS];
+    int64_t last_seq[WRITERS];
+    uint64_t read = 0, lost = 0, torn = 0, out_of_order = 0;
+    trace_record_t record;
+
+    trace_ring_init(&s_ring, s_slots, RING_SIZE);
+    atomic_store(&s_writers_done, 0);
+    atomic_store(&s_stop, false);
+    int64_t end_ns = bench_now_ns() + RUN_NS;
+    for (int i = 0; i < WRITERS; i++)
+    {
+        last_seq[i] = -1;
+        pthread_create(&threads[i], NULL, writer_thread, (void *)(uintptr_t)i);
+    }
+
+    // Drain while they write, then once more after they are done. The ring is far too small
+    // to keep up, so it wraps constantly under the reader.
+    for (;;)
+    {
+        if (bench_now_ns() >= end_ns)
+        {
+            atomic_store(&s_stop, true);
+        }
+        bool done = atomic_load(&s_writers_done) == WRITERS;
+        while (trace_ring_read(&s_ring, &record))
+        {
+            read++;
+            if (!record_intact(&record))
+            {
+                torn++;
+                continue;
+            }
+            int64_t seq = record.timestamp_us & 0xffffff;
+            if (seq <= last_seq[record.event])
+            {
+                out_of_order++;
+            }
+            last_seq[record.event] = seq;
+        }
+        lost += trace_ring_take_lost(&s_ring);
+        if (done)
+        {
+            break;
+        }
+        sched_yield();
+    }
+    uint64_t written = 0;
+    for (int i = 0; i < WRITERS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        written += s_written[i];
+    }
+
+    printf("  read %llu, lost %llu of %llu\n", (unsigned long long)read, (unsigned long long)lost,
+           (unsigned long long)written);
+    CHECK_EQ(torn, 0);
+    CHECK_EQ(out_of_order, 0);
+    // Every record is either read or counted as lost, exactly once
+    CHECK_EQ(read + lost, written);
+    CHECK(read >= RING_SIZE);
+}
+
+int main(void)
+{
+    RUN_TEST(test_in_order);
+    RUN_TEST(test_wrap_keeps_newest);
+    RUN_TEST(test_multi_writer_wrap);
+    TEST_EXIT();
+}
@@ -0,0 +1,263 @@
+/*
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+// The send pipeline's credits as the device uses them: every transport callback wired
+// the way main.c wires it, the fake transport playing the host. Connect, completions,
+// refused and failed sends, lost completions after a dropped link, and GET/SET_REPORT
+// arriving while reports are in flight.
+#include <string.h>
+
+#include "check.h"
+
+#include "config_block.h"
+#include "fake_actuator.h"
+#include "gamepad_report.h"
+#include "gamepad_transport_fake.h"
+#include "nvs.h"
+#include "report_requests.h"
+#include "runtime_config.h"
+#include "send_pipeline.h"
+
+#define MAX_IN_FLIGHT 3
+#define STALL_TIMEOUT_MS 100
+
+static report_scheduler_t s_sched;
+static report_requests_t s_requests;
+static send_pipeline_t s_pipeline;
+static unsigned s_connects;
+static unsigned s_disconnects;
+static uint8_t s_sent_first_byte[64]; // First payload byte of every report the transport took
+static unsigned s_sent_count;
+
+static void connected(void)
+{
+    uint8_t empty_report[GAMEPAD_REPORT_SIZE] = {0};
+
+    report_requests_publish(&s_requests, empty_report, sizeof(empty_report));
+    send_pipeline_reset(&s_pipeline);
+    s_connects++;
+}
+
+static void disconnected(void)
+{
+    s_disconnects++;
+}
+
+static void sent(bool ok)
+{
+    send_pipeline_complete(&s_pipeline, ok);
+}
+
+static uint16_t get_report(gamepad_report_type_t type, uint8_t report_id, uint8_t *buf, uint16_t size)
+{
+    return report_requests_get(&s_requests, type, report_id, buf, size);
+}
+
+static gamepad_set_report_status_t set_report(gamepad_report_type_t type, uint8_t report_id, const uint8_t *data,
+                                              uint16_t len)
+{
+    return report_requests_set(&s_requests, type, report_id, data, len);
+}
+
+static const gamepad_transport_callbacks_t s_callbacks = {
+    .connected = connected,
+    .disconnected = disconnected,
+    .sent = sent,
+    .get_report = get_report,
+    .set_report = set_report,
+};
+
+static void record(void *ctx, uint8_t report_id, const uint8_t *data, uint16_t len)
+{
+    CHECK_EQ(report_id, GAMEPAD_REPORT_ID);
+    CHECK_EQ(len, GAMEPAD_REPORT_SIZE);
+    s_sent_first_byte[s_sent_count++ % sizeof(s_sent_first_byte)] = data[0];
+}
+
+static void setup(void)
+{
+    report_scheduler_config_t config = {.axis_deadband = 256, .keepalive_ms = 0, .min_interval_us = 4000};
+
+    nvs_fake_erase_all();
+    runtime_config_init();
+    report_scheduler_init(&s_sched, &config);
+    report_requests_init(&s_requests, &s_sched);
+    send_pipeline_init(&s_pipeline, MAX_IN_FLIGHT, STALL_TIMEOUT_MS, gamepad_transport_send_report, NULL);
+    s_connects = s_disconnects = s_sent_count = 0;
+    gamepad_transport_start(&s_callbacks);
+    gamepad_transport_fake_set_recorder(record, NULL);
+    gamepad_transport_fake_set_busy(false);
+    gamepad_transport_fake_connect();
+}
+
+// Publish and submit report n as send_gamepad_report does; its first byte is n
+static void send_report(uint8_t n, int64_t now_us)
+{
+    uint8_t report[GAMEPAD_REPORT_SIZE];
+
+    memset(report, 0, sizeof(report));
+    report[0] = n;
+    report_requests_publish(&s_requests, report, sizeof(report));
+    send_pipeline_submit(&s_pipeline, GAMEPAD_REPORT_ID, report, sizeof(report), now_us);
+}
+
+static void check_stats(uint32_t submitted, uint32_t sent, uint32_t completed, uint32_t coalesced, uint32_t dropped,
+                        uint32_t failed)
+{
+    send_pipeline_stats_t stats;
+
+    send_pipeline_get_stats(&s_pipeline, &stats);
+    CHECK_EQ(stats.submitted, submitted);
+    CHECK_EQ(stats.sent, sent);
+    CHECK_EQ(stats.completed, completed);
+    CHECK_EQ(stats.coalesced, coalesced);
+    CHECK_EQ(stats.dropped, dropped);
+    CHECK_EQ(stats.failed, failed);
+}
+
+static void test_credits(void)
+{
+    setup();
+    CHECK_EQ(s_connects, 1);
+    CHECK(!send_pipeline_busy(&s_pipeline));
+
+    // The first MAX_IN_FLIGHT reports go straight out, the rest wait and only the newest is kept
+    for (uint8_t n = 1; n <= MAX_IN_FLIGHT + 2; n++)
+    {
+        send_report(n, n * 1000);
+    }
+    CHECK_EQ(gamepad_transport_fake_in_flight(), MAX_IN_FLIGHT);
+    CHECK_EQ(atomic_load(&s_pipeline.in_flight), MAX_IN_FLIGHT);
+    CHECK(s_pipeline.has_pending);
+    check_stats(MAX_IN_FLIGHT + 2, MAX_IN_FLIGHT, 0, 1, 0, 0);
+
+    // A completion frees one credit; the next flush spends it on the newest report
+    CHECK(gamepad_transport_fake_complete(true));
+    CHECK_EQ(atomic_load(&s_pipeline.in_flight), MAX_IN_FLIGHT - 1);
+    send_pipeline_flush(&s_pipeline, 10000);
+    CHECK_EQ(atomic_load(&s_pipeline.in_flight), MAX_IN_FLIGHT);
+    CHECK(!s_pipeline.has_pending);
+    CHECK_EQ(s_sent_count, MAX_IN_FLIGHT + 1);
+    CHECK_EQ(s_sent_first_byte[MAX_IN_FLIGHT], MAX_IN_FLIGHT + 2);
+    check_stats(MAX_IN_FLIGHT + 2, MAX_IN_FLIGHT + 1, 1, 1, 0, 0);
+
+    // A failed completion still returns its credit
+    CHECK(gamepad_transport_fake_complete(false));
+    while (gamepad_transport_fake_complete(true))
+    {
+    }
+    CHECK_EQ(atomic_load(&s_pipeline.in_flight), 0);
+    CHECK(!send_pipeline_busy(&s_pipeline));
+    check_stats(MAX_IN_FLIGHT + 2, MAX_IN_FLIGHT + 1, MAX_IN_FLIGHT + 1, 1, 0, 1);
+}
+
+static void test_refused(void)
+{
+    setup();
+
+    // A stack with a full queue refuses: the credit comes back at once and no completion follows
+    gamepad_transport_fake_set_busy(true);
+    send_report(1, 1000);
+    CHECK_EQ(atomic_load(&s_pipeline.in_flight), 0);
+    CHECK_EQ(gamepad_transport_fake_in_flight(), 0);
+    CHECK(!send_pipeline_busy(&s_pipeline));
+    check_stats(1, 0, 0, 0, 1, 0);
+
+    gamepad_transport_fake_set_busy(false);
+    send_report(2, 2000);
+    CHECK_EQ(atomic_load(&s_pipeline.in_flight), 1);
+    CHECK(gamepad_transport_fake_complete(true));
+    check_stats(2, 1, 1, 0, 1, 0);
+
+    // Once the link is gone every send is refused
+    gamepad_transport_fake_disconnect();
+    CHECK_EQ(s_disconnects, 1);
+    send_report(3, 3000);
+    CHECK_EQ(atomic_load(&s_pipeline.in_flight), 0);
+    check_stats(3, 1, 1, 0, 2, 0);
+}
+
+static void test_lost_completions(void)
+{
+    setup();
+
+    // The link drops with every credit in flight: their completions never come
+    for (uint8_t n = 1; n <= MAX_IN_FLIGHT; n++)
+    {
+        send_report(n, n * 1000);
+    }
+    gamepad_transport_fake_disconnect();
+
+    // A new connection starts with every credit back
+    gamepad_transport_fake_connect();
+    CHECK_EQ(s_connects, 2);
+    CHECK_EQ(atomic_load(&s_pipeline.in_flight), 0);
+    CHECK_EQ(gamepad_transport_fake_complete(true), false);
+    send_report(10, 10000);
+    CHECK_EQ(atomic_load(&s_pipeline.in_flight), 1);
+    CHECK(gamepad_transport_fake_complete(true));
+    CHECK_EQ(atomic_load(&s_pipeline.in_flight), 0);
+
+    // Without a reconnect, the stall timeout takes the credits back instead
+    for (uint8_t n = 11; n < 11 + MAX_IN_FLIGHT; n++)
+    {
+        send_report(n, 20000);
+    }
+    send_report(20, 20000 + STALL_TIMEOUT_MS * 1000 - 1);
+    CHECK(s_pipeline.has_pending);
+    CHECK(!send_pipeline_take_stall(&s_pipeline));
+    send_pipeline_flush(&s_pipeline, 20000 + STALL_TIMEOUT_MS * 1000);
+    CHECK(!s_pipeline.has_pending);
+    CHECK_EQ(atomic_load(&s_pipeline.in_flight), 1);
+    CHECK(send_pipeline_take_stall(&s_pipeline));
+    CHECK(!send_pipeline_take_stall(&s_pipeline));
+
+    send_pipeline_stats_t stats;
+    send_pipeline_get_stats(&s_pipeline, &stats);
+    CHECK_EQ(stats.stalls, 1);
+}
+
+static void test_requests_in_flight(void)
+{
+    uint8_t buf[GAMEPAD_TRANSPORT_MAX_REPORT];
+
+    setup();
+
+    // GET_REPORT right after connecting answers the empty report
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_INPUT, GAMEPAD_REPORT_ID, buf, sizeof(buf)),
+             GAMEPAD_REPORT_SIZE);
+    CHECK_EQ(buf[0], 0);
+
+    // With the pipeline full, GET_REPORT answers the newest report, even the one still waiting
+    for (uint8_t n = 1; n <= MAX_IN_FLIGHT + 1; n++)
+    {
+        send_report(n, n * 1000);
+    }
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_INPUT, GAMEPAD_REPORT_ID, buf, sizeof(buf)),
+             GAMEPAD_REPORT_SIZE);
+    CHECK_EQ(buf[0], MAX_IN_FLIGHT + 1);
+
+    // Requests on the control channel don't touch the credits
+    const uint8_t rumble[GAMEPAD_OUTPUT_REPORT_SIZE] = {255, 0, 1};
+    unsigned submits = fake_actuator_submits();
+    fake_actuator_set_accept(true);
+    CHECK_EQ(gamepad_transport_fake_set_report(GAMEPAD_REPORT_TYPE_OUTPUT, GAMEPAD_OUTPUT_REPORT_ID, rumble,
+                                               sizeof(rumble)),
+             GAMEPAD_SET_REPORT_OK);
+    CHECK_EQ(fake_actuator_submits(), submits + 1);
+    CHECK_EQ(gamepad_transport_fake_get_report(GAMEPAD_REPORT_TYPE_FEATURE, GAMEPAD_CONFIG_REPORT_ID, buf,
+                                               sizeof(buf)),
+             CONFIG_BLOCK_SIZE);
+    CHECK_EQ(atomic_load(&s_pipeline.in_flight), MAX_IN_FLIGHT);
+    CHECK(s_pipeline.has_pending);
+    check_stats(MAX_IN_FLIGHT + 1, MAX_IN_FLIGHT, 0, 0, 0, 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_credits);
+    RUN_TEST(test_refused);
+    RUN_TEST(test_lost_completions);
+    RUN_TEST(test_requests_in_flight);
+    TEST_EXIT();
+}